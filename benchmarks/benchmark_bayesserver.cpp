@@ -0,0 +1,544 @@
+/// @file
+/// @brief Load generator of the standalone BayesServer. A number of websocket clients replay a bayesscript file, or a synthetic
+/// mix of observe and get_belief requests, each client sending its next request after the response to the previous one. The
+/// throughput and latency percentiles of each action are reported and optionally written as JSON for regression tracking.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+#include <map>
+#include <functional>
+#include <stdexcept>
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QWebSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QUrl>
+
+#include <bayesserver/protocol.h>
+#include <bayesserver/metrics.h>
+
+namespace {
+
+    /// Seconds to wait for all clients to connect and load their networks, and for the last responses
+    const int TIMEOUT = 30;
+
+    /// Represents a request of a client, a command of a bayesscript
+    struct Step {
+        std::string action;
+        std::vector<std::string> arguments;
+    };
+
+    /// Represents the latencies and errors of an action
+    struct Result {
+        bayesServer::Histogram latency;
+        uint64_t errors = 0;
+    };
+
+    /// Represents a client of the benchmark
+    struct Client {
+        QWebSocket socket;
+        size_t position = 0;
+        bool busy = false;
+        bool ready = false;
+        Step request;
+        std::chrono::steady_clock::time_point sent;
+        std::map<std::string, uint32_t> handles;
+        std::mt19937_64 random;
+    };
+
+    /// Returns the elapsed seconds since @a start
+    double elapsed(const std::chrono::steady_clock::time_point &start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Reads the requests of bayesscript @a file, commands not sending a request like print are skipped
+    std::vector<Step> readScript(const std::string &file) {
+        std::ifstream in(file);
+
+        if (!in) {
+            throw std::runtime_error("can not read script " + file);
+        }
+
+        std::vector<Step> steps;
+        std::string line;
+
+        while (std::getline(in, line)) {
+            std::istringstream words(line);
+            Step step;
+            words >> step.action;
+
+            // ignore empty lines and comments
+            if (step.action.empty() || step.action[0] == ';') {
+                continue;
+            }
+
+            if (step.action != "load_network" && step.action != "attach_session" && step.action != "close_session" && step.action != "set_evidence" &&
+                step.action != "clear_evidence" && step.action != "observe" && step.action != "get_belief") {
+                if (step.action != "print") {
+                    std::cerr << "skipping unsupported command " << step.action << std::endl;
+                }
+
+                continue;
+            }
+
+            for (std::string word; words >> word;) {
+                step.arguments.push_back(word);
+            }
+
+            steps.push_back(step);
+        }
+
+        return steps;
+    }
+
+    /// Returns the json request of @a step
+    QString toJson(const Step &step) {
+        QJsonObject json;
+        QJsonObject payload;
+        const std::vector<std::string> &arguments = step.arguments;
+
+        if (step.action == "load_network") {
+            payload["file"] = arguments.at(0).c_str();
+            payload["session"] = arguments.size() > 1 ? arguments[1].c_str() : "";
+        } else if (step.action == "attach_session" || step.action == "close_session") {
+            payload["session"] = arguments.at(0).c_str();
+        } else if (step.action == "set_evidence") {
+            payload["node"] = arguments.at(0).c_str();
+            payload["state"] = std::stoi(arguments.at(1));
+        } else if (step.action == "observe") {
+            payload["node"] = arguments.at(0).c_str();
+            payload["value"] = std::stod(arguments.at(1));
+        } else {
+            payload["node"] = arguments.at(0).c_str();
+        }
+
+        json["action"] = step.action.c_str();
+        json["payload"] = payload;
+
+        return QString(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    }
+
+    /// Returns the handle of @a node negotiated by loading or attaching a session
+    uint32_t getHandle(const Client &client, const std::string &node) {
+        std::map<std::string, uint32_t>::const_iterator it = client.handles.find(node);
+
+        if (it == client.handles.end()) {
+            throw std::invalid_argument("unknown node " + node);
+        }
+
+        return it->second;
+    }
+
+    /// Returns the binary request of @a step sent by @a client
+    QByteArray toBinary(const Client &client, const Step &step) {
+        std::string buffer;
+        bayesServer::protocol::Writer writer(buffer);
+        const std::vector<std::string> &arguments = step.arguments;
+        bayesServer::protocol::Header header{bayesServer::protocol::VERSION, 0, bayesServer::protocol::SUCCESS, 0};
+
+        if (step.action == "load_network") {
+            header.opcode = bayesServer::protocol::LOAD_NETWORK;
+            writer.writeHeader(header);
+            writer.writeString(arguments.at(0));
+            writer.writeString(arguments.size() > 1 ? arguments[1] : "");
+        } else if (step.action == "attach_session" || step.action == "close_session") {
+            header.opcode = step.action == "attach_session" ? bayesServer::protocol::ATTACH_SESSION : bayesServer::protocol::CLOSE_SESSION;
+            writer.writeHeader(header);
+            writer.writeString(arguments.at(0));
+        } else if (step.action == "set_evidence") {
+            header.opcode = bayesServer::protocol::SET_EVIDENCE;
+            writer.writeHeader(header);
+            writer.writeUInt32(getHandle(client, arguments.at(0)));
+            writer.writeUInt32(static_cast<uint32_t>(std::stoul(arguments.at(1))));
+        } else if (step.action == "clear_evidence") {
+            header.opcode = bayesServer::protocol::CLEAR_EVIDENCE;
+            writer.writeHeader(header);
+            writer.writeUInt32(getHandle(client, arguments.at(0)));
+        } else if (step.action == "observe") {
+            header.opcode = bayesServer::protocol::OBSERVE;
+            writer.writeHeader(header);
+            writer.writeUInt32(getHandle(client, arguments.at(0)));
+            writer.writeDouble(std::stod(arguments.at(1)));
+        } else {
+            header.opcode = bayesServer::protocol::GET_BELIEFS;
+            writer.writeHeader(header);
+            writer.writeUInt32(1);
+            writer.writeUInt32(getHandle(client, arguments.at(0)));
+        }
+
+        return QByteArray(buffer.data(), static_cast<int>(buffer.size()));
+    }
+
+    /// Represents the benchmark run by a number of clients
+    class Benchmark {
+    public:
+        Benchmark(const QUrl &url, size_t nrClients, bool binary) : _url(url), _binary(binary), _nrReady(0), _nrIdle(0) {
+            for (size_t i = 0; i < nrClients; ++i) {
+                _clients.push_back(std::unique_ptr<Client>(new Client()));
+                _clients.back()->random.seed(42 + i);
+            }
+        }
+
+        /// Sets the steps executed once by each client before the measurement, and the steps repeated by each client
+        void setScript(const std::vector<Step> &setup, const std::vector<Step> &loop) {
+            _setup = setup;
+            _loop = loop;
+        }
+
+        /// Sets a synthetic mix of observations of @a sensor with values in [@a min, @a max) and belief reads of @a target
+        void setMix(const std::string &sensor, const std::string &target, double ratio, double min, double max) {
+            _sensor = sensor;
+            _target = target;
+            _ratio = ratio;
+            _min = min;
+            _max = max;
+        }
+
+        /// Connects all clients, measures for @a duration seconds after @a warmup seconds and calls @a done with the exit code
+        void run(double warmup, double duration, const std::function<void(int)> &done) {
+            _warmup = warmup;
+            _duration = duration;
+            _done = done;
+
+            for (size_t i = 0; i < _clients.size(); ++i) {
+                Client *client = _clients[i].get();
+
+                QObject::connect(&client->socket, &QWebSocket::connected, [this, client]() {
+                    next(*client);
+                });
+                QObject::connect(&client->socket, &QWebSocket::textMessageReceived, [this, client](const QString &message) {
+                    QJsonObject json = QJsonDocument::fromJson(message.toUtf8()).object();
+
+                    // pushed updates are no responses
+                    if (json["action"].toString() == "update") {
+                        return;
+                    }
+
+                    received(*client, json["payload"].toObject()["status"].toString() == "success");
+                });
+                QObject::connect(&client->socket, &QWebSocket::binaryMessageReceived, [this, client](const QByteArray &message) {
+                    bayesServer::protocol::Reader reader(message.constData(), static_cast<size_t>(message.size()));
+                    bayesServer::protocol::Header header = reader.readHeader();
+
+                    if (header.opcode == bayesServer::protocol::UPDATE) {
+                        return;
+                    }
+
+                    // negotiate the node handles, each node is addressed by its position in the table
+                    if (header.status == bayesServer::protocol::SUCCESS &&
+                        (header.opcode == bayesServer::protocol::LOAD_NETWORK || header.opcode == bayesServer::protocol::ATTACH_SESSION)) {
+                        client->handles.clear();
+                        uint32_t n = reader.readUInt32();
+
+                        for (uint32_t node = 0; node < n; ++node) {
+                            client->handles[reader.readString()] = node;
+                            reader.readUInt8();
+                            reader.readUInt8();
+                        }
+                    }
+
+                    received(*client, header.status == bayesServer::protocol::SUCCESS);
+                });
+                QObject::connect(&client->socket, &QWebSocket::disconnected, [this]() {
+                    if (!_stopped) {
+                        fail("connection to server lost");
+                    }
+                });
+
+                client->socket.open(_url);
+            }
+
+            QTimer::singleShot(TIMEOUT * 1000, [this]() {
+                if (_nrReady < _clients.size()) {
+                    fail("clients not ready, is the server running?");
+                }
+            });
+        }
+
+        /// Returns the results as json, available once done was called with exit code 0 or 2
+        const QJsonObject &getResults() const {
+            return _results;
+        }
+
+    private:
+        /// Sends the next request of @a client, or marks it idle after the measurement
+        void next(Client &client) {
+            if (_stopped) {
+                return;
+            }
+
+            if (client.position < _setup.size()) {
+                client.request = _setup[client.position++];
+            } else {
+                if (!client.ready) {
+                    client.ready = true;
+                    ready();
+                }
+
+                if (_measuring && elapsed(_start) >= _duration) {
+                    client.busy = false;
+
+                    if (++_nrIdle == _clients.size()) {
+                        finish();
+                    }
+
+                    return;
+                }
+
+                if (!_loop.empty()) {
+                    client.request = _loop[(client.position++ - _setup.size()) % _loop.size()];
+                } else {
+                    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+                    if (uniform(client.random) < _ratio) {
+                        client.request = Step{"observe", {_sensor, std::to_string(_min + uniform(client.random) * (_max - _min))}};
+                    } else {
+                        client.request = Step{"get_belief", {_target}};
+                    }
+                }
+            }
+
+            client.busy = true;
+            client.sent = std::chrono::steady_clock::now();
+
+            try {
+                if (_binary) {
+                    client.socket.sendBinaryMessage(toBinary(client, client.request));
+                } else {
+                    client.socket.sendTextMessage(toJson(client.request));
+                }
+            } catch(const std::exception &e) {
+                fail(std::string("invalid request ") + client.request.action + ": " + e.what());
+            }
+        }
+
+        /// Records the response to the last request of @a client
+        void received(Client &client, bool success) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            // requests sent before the measurement started are not recorded
+            if (_measuring && client.sent >= _start) {
+                std::unique_ptr<Result> &result = _actions[client.request.action];
+
+                if (!result) {
+                    result.reset(new Result());
+                }
+
+                result->latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - client.sent).count()));
+                result->errors += success ? 0 : 1;
+            } else if (!success && !client.ready) {
+                fail("setup request " + client.request.action + " failed");
+                return;
+            }
+
+            next(client);
+        }
+
+        /// Starts the measurement after the warm up, once all clients completed their setup
+        void ready() {
+            if (++_nrReady < _clients.size()) {
+                return;
+            }
+
+            QTimer::singleShot(static_cast<int>(_warmup * 1000), [this]() {
+                _start = std::chrono::steady_clock::now();
+                _measuring = true;
+            });
+
+            QTimer::singleShot(static_cast<int>((_warmup + _duration) * 1000) + TIMEOUT * 1000, [this]() {
+                if (!_stopped) {
+                    fail("responses missing after the measurement");
+                }
+            });
+        }
+
+        /// Prints the results and writes them as json
+        void finish() {
+            _stopped = true;
+            double duration = elapsed(_start);
+            uint64_t total = 0;
+            uint64_t errors = 0;
+            QJsonObject jsonActions;
+
+            std::cout << "Clients >> " << _clients.size() << std::endl;
+            std::cout << "Protocol >> " << (_binary ? "binary" : "json") << std::endl;
+            std::cout << "Duration >> " << duration << " s" << std::endl;
+
+            for (std::map<std::string, std::unique_ptr<Result> >::const_iterator it = _actions.begin(); it != _actions.end(); ++it) {
+                const bayesServer::Histogram &latency = it->second->latency;
+                QJsonObject jsonAction;
+                total += latency.count();
+                errors += it->second->errors;
+
+                jsonAction["count"] = static_cast<double>(latency.count());
+                jsonAction["errors"] = static_cast<double>(it->second->errors);
+                jsonAction["throughput"] = latency.count() / duration;
+                jsonAction["mean_us"] = latency.sum() * 1e-3 / latency.count();
+                jsonAction["p50_us"] = latency.percentile(0.5) * 1e-3;
+                jsonAction["p99_us"] = latency.percentile(0.99) * 1e-3;
+                jsonAction["p999_us"] = latency.percentile(0.999) * 1e-3;
+                jsonAction["max_us"] = latency.max() * 1e-3;
+                jsonActions[it->first.c_str()] = jsonAction;
+
+                std::cout << std::endl << it->first << std::endl;
+                std::cout << "  requests   >> " << latency.count() << " (" << it->second->errors << " errors)" << std::endl;
+                std::cout << "  throughput >> " << latency.count() / duration << " requests/s" << std::endl;
+                std::cout << "  mean       >> " << latency.sum() * 1e-3 / latency.count() << " us" << std::endl;
+                std::cout << "  p50        >> " << latency.percentile(0.5) * 1e-3 << " us" << std::endl;
+                std::cout << "  p99        >> " << latency.percentile(0.99) * 1e-3 << " us" << std::endl;
+                std::cout << "  p999       >> " << latency.percentile(0.999) * 1e-3 << " us" << std::endl;
+                std::cout << "  max        >> " << latency.max() * 1e-3 << " us" << std::endl;
+            }
+
+            std::cout << std::endl << "Throughput >> " << total / duration << " requests/s" << std::endl;
+
+            _results["clients"] = static_cast<double>(_clients.size());
+            _results["binary"] = _binary;
+            _results["duration"] = duration;
+            _results["requests"] = static_cast<double>(total);
+            _results["errors"] = static_cast<double>(errors);
+            _results["throughput"] = total / duration;
+            _results["actions"] = jsonActions;
+
+            for (size_t i = 0; i < _clients.size(); ++i) {
+                _clients[i]->socket.close();
+            }
+
+            _done(errors == 0 ? 0 : 2);
+        }
+
+        /// Aborts the benchmark with @a message
+        void fail(const std::string &message) {
+            if (_stopped) {
+                return;
+            }
+
+            _stopped = true;
+            std::cerr << message << std::endl;
+            _done(1);
+        }
+
+        std::vector<std::unique_ptr<Client> > _clients;
+        QUrl _url;
+        bool _binary;
+        std::vector<Step> _setup;
+        std::vector<Step> _loop;
+        std::string _sensor;
+        std::string _target;
+        double _ratio = 0.5;
+        double _min = 0.0;
+        double _max = 1.0;
+        double _warmup = 0.0;
+        double _duration = 0.0;
+        std::function<void(int)> _done;
+        size_t _nrReady;
+        size_t _nrIdle;
+        bool _measuring = false;
+        bool _stopped = false;
+        std::chrono::steady_clock::time_point _start;
+        std::map<std::string, std::unique_ptr<Result> > _actions;
+        QJsonObject _results;
+    };
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    // setup command line parser
+    QCommandLineParser parser;
+    QCommandLineOption urlOption({"url", "u"}, "websocket url of the server", "url", "ws://localhost:8000");
+    QCommandLineOption clientsOption({"clients", "n"}, "number of concurrent clients", "clients", "8");
+    QCommandLineOption durationOption({"duration", "d"}, "seconds to measure", "duration", "10");
+    QCommandLineOption warmupOption({"warmup", "w"}, "seconds to run before measuring", "warmup", "1");
+    QCommandLineOption scriptOption({"script", "s"}, "bayesscript replayed by each client, leading load_network and attach_session commands are sent once", "script");
+    QCommandLineOption networkOption({"network", "f"}, "network file loaded by each client for the synthetic mix", "network");
+    QCommandLineOption sensorOption("sensor", "sensor node observed by the synthetic mix", "node");
+    QCommandLineOption targetOption("target", "node read by the synthetic mix", "node");
+    QCommandLineOption ratioOption("observe-ratio", "fraction of observe requests of the synthetic mix", "ratio", "0.5");
+    QCommandLineOption minOption("min", "smallest observed value", "value", "0");
+    QCommandLineOption maxOption("max", "largest observed value", "value", "1");
+    QCommandLineOption binaryOption({"binary", "B"}, "use the binary protocol");
+    QCommandLineOption outputOption({"output", "o"}, "write the results as json to file", "file");
+    parser.addHelpOption();
+    parser.addOption(urlOption);
+    parser.addOption(clientsOption);
+    parser.addOption(durationOption);
+    parser.addOption(warmupOption);
+    parser.addOption(scriptOption);
+    parser.addOption(networkOption);
+    parser.addOption(sensorOption);
+    parser.addOption(targetOption);
+    parser.addOption(ratioOption);
+    parser.addOption(minOption);
+    parser.addOption(maxOption);
+    parser.addOption(binaryOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    size_t nrClients = std::max(1u, parser.value(clientsOption).toUInt());
+    Benchmark benchmark(QUrl(parser.value(urlOption)), nrClients, parser.isSet(binaryOption));
+    QJsonObject config;
+
+    if (parser.isSet(scriptOption)) {
+        std::vector<Step> steps;
+
+        try {
+            steps = readScript(parser.value(scriptOption).toStdString());
+        } catch(const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        // the sessions are set up once, the remaining commands are repeated
+        size_t n = 0;
+
+        while (n < steps.size() && (steps[n].action == "load_network" || steps[n].action == "attach_session")) {
+            n++;
+        }
+
+        if (n == steps.size()) {
+            std::cerr << "script has no commands to repeat" << std::endl;
+            return 1;
+        }
+
+        benchmark.setScript(std::vector<Step>(steps.begin(), steps.begin() + n), std::vector<Step>(steps.begin() + n, steps.end()));
+        config["script"] = parser.value(scriptOption);
+    } else if (parser.isSet(networkOption) && parser.isSet(sensorOption) && parser.isSet(targetOption)) {
+        double ratio = parser.value(ratioOption).toDouble();
+
+        benchmark.setScript(std::vector<Step>(1, Step{"load_network", {parser.value(networkOption).toStdString()}}), std::vector<Step>());
+        benchmark.setMix(parser.value(sensorOption).toStdString(), parser.value(targetOption).toStdString(), ratio,
+                         parser.value(minOption).toDouble(), parser.value(maxOption).toDouble());
+        config["network"] = parser.value(networkOption);
+        config["observe_ratio"] = ratio;
+    } else {
+        std::cerr << "either --script or --network, --sensor and --target are required" << std::endl;
+        return 1;
+    }
+
+    config["url"] = parser.value(urlOption);
+    config["warmup"] = parser.value(warmupOption).toDouble();
+
+    benchmark.run(parser.value(warmupOption).toDouble(), parser.value(durationOption).toDouble(), [&](int code) {
+        if (code != 1 && parser.isSet(outputOption)) {
+            QJsonObject json = benchmark.getResults();
+            json["config"] = config;
+
+            std::ofstream out(parser.value(outputOption).toStdString());
+            out << QJsonDocument(json).toJson().toStdString();
+        }
+
+        QCoreApplication::exit(code);
+    });
+
+    return app.exec();
+}
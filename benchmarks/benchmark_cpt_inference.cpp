@@ -0,0 +1,154 @@
+/// @file
+/// @brief Benchmark of the fuzzy CPT inference on the nodes with the most parents of a network. The precomputed strength
+/// matrices of the Controller are compared against a reference implementation evaluating the membership functions per rule.
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+#include <bayesnet/network.h>
+#include <bayesnet/util.h>
+
+namespace {
+    /// Infers the CPT of @a table by evaluating the membership functions of @a fuzzySets for each rule
+    bayesNet::CPT referenceInferCPT(const std::vector<bayesNet::fuzzyLogic::FuzzySet *> &fuzzySets, const bayesNet::fuzzyLogic::RuleTable &table) {
+        bayesNet::CPT cpt(table.nrJointStates());
+        const std::vector<size_t> &maxStates = table.getParentNrStates();
+        bayesNet::utils::Counter stateCounter(maxStates.size(), maxStates);
+        std::vector<double> maxima(fuzzySets.size());
+        std::vector<double> inferred(table.getChildNrStates());
+
+        do {
+            std::vector<size_t> &states = stateCounter.getCount();
+
+            for (size_t j = 0; j < fuzzySets.size(); ++j) {
+                maxima[j] = fuzzySets[j]->findMaximum(states[j]);
+            }
+
+            std::fill(inferred.begin(), inferred.end(), 0);
+
+            for (size_t i = 0; i < table.nrRules(); ++i) {
+                const unsigned char *ruleStates = table.getParentStates(i);
+                double tNorm = 1;
+
+                for (size_t j = 0; j < fuzzySets.size(); ++j) {
+                    tNorm *= fuzzySets[j]->getStrength(maxima[j], ruleStates[j]);
+                }
+
+                int trunc = static_cast<int>(tNorm * 100);
+                tNorm = trunc / 100.0;
+
+                size_t state = table.getChildState(i);
+
+                if (tNorm > inferred[state]) {
+                    inferred[state] = tNorm;
+                }
+            }
+
+            bayesNet::utils::vectorNormalize(inferred);
+
+            for (size_t i = 0; i < inferred.size(); i++) {
+                cpt.set((i * stateCounter.getMaximumIncrement()) + stateCounter.getIncrement(), inferred[i]);
+            }
+        } while (stateCounter.countUp());
+
+        return cpt;
+    }
+
+    /// Builds a full rule table for @a parentStates, concluding the rounded mean of the scaled parent states
+    bayesNet::fuzzyLogic::RuleTable fullRuleTable(const std::vector<size_t> &parentStates, size_t childStates) {
+        bayesNet::fuzzyLogic::RuleTable table(parentStates, childStates);
+        bayesNet::utils::Counter ruleCounter(parentStates.size(), parentStates);
+        std::vector<unsigned char> states(parentStates.size());
+
+        do {
+            std::vector<size_t> &count = ruleCounter.getCount();
+            double sum = 0;
+
+            for (size_t j = 0; j < count.size(); ++j) {
+                states[j] = static_cast<unsigned char>(count[j]);
+                sum += static_cast<double>(count[j]) / static_cast<double>(parentStates[j] - 1);
+            }
+
+            double mean = count.empty() ? 0 : sum / static_cast<double>(count.size());
+            table.addRule(states.data(), static_cast<unsigned char>(mean * static_cast<double>(childStates - 1) + 0.5));
+        } while (ruleCounter.countUp());
+
+        return table;
+    }
+
+    /// Returns the elapsed milliseconds since @a start
+    double elapsed(const std::chrono::steady_clock::time_point &start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string networkFile = argc > 1 ? argv[1] : "networks/lane_change.bayesnet";
+    size_t iterations = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 3;
+
+    std::unique_ptr<bayesNet::file::InitializationVector> iv(bayesNet::file::InitializationVector::parse(networkFile));
+    bayesNet::Network network(networkFile);
+
+    // find nodes with the most parents
+    std::vector<std::string> names;
+    size_t maxParents = 0;
+
+    for (size_t i = 0; i < iv->getNodes().size(); ++i) {
+        const std::string &name = iv->getNodes()[i]->getName();
+        size_t parents = network.getParents(name).size();
+
+        if (parents > maxParents) {
+            maxParents = parents;
+            names.clear();
+        }
+
+        if (parents == maxParents) {
+            names.push_back(name);
+        }
+    }
+
+    std::cout << "Network >> " << networkFile << std::endl;
+    std::cout << "Nodes with " << maxParents << " parents >> " << names.size() << std::endl << std::endl;
+
+    bool identical = true;
+
+    for (size_t n = 0; n < names.size(); ++n) {
+        std::vector<bayesNet::Node *> parents = network.getParents(names[n]);
+        std::vector<bayesNet::fuzzyLogic::FuzzySet *> fuzzySets(parents.size());
+        std::vector<size_t> parentStates(parents.size());
+
+        for (size_t j = 0; j < parents.size(); ++j) {
+            fuzzySets[j] = &parents[j]->getFuzzySet();
+            parentStates[j] = parents[j]->nrStates();
+        }
+
+        bayesNet::fuzzyLogic::RuleSet rules(fullRuleTable(parentStates, network.getNode(names[n]).nrStates()));
+        double referenceTime = 0;
+        double controllerTime = 0;
+        bayesNet::CPT reference;
+        bayesNet::CPT cpt;
+
+        for (size_t k = 0; k < iterations; ++k) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            reference = referenceInferCPT(fuzzySets, rules.getTable());
+            referenceTime += elapsed(start);
+
+            start = std::chrono::steady_clock::now();
+            bayesNet::fuzzyLogic::Controller controller(fuzzySets, &rules, 0);
+            cpt = controller.inferCPT();
+            controllerTime += elapsed(start);
+        }
+
+        bool equal = reference.getProbabilities() == cpt.getProbabilities();
+        identical = identical && equal;
+
+        std::cout << names[n] << " (" << rules.getTable().nrRules() << " rules, " << cpt.size() << " entries)" << std::endl;
+        std::cout << "  reference  >> " << referenceTime / static_cast<double>(iterations) << " ms" << std::endl;
+        std::cout << "  controller >> " << controllerTime / static_cast<double>(iterations) << " ms" << std::endl;
+        std::cout << "  identical  >> " << (equal ? "yes" : "no") << std::endl;
+    }
+
+    return identical ? 0 : 1;
+}
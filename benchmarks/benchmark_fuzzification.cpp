@@ -0,0 +1,132 @@
+/// @file
+/// @brief Benchmark of the batch and tabulated fuzzification. For each curve type a fuzzy set is evaluated for a long array of
+/// samples, scalar per sample, using the batch kernels and scalar in tabulated mode, and the maximum absolute differences are reported.
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include <bayesnet/fuzzy.h>
+
+namespace {
+    /// Returns the elapsed milliseconds since @a start
+    double elapsed(const std::chrono::steady_clock::time_point &start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Returns a fuzzy set with four states on [1, 4] using membership functions of curve @a name
+    bayesNet::fuzzyLogic::FuzzySet *createFuzzySet(const std::string &name) {
+        const char *curves[][4] = {
+            {"\"linear\": [2, 1]", "\"linear\": [1, 2]", "\"linear\": [2, 3]", "\"linear\": [3, 4]"},
+            {"\"triangle\": [0, 1, 2]", "\"triangle\": [1, 2, 3]", "\"triangle\": [2, 3, 4]", "\"triangle\": [3, 4, 5]"},
+            {"\"trapezoid\": [0, 1, 1.5, 2]", "\"trapezoid\": [1, 1.8, 2.2, 3]", "\"trapezoid\": [2, 2.8, 3.2, 4]", "\"trapezoid\": [3, 3.5, 4, 5]"},
+            {"\"zshape\": [1, 2]", "\"sshape\": [1, 2]", "\"sshape\": [2, 3]", "\"sshape\": [3, 4]"},
+            {"\"zshape\": [1, 2]", "\"pishape\": [1, 2, 2, 3]", "\"pishape\": [2, 3, 3, 4]", "\"sshape\": [3, 4]"},
+            {"\"sigmoid\": [4, 0.5]", "\"sigmoid\": [4, 1.5]", "\"sigmoid\": [4, 2.5]", "\"sigmoid\": [4, 3.5]"},
+            {"\"bell\": [0.5, 2, 1]", "\"bell\": [0.5, 2, 2]", "\"bell\": [0.5, 2.5, 3]", "\"bell\": [0.5, 1.5, 4]"},
+            {"\"gaussian\": [1, 0.4]", "\"gaussian\": [2, 0.4]", "\"gaussian\": [3, 0.4]", "\"gaussian\": [4, 0.4]"},
+            {"\"gaussian2\": [1, 0.3, 1.2, 0.3]", "\"gaussian2\": [1.9, 0.3, 2.1, 0.3]", "\"gaussian2\": [2.9, 0.3, 3.1, 0.3]", "\"gaussian2\": [3.8, 0.3, 4, 0.3]"}
+        };
+        const char *names[] = {"linear", "triangle", "trapezoid", "sshape", "pishape", "sigmoid", "bell", "gaussian", "gaussian2"};
+
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+            if (name == names[i]) {
+                bayesNet::fuzzyLogic::FuzzySet *fuzzySet = new bayesNet::fuzzyLogic::FuzzySet(4);
+
+                for (size_t state = 0; state < 4; ++state) {
+                    fuzzySet->setMembershipFunction(state, bayesNet::fuzzyLogic::membershipFunctions::fromString(curves[i][state]));
+                }
+
+                return fuzzySet;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t samples = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 1000000;
+    size_t iterations = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 5;
+    double maxError = argc > 3 ? std::stod(argv[3]) : 1e-4;
+
+    // raw sensor samples slightly exceeding the domain of the fuzzy sets
+    std::vector<double> xs(samples);
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> distribution(0.5, 4.5);
+
+    for (size_t i = 0; i < samples; ++i) {
+        xs[i] = distribution(random);
+    }
+
+    const char *names[] = {"linear", "triangle", "trapezoid", "sshape", "pishape", "sigmoid", "bell", "gaussian", "gaussian2"};
+    std::cout << "Samples >> " << samples << std::endl;
+    std::cout << "Maximum tabulation error >> " << maxError << std::endl << std::endl;
+
+    for (size_t n = 0; n < sizeof(names) / sizeof(names[0]); ++n) {
+        bayesNet::fuzzyLogic::FuzzySet *fuzzySet = createFuzzySet(names[n]);
+        bayesNet::fuzzyLogic::FuzzySet *tabulatedFuzzySet = createFuzzySet(names[n]);
+        tabulatedFuzzySet->tabulate(0.5, 4.5, maxError);
+
+        size_t states = fuzzySet->nrStates();
+        std::vector<double> scalar(states * samples);
+        std::vector<double> batch(states * samples);
+        std::vector<double> tabulated(states * samples);
+        double scalarTime = 0;
+        double batchTime = 0;
+        double tabulatedTime = 0;
+
+        for (size_t k = 0; k < iterations; ++k) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::vector<double> strength(states);
+
+            for (size_t i = 0; i < samples; ++i) {
+                fuzzySet->getStrength(xs[i], strength.data());
+
+                for (size_t s = 0; s < states; ++s) {
+                    scalar[s * samples + i] = strength[s];
+                }
+            }
+
+            scalarTime += elapsed(start);
+
+            start = std::chrono::steady_clock::now();
+            fuzzySet->getStrength(xs.data(), samples, batch.data());
+            batchTime += elapsed(start);
+
+            start = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < samples; ++i) {
+                tabulatedFuzzySet->getStrength(xs[i], strength.data());
+
+                for (size_t s = 0; s < states; ++s) {
+                    tabulated[s * samples + i] = strength[s];
+                }
+            }
+
+            tabulatedTime += elapsed(start);
+        }
+
+        double batchError = 0;
+        double tabulatedError = 0;
+
+        for (size_t i = 0; i < scalar.size(); ++i) {
+            batchError = std::max(batchError, std::abs(scalar[i] - batch[i]));
+            tabulatedError = std::max(tabulatedError, std::abs(scalar[i] - tabulated[i]));
+        }
+
+        std::cout << names[n] << std::endl;
+        std::cout << "  scalar              >> " << scalarTime / static_cast<double>(iterations) << " ms" << std::endl;
+        std::cout << "  batch               >> " << batchTime / static_cast<double>(iterations) << " ms" << std::endl;
+        std::cout << "  batch max error     >> " << batchError << std::endl;
+        std::cout << "  tabulated           >> " << tabulatedTime / static_cast<double>(iterations) << " ms" << std::endl;
+        std::cout << "  tabulated max error >> " << tabulatedError << std::endl;
+
+        delete fuzzySet;
+        delete tabulatedFuzzySet;
+    }
+
+    return 0;
+}
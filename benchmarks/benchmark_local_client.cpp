@@ -0,0 +1,85 @@
+/// @file
+/// @brief Benchmark of round trips over the unix domain socket transport of the BayesServer. A client loads a network and
+/// measures the latencies of observe, get_belief and batch requests combining both, as well as of json get_belief requests.
+
+#include <iostream>
+#include <chrono>
+#include <random>
+
+#include <bayesserver/client.h>
+#include <bayesserver/metrics.h>
+
+namespace {
+    /// Prints the latency percentiles of @a histogram named @a name in microseconds
+    void print(const std::string &name, const bayesServer::Histogram &histogram) {
+        std::cout << name << std::endl;
+        std::cout << "  mean >> " << histogram.sum() * 1e-3 / histogram.count() << " us" << std::endl;
+        std::cout << "  p50  >> " << histogram.percentile(0.5) * 1e-3 << " us" << std::endl;
+        std::cout << "  p99  >> " << histogram.percentile(0.99) * 1e-3 << " us" << std::endl;
+        std::cout << "  p999 >> " << histogram.percentile(0.999) * 1e-3 << " us" << std::endl;
+        std::cout << "  max  >> " << histogram.max() * 1e-3 << " us" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0] << " <socket> <network_file> <sensor> <target> [<iterations>]" << std::endl;
+        return 1;
+    }
+
+    size_t iterations = argc > 5 ? static_cast<size_t>(std::stoul(argv[5])) : 10000;
+
+    try {
+        bayesServer::LocalClient client(argv[1]);
+        client.loadNetwork(argv[2]);
+
+        size_t sensor = client.getHandle(argv[3]);
+        size_t target = client.getHandle(argv[4]);
+        std::string json = std::string("{\"action\": \"get_belief\", \"payload\": {\"node\": \"") + argv[4] + "\"}}";
+        std::vector<bayesServer::Operation> operations = {{bayesServer::Operation::OBSERVE, sensor, 0.0},
+                                                          {bayesServer::Operation::GET_BELIEF, target, 0.0}};
+
+        bayesServer::Histogram observe;
+        bayesServer::Histogram getBeliefs;
+        bayesServer::Histogram batch;
+        bayesServer::Histogram request;
+        std::mt19937_64 random(42);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+        for (size_t i = 0; i < iterations; ++i) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            client.observe(sensor, distribution(random));
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            observe.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+
+            // applies inference for the observation
+            start = std::chrono::steady_clock::now();
+            client.getBeliefs(std::vector<size_t>(1, target));
+            end = std::chrono::steady_clock::now();
+            getBeliefs.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+
+            operations[0].value = distribution(random);
+            start = std::chrono::steady_clock::now();
+            client.batch(operations);
+            end = std::chrono::steady_clock::now();
+            batch.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+
+            // the beliefs are up to date, so only the transport and json are measured
+            start = std::chrono::steady_clock::now();
+            client.request(json);
+            end = std::chrono::steady_clock::now();
+            request.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+
+        std::cout << "Iterations >> " << iterations << std::endl << std::endl;
+        print("observe", observe);
+        print("get_beliefs", getBeliefs);
+        print("batch observe + get_beliefs", batch);
+        print("json get_belief", request);
+    } catch(const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/// @file
+/// @brief Defines the on-disk caches of compiled networks and inferred CPTs, which are used to skip parsing, inference preparation and CPT inference.
+
+
+#ifndef BAYESNET_FRAMEWORK_CACHE_H
+#define BAYESNET_FRAMEWORK_CACHE_H
+
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <bayesnet/file.h>
+#include <bayesnet/cpt.h>
+
+
+namespace bayesNet {
+
+    namespace cache {
+
+        /// Represents a directory of compiled networks, keyed by a content hash of the network file
+        /** A cache entry stores the parsed network as binary InitializationVector together with the prepared
+         *  junction tree clusters of the inference algorithm. The entry is looked up by the hash of the network
+         *  file and its journal, so any change of the network text leads to a new entry. The hash of the referenced
+         *  algorithm file is stored in the entry and verified on load, because the clusters depend on the algorithm
+         *  properties. Entries are written to a temporary file and renamed, so readers never see partial entries.
+         *  The binary format depends on the byte order of the machine and is not meant to be shared between machines.
+         */
+        class NetworkCache {
+        public:
+            /// Constructs a cache using the directory @a directory, which is created if it does not exist
+            explicit NetworkCache(const std::string &directory);
+
+            /// Destructor
+            virtual ~NetworkCache();
+
+            /// Returns the cache directory
+            const std::string &getDirectory() const;
+
+            /// Loads the compiled network file @a filename into @a iv and its junction tree @a clusters, returns false on cache miss
+            bool load(const std::string &filename, file::InitializationVector &iv, std::vector<std::vector<size_t> > &clusters) const;
+
+            /// Stores @a iv and junction tree @a clusters as compiled network of file @a filename, returns false if the entry cannot be written
+            bool store(const std::string &filename, file::InitializationVector &iv, const std::vector<std::vector<size_t> > &clusters) const;
+
+            /// Replaces the junction tree @a clusters of the existing entry for network file @a filename
+            bool update(const std::string &filename, const std::vector<std::vector<size_t> > &clusters) const;
+
+            /// Returns the content hash of network file @a filename including its journal, returns false if the file cannot be read
+            static bool key(const std::string &filename, uint64_t &key);
+
+        private:
+            /// Returns the filename of the entry for @a key
+            std::string getEntryFilename(uint64_t key) const;
+
+            /// Stores the cache directory
+            std::string _directory;
+        };
+
+        /// Represents a directory of inferred CPTs, keyed by a content hash of the inference input
+        /** The key is provided by fuzzyLogic::Controller::getKey, so a CPT is reused by any node of any network whose
+         *  parent fuzzy sets, rules and tolerance are equal. Like compiled networks, entries are written to a temporary
+         *  file and renamed and their binary format depends on the byte order of the machine.
+         */
+        class CPTCache {
+        public:
+            /// Constructs a cache using the directory @a directory, which is created if it does not exist
+            explicit CPTCache(const std::string &directory);
+
+            /// Destructor
+            virtual ~CPTCache();
+
+            /// Returns the cache directory
+            const std::string &getDirectory() const;
+
+            /// Loads the CPT with @a key of size @a size into @a cpt, returns false on cache miss
+            bool load(uint64_t key, size_t size, CPT &cpt) const;
+
+            /// Stores @a cpt with @a key, returns false if the entry cannot be written
+            bool store(uint64_t key, const CPT &cpt) const;
+
+        private:
+            /// Returns the filename of the entry for @a key
+            std::string getEntryFilename(uint64_t key) const;
+
+            /// Stores the cache directory
+            std::string _directory;
+        };
+    }
+}
+
+
+#endif //BAYESNET_FRAMEWORK_CACHE_H
@@ -48,7 +48,7 @@ namespace bayesNet {
         std::vector<double> &getProbabilities();
 
         /// Returns the whole CPT as vector
-        std::vector<double> getProbabilities() const;
+        const std::vector<double> &getProbabilities() const;
 
         /// Access operator
         double &operator[](size_t index);
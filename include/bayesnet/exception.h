@@ -74,6 +74,17 @@ namespace bayesNet {
             NO_SENSOR,
             INVALID_RULE_STATE,
             GENERATOR_LOGIC_FILE_NOT_SET,
+            INVALID_FUZZY_RULE,
+            INVALID_TABULATION,
+            INVALID_PIPELINE_STATE,
+            SESSION_NOT_FOUND,
+            SESSION_ALREADY_EXISTS,
+            INVALID_MESSAGE,
+            INVALID_SCHEDULE,
+            CONNECTION_FAILED,
+            REQUEST_FAILED,
+            INVALID_PRELOAD_CONFIG,
+            INCOMPATIBLE_NETWORK,
             NUM_ERRORS
         };
 
@@ -17,6 +17,12 @@ namespace bayesNet {
 
     namespace file {
 
+        /// Number of significant digits of probabilities written to network files and journals
+        const int PRECISION = 6;
+
+        /// Returns if @a a and @a b are written as the same number to network files, see PRECISION
+        bool isWrittenEqual(double a, double b);
+
         /// Represents a parsed bayesian node, that can be used in InitializationVector
         /** This node representation is an intermediate node representation, which then is used
          *  to initialize a bayesian network.
@@ -104,8 +110,13 @@ namespace bayesNet {
             void save(const std::string &filename);
 
             /// Parses a network based on the given @a filename and returns the @return InitializationVector
+            /** If a journal exists for @a filename, its entries are replayed on top of the parsed network.
+             */
             static InitializationVector *parse(const std::string &filename);
 
+            /// Parses the next network document from @a stream into @a iv and returns true if a complete document was read
+            static bool parse(std::istream &stream, InitializationVector &iv);
+
         private:
             /// Stores nodes
             std::vector<Node *> _nodes;
@@ -126,6 +137,43 @@ namespace bayesNet {
         /// Stream operator used to write string representation of @a iv to iostream @a os
         std::ostream &operator<<(std::ostream &os, InitializationVector &iv);
 
+        /// Represents an append-only journal of network changes, stored as sidecar file next to a network file
+        /** Rewriting a whole network file for a handful of changed CPTs is expensive for large networks.
+         *  Instead the changed CPTs and fuzzy sets can be appended to the journal, which is replayed on top
+         *  of the network file by InitializationVector::parse. A full save of the network compacts the journal
+         *  by removing it. Each journal entry is a network document containing only the changed sections.
+         */
+        class Journal {
+        public:
+            /// Constructs the journal belonging to the network file @a networkFilename
+            explicit Journal(const std::string &networkFilename);
+
+            /// Destructor
+            virtual ~Journal();
+
+            /// Returns the filename of the journal
+            const std::string &getFilename() const;
+
+            /// Returns if the journal file exists
+            bool exists() const;
+
+            /// Returns the size of the journal file in bytes
+            size_t size() const;
+
+            /// Appends CPTs and fuzzy sets of @a iv as new journal entry
+            void append(InitializationVector &iv);
+
+            /// Replays all complete journal entries on top of @a iv
+            void replay(InitializationVector &iv) const;
+
+            /// Removes the journal file
+            void clear();
+
+        private:
+            /// Stores the journal filename
+            std::string _filename;
+        };
+
         /// Represents a parsed Fuzzy Rule in a raw intermediate format
         /** This is a intermediate representation of a fuzzy rule which then can be used
          *  to infer CPTs
@@ -189,7 +237,67 @@ namespace bayesNet {
             /// Stores the rules
             std::vector<FuzzyRule *> _rules;
         };
- 
+
+        /// Represents the fuzzy rules of a node in a raw columnar format
+        /** Each column corresponds to a node named in the if-clauses, in order of first appearance. The if-clause
+         *  states of all rules are stored in one contiguous row-major matrix, the then-clause states in a separate
+         *  column. Rules without a clause for a column store FuzzyRuleTable::NO_STATE.
+         */
+        class FuzzyRuleTable {
+        public:
+            /// Marks a missing if-clause
+            static const unsigned char NO_STATE = 0xff;
+
+            /// Constructs an empty FuzzyRuleTable for node @a name
+            explicit FuzzyRuleTable(const std::string &name);
+
+            /// Destructor
+            virtual ~FuzzyRuleTable();
+
+            /// Returns the corresponding node name
+            const std::string &getName() const;
+
+            /// Returns the node names of the columns
+            const std::vector<std::string> &getColumns() const;
+
+            /// Returns the column of node @a name, adding a new column if it does not exist yet
+            size_t addColumn(const std::string &name);
+
+            /// Adds a new rule without if-clauses and with then-clause @a thenState, returns the index of the rule
+            size_t addRule(unsigned char thenState);
+
+            /// Sets the if-clause @a state of @a column for @a rule
+            void setState(size_t rule, size_t column, unsigned char state);
+
+            /// Returns the if-clause state of @a column for @a rule
+            unsigned char getState(size_t rule, size_t column) const;
+
+            /// Returns the then-clause state of @a rule
+            unsigned char getThenState(size_t rule) const;
+
+            /// Returns the number of rules
+            size_t nrRules() const;
+
+            /// Parses a fuzzy rule file based on the given @a filename and returns one FuzzyRuleTable per node section
+            /** Uses a linear single pass tokenizer instead of regular expressions. Lines which are no section header,
+             *  section end or well-formed rule are skipped, like FuzzyRuleVector::parse does.
+             */
+            static std::vector<FuzzyRuleTable> parse(const std::string &filename);
+
+        private:
+            /// Stores the node name
+            std::string _name;
+
+            /// Stores the column node names
+            std::vector<std::string> _columns;
+
+            /// Stores the if-clause states, one row per rule
+            std::vector<unsigned char> _states;
+
+            /// Stores the then-clause states
+            std::vector<unsigned char> _thenStates;
+        };
+
 
         struct NodeLogic { 
             NodeLogic() = default;
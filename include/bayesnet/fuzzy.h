@@ -7,6 +7,10 @@
 
 
 #include <vector>
+#include <memory>
+#include <string>
+#include <ostream>
+#include <cstdint>
 
 #include <bayesnet/cpt.h>
 #include <bayesnet/state.h>
@@ -26,8 +30,59 @@
 
 namespace bayesNet {
 
+    namespace utils {
+        class ThreadPool;
+    }
+
     namespace fuzzyLogic {
 
+        /// Represents the parameters of one of the shipped membership function curves in a closed tagged format
+        /** Curves are evaluated by curves::evaluate using a switch over the type instead of a virtual call,
+         *  which allows to store the curves of a fuzzy set contiguously. The meaning of the parameters depends
+         *  on the type, see the corresponding MembershipFunction::getCurve implementation. Membership functions
+         *  not shipped with the framework are represented by type CUSTOM and have to be evaluated virtually.
+         */
+        struct Curve {
+            /// Curve types
+            enum Type {
+                CUSTOM,
+                LINEAR,
+                TRIANGLE,
+                TRAPEZOID,
+                SSHAPE,
+                ZSHAPE,
+                PISHAPE,
+                SIGMOID,
+                BELL,
+                GAUSSIAN,
+                GAUSSIAN2
+            };
+
+            /// Maximum number of parameters of a curve
+            static const size_t MAX_PARAMS = 6;
+
+            /// Stores the curve type
+            Type type;
+
+            /// Stores the curve parameters
+            double params[MAX_PARAMS];
+        };
+
+        namespace curves {
+
+            /// Returns the strength of the shipped @a curve at value @a x, identical to the corresponding MembershipFunction::fx
+            double evaluate(const Curve &curve, double x);
+
+            /// Writes the strengths of the shipped @a curve at the @a n values @a xs to @a out
+            /** The kernels are branch free, so the compiler can vectorize them. Piecewise linear and polynomial curves
+             *  (Linear, Triangle, Trapezoid, S-, Z- and Pi-shape) are bit-identical to evaluate(). Curves based on
+             *  exponentials (Sigmoid, Bell, Gaussian, Gaussian2) use polynomial approximations of exp and log, their
+             *  strengths differ from evaluate() by less than 1e-15. Strengths which underflow or overflow the double
+             *  range may be tiny positive values instead of exactly 0.
+             */
+            void evaluate(const Curve &curve, const double *xs, size_t n, double *out);
+        }
+
         /// Represents the base class for membership functions used by fuzzy logic
         /** A membership function represents the strength of a discrete/state
          *  based on a continuous value.
@@ -48,6 +103,9 @@ namespace bayesNet {
 
             /// Returns string representation of membership function
             virtual const std::string toString() const = 0;
+
+            /// Returns the tagged curve representation, membership functions not shipped with the framework return a CUSTOM curve
+            virtual Curve getCurve() const;
         };
 
         /// Stream operator to write string representation of membership function @a mf to iostream @a os
@@ -72,12 +130,47 @@ namespace bayesNet {
             /// Returns a membership function for @a state
             MembershipFunction *getMembershipFunction(size_t state);
 
+            /// Returns a membership function for @a state
+            const MembershipFunction *getMembershipFunction(size_t state) const;
+
             /// Returns maximum position for membership function for @a state 
             double findMaximum(size_t state) const;
 
             /// Returns the strength vector for continuous value @a x
             std::vector<double> getStrength(double x) const;
 
+            /// Writes the strength of each state for continuous value @a x to @a strengths, which has to hold nrStates() values
+            void getStrength(double x, double *strengths) const;
+
+            /// Enables the tabulated mode, precomputing lookup tables on the domain [@a min, @a max] with a maximum absolute error of @a maxError
+            /** In tabulated mode the strengths of Sigmoid, Bell, Gaussian and Gaussian2 curves are linearly interpolated from a
+             *  uniform lookup table per state instead of evaluating exp and pow. Values outside the domain as well as all other
+             *  curve types are still evaluated exactly.
+             *
+             *  The table spacing h of each state is chosen using the interpolation error bound |f(x) - p(x)| <= h^2 / 8 * max|f''|
+             *  with analytic bounds of the second derivative: 1 / d^2 for a gaussian with deviation d, a^2 / (6 sqrt(3)) for
+             *  a sigmoid with slope a, 2b (2b + 1) / a^2 for a bell with width a and 2b >= 2, and the product rule of both
+             *  gaussians for Gaussian2. Thus each tabulated strength differs from the exact one by at most @a maxError plus
+             *  a few ulp of rounding. Bell curves with 2b < 2 have an unbounded second derivative and stay exact, like
+             *  states which would need more than 2^20 table entries.
+             *
+             *  The tables are used by all getStrength methods, so they affect CPT inference using this fuzzy set as well.
+             *  Membership functions set afterwards are tabulated using the same settings.
+             */
+            void tabulate(double min, double max, double maxError);
+
+            /// Disables the tabulated mode, releasing the lookup tables
+            void clearTabulation();
+
+            /// Returns if the tabulated mode is enabled
+            bool isTabulated() const;
+
+            /// Writes the strengths of each state for the @a n continuous values @a xs to the nrStates() x @a n matrix @a strengths
+            /** The strength of state s for value xs[i] is written to strengths[s * n + i]. Uses the vectorized batch kernels
+             *  of curves::evaluate, see there for the accuracy compared to the scalar getStrength.
+             */
+            void getStrength(const double *xs, size_t n, double *strengths) const;
+
             /// Returns the strength for continuous value @a x and membership function for @a state
             double getStrength(double x, size_t state) const;
 
@@ -87,6 +180,45 @@ namespace bayesNet {
         private:
             /// Stores the membership functions
             std::vector<MembershipFunction *> _mf;
+
+            /// Represents the lookup table of a tabulated state
+            struct Table {
+                /// Stores the begin of the domain
+                double min;
+
+                /// Stores the end of the domain
+                double max;
+
+                /// Stores the reciprocal table spacing
+                double scale;
+
+                /// Stores the strengths at the grid points, empty if the state is evaluated exactly
+                std::vector<double> values;
+            };
+
+            /// Stores the tagged curves of the membership functions
+            std::vector<Curve> _curves;
+
+            /// Stores the lookup tables of each state, empty if not tabulated
+            std::vector<Table> _tables;
+
+            /// Stores the tabulation domain begin
+            double _tabulationMin;
+
+            /// Stores the tabulation domain end
+            double _tabulationMax;
+
+            /// Stores the maximum absolute tabulation error
+            double _tabulationError;
+
+            /// Creates the lookup table of @a state using the tabulation settings
+            void tabulateState(size_t state);
+
+            /// Returns the strength of @a state for value @a x
+            double evaluate(size_t state, double x) const;
+
+            /// Returns the interpolated strength of @a state for value @a x, which has to be within the domain of its table
+            double interpolate(size_t state, double x) const;
         };
 
         /// Represents a state and is used to express fuzzy rules.
@@ -152,9 +284,129 @@ namespace bayesNet {
             RuleState &_state;
         };
 
+        /// Represents a compact table of fuzzy rules.
+        /** The parent states of all rules are stored in one contiguous row-major matrix with one column per parent
+         *  in label order, the resulting states in a separate column. Compared to one Rule instance per rule this
+         *  avoids a heap allocation per rule and keeps the rules of nodes with many parents cache friendly.
+         */
+        class RuleTable {
+        public:
+            /// Constructor
+            RuleTable();
+
+            /// Constructs an empty table for parents with @a parentStates states each and a child with @a childStates states
+            RuleTable(const std::vector<size_t> &parentStates, size_t childStates);
+
+            /// Destructor
+            virtual ~RuleTable();
+
+            /// Adds a new rule with one state per parent @a states and the resulting @a childState
+            void addRule(const unsigned char *states, unsigned char childState);
+
+            /// Returns the parent states of @a rule
+            const unsigned char *getParentStates(size_t rule) const;
+
+            /// Returns the resulting state of @a rule
+            unsigned char getChildState(size_t rule) const;
+
+            /// Returns the number of rules
+            size_t nrRules() const;
+
+            /// Returns the number of parents
+            size_t nrParents() const;
+
+            /// Returns the number of states of each parent
+            const std::vector<size_t> &getParentNrStates() const;
+
+            /// Returns the number of states of the child
+            size_t getChildNrStates() const;
+
+            /// Returns the number of joint states of child and parents
+            size_t nrJointStates() const;
+
+        private:
+            /// Stores the number of states of each parent
+            std::vector<size_t> _parentNrStates;
+
+            /// Stores the number of states of the child
+            size_t _childNrStates;
+
+            /// Stores the parent states, one row per rule
+            std::vector<unsigned char> _parentStates;
+
+            /// Stores the resulting states
+            std::vector<unsigned char> _childStates;
+        };
+
+        /// Represents a complete set of fuzzy rules, which is implicitly defined by a weighted sum of the parent states.
+        /** For each configuration of parent states s_1, ..., s_k there is exactly one rule. Its resulting state is the state
+         *  with maximum strength of the generator fuzzy set at (w_1 s_1 + ... + w_k s_k) / k, ties are resolved to the higher
+         *  state. This equals the rules enumerated by the fuzzy rule generator, without storing states^k rules.
+         */
+        class RuleGenerator {
+        public:
+            /// Constructs a generator for parents with @a parentStates states and @a weights each and a child with @a childStates states
+            /** The membership functions of the generator fuzzy set have to be set using getFuzzySet().
+             */
+            RuleGenerator(const std::vector<size_t> &parentStates, const std::vector<double> &weights, size_t childStates);
+
+            /// Destructor
+            virtual ~RuleGenerator();
+
+            /// Returns the generator fuzzy set
+            FuzzySet &getFuzzySet();
+
+            /// Returns the generator fuzzy set
+            const FuzzySet &getFuzzySet() const;
+
+            /// Returns the weight of @a parent
+            double getWeight(size_t parent) const;
+
+            /// Returns the number of parents
+            size_t nrParents() const;
+
+            /// Returns the number of states of each parent
+            const std::vector<size_t> &getParentNrStates() const;
+
+            /// Returns the number of states of the child
+            size_t getChildNrStates() const;
+
+            /// Returns the number of rules, which is the number of parent configurations
+            size_t nrRules() const;
+
+            /// Returns the resulting state of the rules with weighted parent state sum @a quality
+            unsigned char getChildState(double quality) const;
+
+            /// Returns the resulting state of the rule with one state per parent @a states
+            unsigned char getChildState(const unsigned char *states) const;
+
+            /// Streams all rules in fuzzy rule file format as section of node @a name with parents @a parentNames to @a os
+            void write(std::ostream &os, const std::string &name, const std::vector<std::string> &parentNames) const;
+
+            /// Returns all rules as rule table
+            RuleTable toTable() const;
+
+        private:
+            RuleGenerator(const RuleGenerator &) = delete;
+            RuleGenerator &operator=(const RuleGenerator &) = delete;
+
+            /// Stores the number of states of each parent
+            std::vector<size_t> _parentNrStates;
+
+            /// Stores the weight of each parent
+            std::vector<double> _weights;
+
+            /// Stores the number of states of the child
+            size_t _childNrStates;
+
+            /// Stores the generator fuzzy set
+            FuzzySet _fuzzySet;
+        };
+
         /// Represents a set of fuzzy rules.
         /** A fuzzy rule expresses a whole system of state rules and therefore can be used to apply fuzzy inference on them,
-         *  to infer a CPT corresponding to the set of rule states.
+         *  to infer a CPT corresponding to the set of rule states. The rules are either given as Rule instances, as
+         *  RuleTable or implicitly by a RuleGenerator, the explicit representations are created on first access.
          */
         class RuleSet {
         public:
@@ -164,6 +416,12 @@ namespace bayesNet {
             /// Constructs a set of rules using the rule vector @a rules
             explicit RuleSet(const std::vector<Rule *> &rules);
 
+            /// Constructs a set of rules using the rule @a table
+            explicit RuleSet(const RuleTable &table);
+
+            /// Constructs a set of rules implicitly defined by @a generator
+            explicit RuleSet(const std::shared_ptr<const RuleGenerator> &generator);
+
             /// Destructor
             virtual ~RuleSet();
 
@@ -173,20 +431,55 @@ namespace bayesNet {
             /// Returns all fuzzy rules
             std::vector<Rule *> &getRules();
 
+            /// Returns all fuzzy rules as rule table
+            const RuleTable &getTable();
+
+            /// Returns the rule generator, nullptr if the rules are given explicitly
+            const RuleGenerator *getGenerator() const;
+
             /// Returns the number of joint states
             size_t nrJointStates() const;
 
         private:
             /// Stores the rules
             std::vector<Rule *> _rules;
+
+            /// Stores rules created from the rule table, which are owned by the set
+            std::vector<std::shared_ptr<Rule> > _tableRules;
+
+            /// Stores the rule table
+            RuleTable _table;
+
+            /// Stores the rule generator
+            std::shared_ptr<const RuleGenerator> _generator;
+
+            /// Stores whether _rules represents the set
+            bool _hasRules;
+
+            /// Stores whether _table represents the set
+            bool _hasTable;
         };
 
         /// Represents a fuzzy controller. 
         /** A fuzzy controller uses a set of membership function and a set of fuzzy rules to apply fuzzy inference on them
          *  and calculate a corresponding CPT.
+         *
+         *  Before inference an evaluation plan is prepared: for each parent the strengths of all rule states at the
+         *  maximum of each parent state are precomputed into a states x states matrix. Evaluating a rule for a parent
+         *  configuration then is a product of matrix lookups, without calls to the membership functions. If all strengths
+         *  are within [0, 1], the evaluation of a rule stops as soon as its partial product truncates to zero.
+         *
+         *  Rules defined by a RuleGenerator are not enumerated. Instead the rules are visited as tree of parent states, so a
+         *  partial product which truncates to zero prunes all rules sharing its first parent states at once.
+         *
+         *  Parent configurations are inferred independently of each other, so disjoint ranges of configurations can be
+         *  inferred in parallel once the plan is prepared. The result does not depend on how configurations are split.
          */
         class Controller {
         public:
+            /// Number of parent configurations inferred by one parallel task
+            static const size_t CONFIGURATIONS_PER_TASK = 64;
+
             /// Constructs a controller using a fuzzy @a set, fuzzy @a rules and the null belief @a tolerance
             Controller(const std::vector<FuzzySet *> &set, RuleSet *rules, double tolerance = 0);
 
@@ -196,6 +489,31 @@ namespace bayesNet {
             /// Returns a CPT inferred applying fuzzy inference on the corresponding fuzzy sets/-rules
             CPT inferCPT();
 
+            /// Returns a CPT inferred like inferCPT(), splitting the parent configurations across the threads of @a pool
+            CPT inferCPT(utils::ThreadPool &pool);
+
+            /// Prepares the evaluation plan, which has to be done before inferring ranges of parent configurations
+            void plan();
+
+            /// Returns the number of parent configurations, only valid after plan()
+            size_t nrConfigurations() const;
+
+            /// Returns the size of the inferred CPT, only valid after plan()
+            size_t nrJointStates() const;
+
+            /// Infers the parent configurations [@a begin, @a end) and writes them to @a cpt, only valid after plan()
+            /** Only the CPT entries of the given configurations are written, so disjoint ranges can be inferred
+             *  concurrently into the same CPT.
+             */
+            void inferCPT(CPT &cpt, size_t begin, size_t end) const;
+
+            /// Returns a content hash of everything the inferred CPT depends on, only valid after plan()
+            /** The key covers the strength matrices of the parent fuzzy sets, the rules and the null belief tolerance,
+             *  thus controllers with equal keys infer equal CPTs. The strength matrices are hashed instead of the membership
+             *  functions, since they capture custom membership functions and tabulated fuzzy sets as well.
+             */
+            uint64_t getKey() const;
+
         private:
             /// Stores the fuzzy rules
             RuleSet *_rules;
@@ -206,8 +524,29 @@ namespace bayesNet {
             /// Stores the null belief tolerance
             double _nullBeliefTolerance;
 
-            /// Returns a inferred partial set of probabilities based on @a states
-            std::vector<double> infer(const std::vector<size_t> &states);
+            /// Stores the strength matrix of each parent, indexed by parent state * number of states + rule state
+            std::vector<std::vector<double> > _strengths;
+
+            /// Stores whether all strengths are within [0, 1], so rules can be pruned once their conclusion truncates to zero
+            bool _prunable;
+
+            /// Stores the rule table of the prepared plan, nullptr if the rules are generated
+            const RuleTable *_table;
+
+            /// Stores the rule generator of the prepared plan, nullptr if the rules are given explicitly
+            const RuleGenerator *_generator;
+
+            /// Stores the number of states of each parent of the prepared plan
+            std::vector<size_t> _parentNrStates;
+
+            /// Stores the number of states of the child of the prepared plan
+            size_t _childNrStates;
+
+            /// Writes the inferred partial set of probabilities based on parent @a states to @a beliefs, using @a rows as buffer
+            void infer(const std::vector<size_t> &states, std::vector<const double *> &rows, std::vector<double> &beliefs) const;
+
+            /// Applies the generated rules like infer(), visiting the rules as tree of parent states starting at @a parent
+            void inferGenerated(size_t parent, double tNorm, double quality, const std::vector<const double *> &rows, std::vector<double> &beliefs) const;
         };
 
         namespace membershipFunctions {
@@ -230,6 +569,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores slope
                 double _m;
@@ -262,6 +604,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores begin of increasing slope
                 double _begin;
@@ -298,6 +643,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores begin of increasing slope
                 double _increasingBegin;
@@ -339,6 +687,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores minimum position
                 double _a;
@@ -368,6 +719,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores s-shaped curve
                 SShape _sShape;
@@ -388,6 +742,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores s-shaped curve
                 SShape _sShape;
@@ -411,6 +768,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores start slope param
                 double _a;
@@ -434,6 +794,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores bell start
                 double _a;
@@ -466,6 +829,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores mean
                 double _mean;
@@ -489,6 +855,9 @@ namespace bayesNet {
                 /// Returns string representation of membership function
                 virtual const std::string toString() const;
 
+                /// Returns the tagged curve representation
+                virtual Curve getCurve() const;
+
             private:
                 /// Stores left gaussian curve
                 Gaussian _left;
@@ -7,6 +7,7 @@
 
 
 #include <string>
+#include <vector>
 
 #include <bayesnet/factor.h>
 #include <bayesnet/node.h>
@@ -77,6 +78,12 @@ namespace bayesNet {
             /// Partially init the inference instance based on @a node
             void init(Node &node);
 
+            /// Partially init the inference instance based on all @a nodes at once
+            /** Copies the factors of @a nodes into the factor graph of the inference instance and reinitializes
+             *  the union of their variables once, instead of once per node like init(Node &) does.
+             */
+            void update(const std::vector<Node *> &nodes);
+
             /// Runs the inference algorithm
             void run();
 
@@ -95,7 +102,19 @@ namespace bayesNet {
             /// Returns the filename the algorithm will be saved to
             const std::string &getFilename() const;
 
+            /// Sets prepared junction tree @a clusters, each given as list of node labels
+            /** If clusters are set, init() builds the junction tree directly from them instead of running the
+             *  elimination heuristic. Clusters which refer to unknown nodes or do not cover every factor of the network
+             *  are dropped and recomputed.
+             */
+            void setClusters(const std::vector<std::vector<size_t> > &clusters);
+
+            /// Returns the junction tree clusters as lists of node labels, empty if no junction tree was prepared
+            const std::vector<std::vector<size_t> > &getClusters() const;
+
         private:
+            friend class Context;
+
             /// Stores the algorithm type
             size_t _algorithm;
 
@@ -107,6 +126,95 @@ namespace bayesNet {
 
             /// Stores the filename
             std::string _filename;
+
+            /// Stores the junction tree clusters as node labels
+            std::vector<std::vector<size_t> > _clusters;
+
+            /// Creates a junction tree instance for factor graph @a fg of @a nodes, reusing prepared clusters if available
+            dai::InfAlg *initJunctionTree(const dai::FactorGraph &fg, const std::vector<Node *> &nodes);
+        };
+
+        /// Represents an independent copy of an initialized inference instance, used to evaluate what-if scenarios
+        /** Changing factors of a context does not affect the algorithm it was cloned from, thus several contexts of
+         *  one algorithm can be run in parallel, one context per thread.
+         */
+        class Context {
+        public:
+            /// Constructs a context by cloning the inference instance of @a algorithm
+            explicit Context(const Algorithm &algorithm);
+
+            /// Destructor
+            virtual ~Context();
+
+            /// Copies all factors of the inference instance of @a algorithm, which has to be the algorithm the context was cloned from
+            /** Used to reuse a context after evidence or observations of the network changed.
+             */
+            void synchronize(const Algorithm &algorithm);
+
+            /// Replaces the factor of @a node by @a factor, init() has to be called before run()
+            void setFactor(const Node &node, const dai::Factor &factor);
+
+            /// Reinitializes the inference instance
+            /** All messages are reset, so the result of run() does not depend on previously evaluated factors.
+             */
+            void init();
+
+            /// Runs the inference algorithm
+            void run();
+
+            /// Returns the belief based on the given @a node
+            state::BayesBelief belief(const Node &node) const;
+
+        private:
+            Context(const Context &) = delete;
+            Context &operator=(const Context &) = delete;
+
+            /// Stores the cloned inference instance
+            dai::InfAlg *_inferenceInstance;
+        };
+
+        /// Represents beliefs of several nodes for a set of evaluated points as dense row-major matrix
+        /** Each row corresponds to one point, the beliefs of the states of target t are stored in the columns
+         *  [offsets[t], offsets[t] + number of states of t).
+         */
+        struct BeliefMatrix {
+            /// Stores the number of rows
+            size_t rows;
+
+            /// Stores the number of columns
+            size_t columns;
+
+            /// Stores the first column of each target
+            std::vector<size_t> offsets;
+
+            /// Stores the beliefs, rows * columns entries
+            std::vector<double> values;
+        };
+
+        /// Represents the distribution of beliefs of several nodes over a set of samples
+        /** The columns are laid out like the ones of BeliefMatrix. Quantiles are stored in one row per quantile level.
+         */
+        struct BeliefDistribution {
+            /// Stores the number of samples
+            size_t samples;
+
+            /// Stores the number of distinct quantized observations, each of which was evaluated once
+            size_t evaluations;
+
+            /// Stores the number of columns
+            size_t columns;
+
+            /// Stores the first column of each target
+            std::vector<size_t> offsets;
+
+            /// Stores the mean beliefs, one entry per column
+            std::vector<double> mean;
+
+            /// Stores the quantile levels in [0, 1]
+            std::vector<double> levels;
+
+            /// Stores the quantiles, levels.size() * columns entries
+            std::vector<double> quantiles;
         };
     }
 }
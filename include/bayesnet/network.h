@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
 
 #include <bayesnet/node.h>
 #include <bayesnet/state.h>
@@ -40,6 +41,13 @@ namespace bayesNet {
         /// Constructs a network using the @a file
         explicit Network(const std::string &file);
 
+        /// Constructs a network using the @a file and the compiled network cache in directory @a cacheDirectory
+        /** On a cache hit the network is loaded from its binary representation and init() reuses the cached
+         *  junction tree clusters. On a miss the network file is parsed and the cache entry is written, the
+         *  junction tree clusters are added to the entry by the first init().
+         */
+        Network(const std::string &file, const std::string &cacheDirectory);
+
         /// Destructor
         virtual ~Network();
 
@@ -61,6 +69,15 @@ namespace bayesNet {
         /// Sets observation of sensor value @a x on sensor node @a name
         void observe(const std::string &name, double x);
 
+        /// Sets observation of sensor value @a x on sensor node with id @a node, without allocating memory
+        void observe(size_t node, double x);
+
+        /// Sets all @a n @a observations, given as pairs of node id and sensor value, and updates the inference instance once
+        void observe(const std::pair<size_t, double> *observations, size_t n);
+
+        /// Returns the id of node @a name, which can be used to observe sensor values without name lookups
+        size_t getNodeId(const std::string &name) const;
+
         /// Sets evidence on a node with @a name and @a state
         void setEvidence(const std::string &name, size_t state);
 
@@ -73,21 +90,46 @@ namespace bayesNet {
         /// Parses fuzzy rules from @a file and apply them to the corresponding nodes
         void setFuzzyRules(const std::string &file);
 
+        /// Applies the rules implicitly defined by the @a generatorLogicFile logic file to all nodes with parents
+        /** The rules are evaluated directly by the fuzzy controller, so no rule file needs to be generated and parsed.
+         *  The inferred CPTs are identical to the ones inferred from the rules written by generateDefaultFuzzyRules().
+         */
+        void setFuzzyRuleGenerator(const std::string &generatorLogicFile);
+
         /// Generates a default set of fuzzy rules using @a generatorLogicFile logic file for a loaded network and saves them in @a file 
+        /** The rules are streamed to the file node by node, without holding them in memory.
+         */
         void generateDefaultFuzzyRules(const std::string &file, const std::string &generatorLogicFile);
 
+        /// Caches inferred CPTs in @a directory, an empty directory disables the cache
+        /** CPTs are looked up by a content hash of the parent fuzzy sets, the rules and the tolerance before they are
+         *  inferred, so nodes which are unchanged since a previous run, even of another network, skip the inference.
+         */
+        void setCPTCache(const std::string &directory);
+
         /// Infer CPTs from fuzzy rules for all available nodes, which has got set fuzzy sets
         void inferCPT();
 
         /// Infer CPT from fuzzy rules for node @a name
         void inferCPT(const std::string &name);
 
+        /// Infer CPTs like inferCPT(), distributing nodes and ranges of their parent configurations across the threads of @a pool
+        /** The inferred CPTs are identical to the ones of the sequential inference.
+         */
+        void inferCPT(utils::ThreadPool &pool);
+
         /// Apply inference on the network
         void run();
 
         /// Returns a Node @a name
         Node &getNode(const std::string &name);
 
+        /// Returns the Node with id @a id, see getNodeId()
+        Node &getNode(size_t id);
+
+        /// Returns the number of nodes, node ids range from 0 to nrNodes() - 1
+        size_t nrNodes() const;
+
         /// Returns all parents of a node @a name
         std::vector<Node *> getParents(const std::string &name);
 
@@ -97,6 +139,44 @@ namespace bayesNet {
         /// Returns bayes belief as continious value from -1 to 1 for node @a name
         double getContinousBelief(const std::string &name);
 
+        /// Returns @a belief as continious value from -1 to 1, like getContinousBelief(const std::string &) does
+        static double getContinousBelief(const state::BayesBelief &belief);
+
+        /// Returns a new clone of the initialized inference instance
+        /** The clone holds the current factors and beliefs of the network and is independent of later changes of the
+         *  network, so it can be used as evidence context of its own, e.g. one per client of a server.
+         */
+        std::unique_ptr<inference::Context> createContext() const;
+
+        /// Returns SensorNode instance for @a node or throws exception
+        static SensorNode &getSensor(Node &node);
+
+        /// Returns boolean whether @a node is sensor
+        static bool isSensor(Node &node);
+
+        /// Evaluates the beliefs of @a targets for each of the @a values of node @a name, using all available cores
+        /** On a sensor node each value is observed, on any other node the value is set as evidence state. Each value
+         *  is evaluated on a clone of the inference instance, so the network itself is left unchanged. Returns one
+         *  row per value. The threads are created by the first call and reused by later ones.
+         */
+        inference::BeliefMatrix sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets);
+
+        /// Evaluates the beliefs like sweep(), distributing the values across the threads of @a pool
+        inference::BeliefMatrix sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets, utils::ThreadPool &pool);
+
+        /// Sets the noise @a model of sensor node @a name, which is used to draw samples by observeSamples()
+        void setNoiseModel(const std::string &name, const utils::NoiseModel &model);
+
+        /// Propagates sensor noise by evaluating @a samples noisy samples of the @a n @a observations, given as pairs of node id and sensor value
+        /** For each sample a value of each sensor is drawn from its noise model, fuzzified and quantized like observe() does.
+         *  Samples are drawn and fuzzified in parallel batches, each batch using its own random generator seeded from @a seed,
+         *  so results do not depend on the number of threads. As observations are quantized, many samples share the same
+         *  quantized observation, which is evaluated only once on a clone of the inference instance. Returns the mean
+         *  beliefs of @a targets and their quantiles at @a levels. The network itself is left unchanged.
+         */
+        inference::BeliefDistribution observeSamples(const std::pair<size_t, double> *observations, size_t n, size_t samples, const std::vector<std::string> &targets,
+                                                     const std::vector<double> &levels, utils::ThreadPool &pool, uint64_t seed = 0);
+
         /// Loads a network from @a iv
         void load(file::InitializationVector *iv);
 
@@ -106,6 +186,13 @@ namespace bayesNet {
         /// Saves the network to file @a networkFilename and writing algorithm settings to file @a algorithmFilename
         void save(const std::string &networkFilename, const std::string &algorithmFilename);
 
+        /// Saves only changed CPTs and fuzzy sets of the network by appending them to the journal of file @a filename
+        /** Changes are tracked relative to the file the network was loaded from or last saved to, so falls back to a
+         *  full save if @a filename is another file or does not exist yet. The journal is compacted by a full save
+         *  as soon as its size exceeds @a compactionRatio times the size of the network file.
+         */
+        void saveIncremental(const std::string &filename, double compactionRatio = 0.5);
+
     private:
         /// Stores node names for label lookup
         std::unordered_map<std::string, size_t> _registry;
@@ -125,14 +212,39 @@ namespace bayesNet {
         /// Stores the nodes with available fuzzy sets
         std::vector<std::string> _availableFuzzySets;
 
+        /// Stores the network file the network was constructed from
+        std::string _file;
+
+        /// Stores the network file the network was loaded from or last saved to, which the changed flags of the nodes refer to
+        std::string _savedFile;
+
+        /// Stores the compiled network cache directory, empty if no cache is used
+        std::string _cacheDirectory;
+
+        /// Stores the inferred cpt cache directory, empty if no cache is used
+        std::string _cptCacheDirectory;
+
+        /// Stores the sensor nodes of the current batch observation
+        std::vector<Node *> _observed;
+
+        /// Stores clones of the inference instance, reused by sweep() and observeSamples()
+        std::vector<std::unique_ptr<inference::Context> > _contexts;
+
+        /// Stores the thread pool of sweep() without a pool, created on first use
+        std::unique_ptr<utils::ThreadPool> _pool;
+
+        /// Prepares @a n clones of the inference instance, synchronized with the current factors of the network
+        void prepareContexts(size_t n);
+
+        /// Returns the nodes @a targets and assigns their columns in a dense belief matrix to @a offsets and @a columns
+        std::vector<Node *> getTargets(const std::vector<std::string> &targets, std::vector<size_t> &offsets, size_t &columns);
+
         /// Returns parents of a @a node
         std::vector<Node *> getParents(Node &node);
 
-        /// Returns SensorNode instance for @a node or throws exception
-        static SensorNode &getSensor(Node &node);
+        /// Returns the rule generator of @a node with @a parents defined by @a generatorLogic
+        static std::shared_ptr<fuzzyLogic::RuleGenerator> createRuleGenerator(Node &node, const std::vector<Node *> &parents, file::GeneratorLogic &generatorLogic);
 
-        /// Returns boolean whether @a node is sensor
-        static bool isSensor(Node &node);
     };
 }
 
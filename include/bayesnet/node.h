@@ -10,6 +10,7 @@
 #include <bayesnet/factor.h>
 #include <bayesnet/cpt.h>
 #include <bayesnet/fuzzy.h>
+#include <bayesnet/util.h>
 
 
 namespace bayesNet {
@@ -82,6 +83,9 @@ namespace bayesNet {
         /// Returns fuzzy set
         fuzzyLogic::FuzzySet &getFuzzySet();
 
+        /// Returns fuzzy set
+        const fuzzyLogic::FuzzySet &getFuzzySet() const;
+
         /// Returns all fuzzy rules
         fuzzyLogic::RuleSet &getFuzzyRules();
 
@@ -100,6 +104,19 @@ namespace bayesNet {
         /// Returns boolean if Node is binary or not
         bool isBinary() const;
 
+        /// Returns if the CPT has changed since the last call of clearDirty()
+        bool isCPTDirty() const;
+
+        /// Returns if the fuzzy set has changed since the last call of clearDirty()
+        bool isFuzzySetDirty() const;
+
+        /// Marks CPT and fuzzy set as unchanged, e.g. after they have been saved
+        void clearDirty();
+
+    protected:
+        /// Overwrites CPT and factor entries in place with @a probabilities, which has to hold as many entries as the CPT
+        void updateCPT(const std::vector<double> &probabilities);
+
     private:
         /// Stores the name
         std::string _name;
@@ -127,6 +144,12 @@ namespace bayesNet {
 
         /// Stores references to children
         std::vector<Node *> _children;
+
+        /// Stores the CPT changed flag
+        bool _cptDirty;
+
+        /// Stores the fuzzy set changed flag
+        bool _fuzzySetDirty;
     };
 
     /// Represents a bayes node in a bayesian network, which can handle continuous variable observations
@@ -144,7 +167,34 @@ namespace bayesNet {
         virtual ~SensorNode();
 
         /// Maps a continous observation @a x to a discrete CPT representation and builds updates the Node's CPT, Factor 
+        /** Uses a preallocated strength buffer and overwrites CPT and factor in place, so no memory is allocated.
+         */
         void observe(double x);
+
+        /// Maps a continous observation @a x to the discrete @a probabilities of the states, without changing the Node
+        void mapObservation(double x, std::vector<double> &probabilities) const;
+
+        /// Maps @a n continous observations @a xs to state strengths quantized like observe(), stored at @a percents[i * stride + state]
+        /** Uses the batch fuzzification of the fuzzy set and @a strengths as scratch buffer. Does not change the Node,
+         *  thus it can be called from several threads at once.
+         */
+        void quantizeObservations(const double *xs, size_t n, std::vector<double> &strengths, unsigned char *percents, size_t stride) const;
+
+        /// Converts the quantized state strengths @a percents of one observation to the discrete @a probabilities of @a states states
+        static void toProbabilities(const unsigned char *percents, size_t states, std::vector<double> &probabilities);
+
+        /// Sets the noise @a model of the sensor
+        void setNoiseModel(const utils::NoiseModel &model);
+
+        /// Returns the noise model of the sensor
+        const utils::NoiseModel &getNoiseModel() const;
+
+    private:
+        /// Stores the strength buffer used by observe()
+        std::vector<double> _strength;
+
+        /// Stores the noise model
+        utils::NoiseModel _noiseModel;
     };
 
     /// stream operator used to write string representation of @a node to iostream @a os
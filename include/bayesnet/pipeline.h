@@ -0,0 +1,164 @@
+/// @file
+/// @brief Defines the Pipeline class used to chain networks, feeding continous beliefs of one network as observations into the next.
+
+
+#ifndef BAYESNET_FRAMEWORK_PIPELINE_H
+#define BAYESNET_FRAMEWORK_PIPELINE_H
+
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <exception>
+
+#include <bayesnet/network.h>
+
+
+namespace bayesNet {
+
+    namespace pipeline {
+
+        /// Represents a frame of values passed between the stages of a pipeline
+        struct Frame {
+            /// Stores the sequence number assigned by Pipeline::push
+            uint64_t sequence;
+
+            /// Stores the values, either the observations of the next stage or the output beliefs of the last stage
+            std::vector<double> values;
+
+            /// Stores the time the frame was pushed into the pipeline
+            std::chrono::steady_clock::time_point created;
+
+            /// Stores the time the frame was queued for the next stage
+            std::chrono::steady_clock::time_point queued;
+        };
+
+        /// Represents the latency and queueing statistics of a pipeline stage, all times in milliseconds
+        struct StageStatistics {
+            /// Stores the number of processed frames
+            size_t frames;
+
+            /// Stores the mean time to observe, run and read the beliefs of one frame
+            double meanLatency;
+
+            /// Stores the maximum time to observe, run and read the beliefs of one frame
+            double maxLatency;
+
+            /// Stores the mean time a frame waited in the input queue of the stage
+            double meanQueueTime;
+
+            /// Stores the maximum time a frame waited in the input queue of the stage
+            double maxQueueTime;
+
+            /// Stores the maximum number of frames waiting in the input queue of the stage
+            size_t maxQueueLength;
+        };
+
+        class FrameQueue;
+        struct Stage;
+
+        /// Represents a chain of networks evaluated as pipeline
+        /** Each stage wraps a network and runs on its own thread. A frame pushed into the pipeline is observed on the
+         *  input sensors of the first stage. After a stage applied inference, the continous beliefs of its linked nodes
+         *  are observed on the corresponding sensors of the next stage, so stage N processes frame t while stage N + 1
+         *  processes frame t - 1. The stages are connected by bounded queues, thus the throughput is limited by the
+         *  slowest stage. The beliefs of the output nodes of the last stage are returned by pop() in push order.
+         *  Networks must be initialized before start() and must not be used by other threads while the pipeline runs.
+         */
+        class Pipeline {
+        public:
+            /// Constructs an empty pipeline, whose stages are connected by queues holding up to @a capacity frames
+            explicit Pipeline(size_t capacity = 4);
+
+            /// Destructor, stops the pipeline discarding queued frames
+            virtual ~Pipeline();
+
+            /// Appends @a network as new stage and returns the index of the stage
+            size_t addStage(Network &network);
+
+            /// Returns the number of stages
+            size_t nrStages() const;
+
+            /// Adds sensor node @a sensor of the first stage as input, returns the index of the input within pushed values
+            size_t addInput(const std::string &sensor);
+
+            /// Links the continous belief of node @a source of @a stage to sensor node @a target of the next stage
+            void link(size_t stage, const std::string &source, const std::string &target);
+
+            /// Adds node @a name of the last stage as output, returns the index of the output within popped values
+            size_t addOutput(const std::string &name);
+
+            /// Resolves the links and starts the stage threads
+            void start();
+
+            /// Pushes the sensor @a values of a new frame, ordered like the inputs, and returns its sequence number
+            /** Blocks while the input queue of the first stage is full.
+             */
+            uint64_t push(const std::vector<double> &values);
+
+            /// Pops the next processed @a frame, returns false if the pipeline is stopped and no frames are left
+            /** Blocks until a frame is available. Exceptions thrown by a stage are rethrown.
+             */
+            bool pop(Frame &frame);
+
+            /// Stops accepting frames and waits until all pushed frames passed the last stage
+            /** Processed frames can still be popped afterwards. Exceptions thrown by a stage are rethrown.
+             */
+            void stop();
+
+            /// Returns if the pipeline is running
+            bool isRunning() const;
+
+            /// Returns latency and queueing statistics of @a stage
+            StageStatistics getStatistics(size_t stage) const;
+
+            /// Returns the number of frames per second passing the last stage since start
+            double getThroughput() const;
+
+        private:
+            /// Main loop of the thread of stage @a index
+            void work(size_t index);
+
+            /// Stores the first exception thrown by a stage and closes all queues
+            void fail(std::exception_ptr exception);
+
+            /// Joins all stage threads
+            void join();
+
+            /// Rethrows the first exception thrown by a stage, if any
+            void rethrow();
+
+            /// Stores the stages
+            std::vector<Stage *> _stages;
+
+            /// Stores the queues, queue i feeds stage i and the last queue holds the processed frames
+            std::vector<FrameQueue *> _queues;
+
+            /// Stores the output node names of the last stage
+            std::vector<std::string> _outputs;
+
+            /// Stores the capacity of the queues between stages
+            size_t _capacity;
+
+            /// Stores the sequence number of the next pushed frame
+            uint64_t _sequence;
+
+            /// Stores running flag
+            bool _running;
+
+            /// Stores the start time
+            std::chrono::steady_clock::time_point _started;
+
+            /// Guards the exception
+            std::mutex _mutex;
+
+            /// Stores the first exception thrown by a stage
+            std::exception_ptr _exception;
+        };
+    }
+}
+
+
+#endif //BAYESNET_FRAMEWORK_PIPELINE_H
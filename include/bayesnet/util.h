@@ -9,6 +9,13 @@
 #include <vector>
 #include <string>
 #include <random>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
 
 
 namespace bayesNet {
@@ -30,6 +37,59 @@ namespace bayesNet {
         /// Returns true if @a c is whitespace or quotation character
         bool isWhitespaceOrQuotationMark(char c);
 
+        /// Reads the whole content of file @a name into @a content and returns false if the file cannot be read
+        bool readFile(const std::string &name, std::string &content);
+
+        /// Returns a fast non-cryptographic 64 bit hash of @a size bytes at @a data, chained with a previous @a seed
+        /** The data is consumed in four independent 64 bit lanes, so hashing runs at memory speed instead of
+         *  being bound by the latency of a bytewise hash. Results depend on the byte order of the machine.
+         */
+        uint64_t hash(const void *data, size_t size, uint64_t seed = 0);
+
+        /// Returns the hash of string @a s, chained with a previous @a seed
+        uint64_t hash(const std::string &s, uint64_t seed = 0);
+
+        /// Represents the noise distribution of a sensor, used to draw noisy samples around an observed value
+        class NoiseModel {
+        public:
+            /// Enumeration of noise distributions
+            enum Type {
+                NONE,
+                GAUSSIAN,
+                UNIFORM
+            };
+
+            /// Constructs a noise model of @a type with @a scale and constant @a bias
+            /** The scale is the standard deviation of gaussian noise or the half width of uniform noise.
+             */
+            explicit NoiseModel(Type type = NONE, double scale = 0.0, double bias = 0.0);
+
+            /// Destructor
+            ~NoiseModel();
+
+            /// Returns the noise distribution
+            Type getType() const;
+
+            /// Returns the scale
+            double getScale() const;
+
+            /// Returns the bias
+            double getBias() const;
+
+            /// Returns a sample of the noisy observation of the true value @a x, drawn using @a rng
+            double sample(double x, std::mt19937_64 &rng) const;
+
+        private:
+            /// Stores the noise distribution
+            Type _type;
+
+            /// Stores the scale
+            double _scale;
+
+            /// Stores the bias
+            double _bias;
+        };
+
         /// Digitwise counter class
         /** The class increments a number by each digit seperatly with overflow carry if maximum state is reached.
          *  Least significant digit is at zero position of vector.
@@ -67,6 +127,140 @@ namespace bayesNet {
             /// Stores the current increment
             size_t _increment;
         };
+
+        /// Mixed radix odometer tracking the flat index of its configuration in a strided layout
+        /** Digit zero changes fastest. Each digit advances the flat index by its stride, which by default is the product of
+         *  the radices of all lower digits, so the flat index equals the configuration number. Custom strides address the
+         *  entries of a subset of variables within a larger table, e.g. the layout of a dai::Factor. Advancing carries only
+         *  into the digits that overflow, which takes amortized constant time per step.
+         *
+         *  The odometer visits a range of configurations, so disjoint ranges can be visited by parallel workers.
+         */
+        class Odometer {
+        public:
+            /// Constructs an odometer for digits with @a radices, visiting all configurations
+            explicit Odometer(const std::vector<size_t> &radices);
+
+            /// Constructs an odometer for digits with @a radices, advancing the flat index by @a strides
+            Odometer(const std::vector<size_t> &radices, const std::vector<size_t> &strides);
+
+            /// Destructor
+            ~Odometer();
+
+            /// Restricts the visited configurations to [@a begin, @a end) and moves to @a begin
+            void range(size_t begin, size_t end);
+
+            /// Moves to configuration @a position
+            void seek(size_t position);
+
+            /// Advances to the next configuration and returns whether it is within the range
+            bool next();
+
+            /// Returns whether the current configuration is within the range
+            bool valid() const;
+
+            /// Returns the current configuration number
+            size_t getPosition() const;
+
+            /// Returns the flat index of the current configuration
+            size_t getIndex() const;
+
+            /// Returns the current digits
+            const std::vector<size_t> &getDigits() const;
+
+            /// Returns the stride of @a digit
+            size_t getStride(size_t digit) const;
+
+            /// Returns the number of configurations
+            size_t size() const;
+
+        private:
+            /// Stores the current digits
+            std::vector<size_t> _digits;
+
+            /// Stores the radix of each digit
+            std::vector<size_t> _radices;
+
+            /// Stores the stride of each digit
+            std::vector<size_t> _strides;
+
+            /// Stores the number of configurations
+            size_t _size;
+
+            /// Stores the current configuration number
+            size_t _position;
+
+            /// Stores the end of the range
+            size_t _end;
+
+            /// Stores the flat index of the current configuration
+            size_t _index;
+        };
+
+        /// Pool of worker threads executing parallel loops
+        /** The calling thread participates in each loop, so a pool of size one runs loops sequentially without any
+         *  worker thread. Loop indices are handed out dynamically, so uneven work items are balanced across threads.
+         *  Concurrent calls of parallelFor are serialized, calling parallelFor from within a loop body is not supported.
+         */
+        class ThreadPool {
+        public:
+            /// Constructs a pool using @a threads threads including the calling thread, zero uses the hardware concurrency
+            explicit ThreadPool(size_t threads = 0);
+
+            /// Destructor, stops and joins the worker threads
+            ~ThreadPool();
+
+            /// Returns the number of threads including the calling thread
+            size_t size() const;
+
+            /// Calls @a body for each index in [0, @a n) and returns when all calls finished
+            /** If a call throws, the remaining indices are skipped and the first exception is rethrown.
+             */
+            void parallelFor(size_t n, const std::function<void(size_t)> &body);
+
+        private:
+            /// Main loop of the worker threads
+            void work();
+
+            /// Executes loop indices of the current loop until none are left
+            void run();
+
+            /// Stores the worker threads
+            std::vector<std::thread> _workers;
+
+            /// Serializes concurrent loops
+            std::mutex _loopMutex;
+
+            /// Guards the loop state
+            std::mutex _mutex;
+
+            /// Signals workers that a new loop started or the pool stops
+            std::condition_variable _wake;
+
+            /// Signals the caller that all workers left the current loop
+            std::condition_variable _done;
+
+            /// Stores the body of the current loop
+            const std::function<void(size_t)> *_body;
+
+            /// Stores the number of indices of the current loop
+            size_t _size;
+
+            /// Stores the next index to execute
+            std::atomic<size_t> _next;
+
+            /// Stores the number of workers executing the current loop
+            size_t _active;
+
+            /// Stores the number of started loops, used by workers to detect new loops
+            size_t _generation;
+
+            /// Stores whether the pool stops
+            bool _stop;
+
+            /// Stores the first exception thrown by the current loop
+            std::exception_ptr _exception;
+        };
     }
 }
 
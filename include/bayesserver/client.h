@@ -0,0 +1,98 @@
+/// @file
+/// @brief Defines the client of the BayesServer's unix domain socket transport, used by processes on the same host.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <bayesserver/types.h>
+#include <bayesserver/protocol.h>
+
+namespace bayesServer {
+
+    /// Represents a blocking client of the unix domain socket of a server
+    /** Each frame is a 32 bit little endian length followed by a message of the binary protocol or, if it does not
+     *  start with the protocol version, a json message. Nodes are addressed by their handle, the position in the node
+     *  table of the loaded or attached session. Failed requests throw a REQUEST_FAILED exception, broken connections
+     *  a CONNECTION_FAILED exception. Subscriptions are not supported, pushed updates are skipped. A client must not
+     *  be used by several threads at once.
+     */
+    class LocalClient {
+    public:
+        /// Connects to the server listening on the unix domain socket @a path
+        explicit LocalClient(const std::string &path);
+
+        /// Destructor, closes the connection
+        virtual ~LocalClient();
+
+        /// Loads network @a file into a new session, registered as @a session if not empty, and returns the node table
+        const std::vector<NodeEntry> &loadNetwork(const std::string &file, const std::string &session = "");
+
+        /// Attaches the named session @a session and returns the node table
+        const std::vector<NodeEntry> &attachSession(const std::string &session);
+
+        /// Closes the named session @a session
+        void closeSession(const std::string &session);
+
+        /// Returns the node table of the loaded or attached session
+        const std::vector<NodeEntry> &getNodes() const;
+
+        /// Returns the handle of node @a name
+        size_t getHandle(const std::string &name) const;
+
+        /// Sets the evidence of node @a node to @a state and returns the new evidence version
+        uint64_t setEvidence(size_t node, size_t state);
+
+        /// Clears the evidence of node @a node and returns the new evidence version
+        uint64_t clearEvidence(size_t node);
+
+        /// Observes @a value on sensor node @a node and returns the new evidence version
+        uint64_t observe(size_t node, double value);
+
+        /// Returns the beliefs of @a nodes
+        Beliefs getBeliefs(const std::vector<size_t> &nodes);
+
+        /// Applies @a operations at once and returns the beliefs of their GET_BELIEF operations, nodes are handles
+        Beliefs batch(const std::vector<Operation> &operations);
+
+        /// Sends the json request @a message, like a websocket text message, and returns the json response
+        std::string request(const std::string &message);
+
+        LocalClient(const LocalClient &) = delete;
+        LocalClient &operator=(const LocalClient &) = delete;
+
+    private:
+        /// Sends the binary request with @a opcode and @a payload, returns the payload of its response
+        std::string call(uint8_t opcode, const std::string &payload);
+
+        /// Reads the node table of a LOAD_NETWORK or ATTACH_SESSION response
+        void readNodes(const std::string &payload);
+
+        /// Reads the beliefs of @a nodes from a GET_BELIEFS or BATCH response
+        Beliefs readBeliefs(const std::string &payload, const std::vector<size_t> &nodes) const;
+
+        /// Sends @a message as frame
+        void send(const std::string &message);
+
+        /// Receives the next frame
+        std::string receive();
+
+        /// Stores the socket descriptor
+        int _socket;
+
+        /// Stores received bytes not yet returned
+        std::string _buffer;
+
+        /// Stores the id of the next binary request
+        uint32_t _nextId;
+
+        /// Stores the node table
+        std::vector<NodeEntry> _nodes;
+
+        /// Stores the handles by node name
+        std::unordered_map<std::string, size_t> _handles;
+    };
+}
@@ -0,0 +1,99 @@
+/// @file
+/// @brief Defines the Executor class used by the BayesServer to run requests on worker threads.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace bayesServer {
+
+    /// Represents a pool of worker threads executing tasks queued on strands
+    /** Tasks of the same strand are executed one after another in submit order, tasks of different strands run in
+     *  parallel. The number of queued tasks is bounded, submit() rejects tasks instead of blocking if the queue is
+     *  full. Queued tasks can be cancelled until a worker starts them.
+     */
+    class Executor {
+    public:
+        /// Constructs an executor using @a threads worker threads, zero uses the hardware concurrency, queueing up to @a capacity tasks
+        explicit Executor(size_t threads = 0, size_t capacity = 1024);
+
+        /// Destructor, waits for running tasks and discards queued tasks
+        virtual ~Executor();
+
+        /// Returns the number of worker threads
+        size_t size() const;
+
+        /// Returns the maximum number of queued tasks
+        size_t getCapacity() const;
+
+        /// Returns the number of queued tasks, not including running tasks
+        size_t nrQueued() const;
+
+        /// Queues @a task on @a strand and returns its ticket, or zero if the queue is full
+        uint64_t submit(const void *strand, const std::function<void()> &task);
+
+        /// Removes the queued task @a ticket, returns false if the task already started or is unknown
+        bool cancel(uint64_t ticket);
+
+    private:
+        /// Represents a queued task
+        struct Task {
+            /// Stores the ticket
+            uint64_t ticket;
+
+            /// Stores the function
+            std::function<void()> function;
+        };
+
+        /// Represents the queued tasks of a strand
+        struct Strand {
+            Strand() : running(false) {}
+
+            /// Stores the queued tasks in submit order
+            std::deque<Task> tasks;
+
+            /// Stores whether a task of the strand is running
+            bool running;
+        };
+
+        /// Main loop of the worker threads
+        void work();
+
+        /// Stores the worker threads
+        std::vector<std::thread> _workers;
+
+        /// Stores the maximum number of queued tasks
+        size_t _capacity;
+
+        /// Stores the number of queued tasks
+        size_t _queued;
+
+        /// Stores the ticket of the next task
+        uint64_t _ticket;
+
+        /// Stores the strands with queued tasks or a running task
+        std::unordered_map<const void *, Strand> _strands;
+
+        /// Stores the strands waiting for a worker, may contain strands which are running or have no tasks left
+        std::deque<const void *> _ready;
+
+        /// Stores the strand of each queued task
+        std::unordered_map<uint64_t, const void *> _tickets;
+
+        /// Stores stop flag
+        bool _stop;
+
+        /// Guards all members
+        mutable std::mutex _mutex;
+
+        /// Signals workers that a strand is ready or the executor stops
+        std::condition_variable _wake;
+    };
+}
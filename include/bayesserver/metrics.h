@@ -0,0 +1,146 @@
+/// @file
+/// @brief Defines the metrics of the BayesServer, request counters and latency histograms of each processing stage.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bayesServer {
+
+    /// Represents a latency histogram with log-linear buckets like HdrHistogram
+    /** Values below 16 are counted exactly, each higher power of two range is split into 16 linear sub buckets, so
+     *  percentiles are reported with a relative error below 1/16 over the whole 64 bit range. Recording is lock
+     *  free and may be called by several threads, reading while recording returns a consistent enough snapshot.
+     */
+    class Histogram {
+    public:
+        /// Constructs an empty histogram
+        Histogram();
+
+        /// Records @a value
+        void record(uint64_t value);
+
+        /// Returns the number of recorded values
+        uint64_t count() const;
+
+        /// Returns the sum of recorded values
+        uint64_t sum() const;
+
+        /// Returns the largest recorded value
+        uint64_t max() const;
+
+        /// Returns the value at or below which the fraction @a q of the recorded values fall, 0 if empty
+        uint64_t percentile(double q) const;
+
+        /// Returns the index of the bucket of @a value
+        static size_t getBucket(uint64_t value);
+
+        /// Returns the highest value of @a bucket
+        static uint64_t getUpperBound(size_t bucket);
+
+        /// Number of linear sub buckets of each power of two range
+        static const size_t SUB_BUCKETS = 16;
+
+        /// Number of buckets
+        static const size_t NR_BUCKETS = SUB_BUCKETS + (64 - 4) * SUB_BUCKETS;
+
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+    private:
+        /// Stores the count of each bucket
+        std::array<std::atomic<uint64_t>, NR_BUCKETS> _buckets;
+
+        /// Stores the number of recorded values
+        std::atomic<uint64_t> _count;
+
+        /// Stores the sum of recorded values
+        std::atomic<uint64_t> _sum;
+
+        /// Stores the largest recorded value
+        std::atomic<uint64_t> _max;
+    };
+
+    /// Represents the metrics of a server
+    /** Latencies are recorded in nanoseconds for each processing stage and each action, actions are created on
+     *  first use. All methods are thread safe.
+     */
+    class Metrics {
+    public:
+        /// Enumeration of processing stages
+        enum Stage {
+            QUEUE_WAIT,
+            APPLY,
+            RUN,
+            BELIEFS,
+            SERIALIZE,
+            NUM_STAGES
+        };
+
+        /// Represents the counters of an action
+        struct Action {
+            /// Stores the latencies from receiving to answering requests
+            Histogram latency;
+
+            /// Stores the number of failed requests
+            std::atomic<uint64_t> errors;
+
+            /// Constructs the counters of an action
+            Action();
+        };
+
+        /// Constructs empty metrics
+        Metrics();
+
+        /// Returns the name of @a stage
+        static const char *getStageName(Stage stage);
+
+        /// Returns the nanoseconds elapsed since @a start
+        static uint64_t elapsed(std::chrono::steady_clock::time_point start);
+
+        /// Records @a nanoseconds spent in @a stage
+        void record(Stage stage, uint64_t nanoseconds);
+
+        /// Records a request of @a action answered after @a nanoseconds
+        void recordRequest(const std::string &action, uint64_t nanoseconds, bool failed);
+
+        /// Records a request rejected because the queue was full
+        void recordRejected();
+
+        /// Returns the histogram of @a stage, the count of the RUN stage is the number of inference runs
+        const Histogram &getHistogram(Stage stage) const;
+
+        /// Returns the names of all actions seen so far
+        std::vector<std::string> getActions() const;
+
+        /// Returns the counters of @a action, which has to be returned by getActions()
+        const Action &getAction(const std::string &action) const;
+
+        /// Returns the number of rejected requests
+        uint64_t nrRejected() const;
+
+        /// Returns the metrics in Prometheus text exposition format, including the current values of @a gauges
+        std::string toPrometheus(const std::map<std::string, double> &gauges) const;
+
+    private:
+        /// Stores the histogram of each stage
+        std::array<Histogram, NUM_STAGES> _stages;
+
+        /// Stores the counters of each action
+        std::map<std::string, std::unique_ptr<Action> > _actions;
+
+        /// Stores the number of rejected requests
+        std::atomic<uint64_t> _rejected;
+
+        /// Guards the actions map, not the counters
+        mutable std::mutex _mutex;
+    };
+}
@@ -0,0 +1,157 @@
+/// @file
+/// @brief Defines the binary wire protocol of the BayesServer, the message layout is documented in the README.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <bayesserver/types.h>
+
+namespace bayesServer {
+
+    namespace protocol {
+
+        /// Protocol version written to and expected in each header
+        const uint8_t VERSION = 1;
+
+        /// Size of the header in bytes
+        const size_t HEADER_SIZE = 8;
+
+        /// Enumeration of the opcodes of requests, responses use the opcode of their request
+        enum Opcode {
+            LOAD_NETWORK = 1,
+            ATTACH_SESSION = 2,
+            CLOSE_SESSION = 3,
+            SET_EVIDENCE = 4,
+            CLEAR_EVIDENCE = 5,
+            OBSERVE = 6,
+            GET_BELIEFS = 7,
+            BATCH = 8,
+            CANCEL = 9,
+            SUBSCRIBE = 10,
+            UNSUBSCRIBE = 11,
+            UPDATE = 12
+        };
+
+        /// Enumeration of the status codes of responses, requests use SUCCESS
+        enum Status {
+            SUCCESS = 0,
+            FAILURE = 1,
+            CANCELLED = 2,
+            BUSY = 3
+        };
+
+        /// Represents the header of a message
+        struct Header {
+            /// Stores the protocol version
+            uint8_t version;
+
+            /// Stores the opcode
+            uint8_t opcode;
+
+            /// Stores the status
+            uint16_t status;
+
+            /// Stores the request id chosen by the client, echoed by the response
+            uint32_t id;
+        };
+
+        /// Represents an encoder appending little endian values to a byte buffer
+        class Writer {
+        public:
+            /// Constructs a writer appending to @a buffer
+            explicit Writer(std::string &buffer);
+
+            /// Writes the @a header
+            void writeHeader(const Header &header);
+
+            /// Writes @a value as 8 bit unsigned integer
+            void writeUInt8(uint8_t value);
+
+            /// Writes @a value as 16 bit unsigned integer
+            void writeUInt16(uint16_t value);
+
+            /// Writes @a value as 32 bit unsigned integer
+            void writeUInt32(uint32_t value);
+
+            /// Writes @a value as 64 bit unsigned integer
+            void writeUInt64(uint64_t value);
+
+            /// Writes @a value as 64 bit IEEE 754 floating point number
+            void writeDouble(double value);
+
+            /// Writes @a value as 16 bit length followed by the UTF-8 bytes
+            void writeString(const std::string &value);
+
+        private:
+            /// Stores the buffer
+            std::string &_buffer;
+        };
+
+        /// Represents a decoder reading little endian values from a byte buffer
+        /** Reading beyond the end of the buffer throws an INVALID_MESSAGE exception.
+         */
+        class Reader {
+        public:
+            /// Constructs a reader of the @a size bytes at @a data
+            Reader(const char *data, size_t size);
+
+            /// Reads a header, the version is not checked
+            Header readHeader();
+
+            /// Reads an 8 bit unsigned integer
+            uint8_t readUInt8();
+
+            /// Reads a 16 bit unsigned integer
+            uint16_t readUInt16();
+
+            /// Reads a 32 bit unsigned integer
+            uint32_t readUInt32();
+
+            /// Reads a 64 bit unsigned integer
+            uint64_t readUInt64();
+
+            /// Reads a 64 bit IEEE 754 floating point number
+            double readDouble();
+
+            /// Reads a string written by Writer::writeString()
+            std::string readString();
+
+            /// Returns the number of bytes left
+            size_t remaining() const;
+
+        private:
+            /// Throws if less than @a n bytes are left
+            void require(size_t n) const;
+
+            /// Stores the data
+            const unsigned char *_data;
+
+            /// Stores the size
+            size_t _size;
+
+            /// Stores the read position
+            size_t _position;
+        };
+
+        /// Writes the node table @a nodes, the handle of each node is its position in the table
+        void writeNodes(Writer &writer, const std::vector<NodeEntry> &nodes);
+
+        /// Reads a node table written by writeNodes()
+        std::vector<NodeEntry> readNodes(Reader &reader);
+
+        /// Reads a count followed by the node handles
+        std::vector<size_t> readHandles(Reader &reader);
+
+        /// Reads the operations of a SET_EVIDENCE, CLEAR_EVIDENCE, OBSERVE, GET_BELIEFS or BATCH request with @a opcode
+        std::vector<Operation> readOperations(uint8_t opcode, Reader &reader);
+
+        /// Writes the versions of @a beliefs and the number of values of all beliefs followed by the packed values
+        void writeBeliefs(Writer &writer, const Beliefs &beliefs);
+
+        /// Writes the versions and the number of @a beliefs followed by the handle and the values of each belief, as sent by UPDATE messages
+        void writeUpdate(Writer &writer, const std::vector<size_t> &handles, const Beliefs &beliefs);
+    }
+}
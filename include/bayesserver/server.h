@@ -2,9 +2,27 @@
 
 #include <QObject>
 #include <QWebSocketServer>
-#include <QList>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QLocalServer>
+#include <QFileSystemWatcher>
+#include <QSet>
 
-#include <bayesnet/network.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <bayesserver/session.h>
+#include <bayesserver/executor.h>
+#include <bayesserver/protocol.h>
+#include <bayesserver/metrics.h>
 
 namespace bayesServer {
 
@@ -13,23 +31,122 @@ namespace bayesServer {
 
     public:
         explicit Server(quint16 port, QObject* parent = nullptr);
+        Server(quint16 port, const QString& cacheDirectory, QObject* parent = nullptr);
+        Server(quint16 port, const QString& cacheDirectory, size_t threads, size_t queueCapacity, QObject* parent = nullptr);
         virtual ~Server();
 
+        void setSchedule(const Schedule& schedule);
+        // serves the metrics in Prometheus text format over HTTP on localhost, returns false if the port is not available
+        bool listenMetrics(quint16 port);
+        // accepts clients on the unix domain socket @a path, exchanging length prefixed binary or json frames
+        bool listenLocal(const QString& path);
+        // creates and warms up the named sessions of the preload configuration @a config and reloads their networks when
+        // the files or their journals change, throws if the configuration or a network is invalid
+        void preload(const QString& config);
+
     signals:
         void closed();
         void listening();
+        // emitted when a preloaded network @a file was reloaded, @a error is empty on success
+        void networkReloaded(const QString& file, const QString& error);
 
     private slots:
         void onNewConnection();
         void processTextMessage(const QString& message);
+        void processBinaryMessage(const QByteArray& message);
         void socketDisconnected();
-        void networkChanged();
+        void onMetricsConnection();
+        void onLocalConnection();
+        void processLocalData();
+        void onNetworkChanged(const QString& path);
+        void onDirectoryChanged(const QString& path);
 
     private:
+        // queued request of a client, which can be cancelled by its id
+        struct Request {
+            quint64 ticket;
+            bool binary;
+            QString action;
+            // the json id, or the header id of binary requests
+            QJsonValue id;
+            quint8 opcode;
+            std::chrono::steady_clock::time_point received;
+        };
+
+        // belief subscription of a client, replaced as a whole and only used by the requests of the client
+        struct Subscription {
+            std::shared_ptr<Session> session;
+            size_t listener;
+            std::vector<size_t> nodes;
+            Beliefs beliefs;
+            double epsilon;
+            int interval;
+            bool binary;
+        };
+
+        // state of a client, shared with the workers executing its requests
+        struct Connection : std::enable_shared_from_this<Connection> {
+            Connection(QObject* socket, bool local) : socket(socket), local(local), pending(false), lastPush(0) {}
+
+            // a QWebSocket, or a QLocalSocket sending length prefixed frames
+            QObject* socket;
+            bool local;
+            // received bytes of incomplete frames of local clients
+            QByteArray frames;
+            std::mutex mutex;
+            std::shared_ptr<Session> session;
+            std::shared_ptr<Subscription> subscription;
+            // queued requests by key, see jsonKey() and binaryKey()
+            QHash<QString, Request> requests;
+            // set by session listeners until the next push, so a burst of changes schedules a single push
+            std::atomic<bool> pending;
+            qint64 lastPush;
+        };
+
+        void processText(const std::shared_ptr<Connection>& connection, const QByteArray& message);
+        void processBinary(const std::shared_ptr<Connection>& connection, const QByteArray& message);
+        void submit(const std::shared_ptr<Connection>& connection, const QString& key, const Request& request, const std::function<QByteArray(bool& failed)>& work);
+        bool cancel(Connection& connection, const QString& key);
+        void send(Connection& connection, bool binary, const QByteArray& message);
+        QByteArray reject(const Request& request, protocol::Status status, const QString& message);
+        QJsonObject execute(Connection& connection, const QString& action, const QJsonObject& payload);
+        QByteArray execute(Connection& connection, const protocol::Header& header, const QByteArray& message);
+        std::shared_ptr<Session> getSession(Connection& connection);
+        void setSession(Connection& connection, const std::shared_ptr<Session>& session);
+        std::shared_ptr<Subscription> subscribe(Connection& connection, const std::vector<size_t>& nodes, double epsilon, double maxRate, bool binary);
+        void unsubscribe(Connection& connection, const std::vector<size_t>& nodes);
+        void schedulePush(const std::shared_ptr<Connection>& connection);
+        void push(const std::shared_ptr<Connection>& connection);
+        QByteArray pushBeliefs(Connection& connection, bool& binary);
+        void reload(const QString& file);
+        // watches the network @a file, its journal and their directory, in which the journal may be created later
+        void watch(const QString& file);
+        QJsonObject stats() const;
+        std::map<std::string, double> gauges() const;
+
+        static std::string getActionName(const Request& request);
+        // keys of requests, ids of any json type are distinguished by their compact serialization and never equal binary keys
+        static QString jsonKey(const QJsonValue& id);
+        static QString binaryKey(quint32 id);
+
+        static QByteArray response(const QJsonValue& id, const QString& action, QJsonObject payload);
+        static QByteArray error(const QJsonValue& id, const QString& action, const QString& message);
+        static QByteArray error(quint8 opcode, quint32 id, protocol::Status status, const QString& message);
+
         QWebSocketServer* _socket;
-        QList<QWebSocket*> _clients;
-        bayesNet::Network* _network;
-        bool _networkChanged;
+        QTcpServer* _metricsSocket;
+        QLocalServer* _localSocket;
+        QFileSystemWatcher* _watcher;
+        // preloaded network files by watched path, the network file itself or its journal
+        QHash<QString, QString> _networkFiles;
+        // changed files waiting for the reload delay
+        QSet<QString> _changedFiles;
+        QHash<QObject*, std::shared_ptr<Connection> > _connections;
+        // declared before the registry and the executor, which record into it
+        Metrics _metrics;
+        Registry _registry;
+        QElapsedTimer _clock;
+        bayesNet::utils::ThreadPool _sweepPool;
+        Executor _executor;
     };
 }
-
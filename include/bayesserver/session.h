@@ -0,0 +1,353 @@
+/// @file
+/// @brief Defines the sessions of the BayesServer, each holding the evidence of its clients on a shared compiled network.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+#include <bayesnet/network.h>
+#include <bayesnet/util.h>
+#include <bayesserver/metrics.h>
+#include <bayesserver/types.h>
+
+namespace bayesServer {
+
+    /// Represents a network file which is parsed, initialized and run once and afterwards only read
+    /** All sessions of the same network file share one compiled network. Its nodes, base factors and prepared
+     *  inference instance are never changed, the evidence of a session lives in the session's own inference context.
+     */
+    class CompiledNetwork {
+    public:
+        /// Loads and initializes the network @a file, using the compiled network cache in @a cacheDirectory if not empty
+        CompiledNetwork(const std::string &file, const std::string &cacheDirectory);
+
+        /// Returns the network file
+        const std::string &getFile() const;
+
+        /// Returns the number of nodes
+        size_t nrNodes() const;
+
+        /// Returns the id of node @a name
+        size_t getNodeId(const std::string &name) const;
+
+        /// Returns the node with id @a id
+        const bayesNet::Node &getNode(size_t id) const;
+
+        /// Returns the factor of node @a id without any evidence or observation
+        const bayesNet::Factor &getFactor(size_t id) const;
+
+        /// Returns whether node @a id is a sensor node
+        bool isSensor(size_t id) const;
+
+        /// Returns the node table, sent to clients which address nodes by handle
+        const std::vector<NodeEntry> &getNodeTable() const;
+
+        /// Maps the observation @a x of sensor node @a id to the discrete @a probabilities of its states
+        void mapObservation(size_t id, double x, std::vector<double> &probabilities) const;
+
+        /// Returns a new inference context holding the base factors and beliefs of the network
+        std::unique_ptr<bayesNet::inference::Context> createContext() const;
+
+        /// Returns the first difference of the node tables of this and the @a other network, empty if both have the same
+        /// node names in the same order with the same number of states and sensor flags, so node ids are interchangeable
+        std::string compareNodes(const CompiledNetwork &other) const;
+
+    private:
+        /// Stores the network file
+        std::string _file;
+
+        /// Stores the network
+        std::unique_ptr<bayesNet::Network> _network;
+
+        /// Stores the nodes by id
+        std::vector<const bayesNet::Node *> _nodes;
+
+        /// Stores the sensor nodes by id, null for other nodes
+        std::vector<const bayesNet::SensorNode *> _sensors;
+
+        /// Stores the base factors by id
+        std::vector<bayesNet::Factor> _factors;
+
+        /// Stores the node table
+        std::vector<NodeEntry> _table;
+
+        /// Serializes cloning of the inference instance
+        mutable std::mutex _mutex;
+    };
+
+    /// Represents the policy deciding when a session applies inference after its evidence changed
+    struct Schedule {
+        /// Enumeration of scheduling modes
+        enum Mode {
+            /// Inference is applied by each read following a change
+            ON_DEMAND,
+
+            /// Inference is applied by reads, at most once per interval
+            INTERVAL,
+
+            /// Inference is applied by the change completing a number of updates, reads never apply inference
+            UPDATES
+        };
+
+        /// Constructs the on demand schedule
+        Schedule();
+
+        /// Constructs a schedule from its string representation "on_demand", "interval:<ms>" or "updates:<n>"
+        explicit Schedule(const std::string &schedule);
+
+        /// Returns the string representation
+        std::string toString() const;
+
+        /// Stores the mode
+        Mode mode;
+
+        /// Stores the minimum time between two runs in milliseconds of the INTERVAL mode
+        size_t interval;
+
+        /// Stores the number of updates of the UPDATES mode
+        size_t updates;
+    };
+
+    /// Represents a named evidence context of one or more clients on a compiled network
+    /** A session only stores the factors of the nodes its clients changed and its own clone of the inference
+     *  instance, so creating sessions is cheap and sessions never see the evidence of each other. Inference is
+     *  applied only if evidence changed since the last run, when it is applied is decided by the schedule. Each
+     *  change increments the evidence version of the session, so readers can tell which evidence beliefs reflect.
+     *  All methods are thread safe, calls of several clients sharing a session are serialized. The session can be
+     *  rebound to a reloaded version of its network with the same node table, keeping its evidence.
+     */
+    class Session {
+    public:
+        /// Constructs session @a name on @a network applying inference by @a schedule, stage latencies are recorded in @a metrics if not null
+        Session(const std::string &name, const std::shared_ptr<const CompiledNetwork> &network, const Schedule &schedule = Schedule(), Metrics *metrics = nullptr);
+
+        /// Returns the session name, empty for private sessions
+        const std::string &getName() const;
+
+        /// Returns the compiled network, which is replaced by rebind()
+        std::shared_ptr<const CompiledNetwork> getNetwork() const;
+
+        /// Returns the id of node @a name in the current network
+        size_t getNodeId(const std::string &name) const;
+
+        /// Returns the name of node @a id in the current network
+        std::string getNodeName(size_t id) const;
+
+        /// Replaces the compiled network by @a network, a reloaded version of the same file, and applies inference
+        /** The node table of @a network has to equal the current one, see CompiledNetwork::compareNodes(), so node
+         *  ids of clients stay valid. The evidence and observations of the session are applied again. Increments the
+         *  evidence version.
+         */
+        void rebind(const std::shared_ptr<const CompiledNetwork> &network);
+
+        /// Applies inference on the inference context once and reads all beliefs, without changing the evidence version
+        void warmUp();
+
+        /// Marks the session as closed, clients still holding the session should release it
+        void close();
+
+        /// Returns whether the session was closed
+        bool isClosed() const;
+
+        /// Returns the schedule
+        Schedule getSchedule() const;
+
+        /// Sets the schedule
+        void setSchedule(const Schedule &schedule);
+
+        /// Returns the evidence version, the number of evidence changes since the session was created
+        uint64_t getVersion() const;
+
+        /// Sets evidence @a state on node @a name and returns the new evidence version
+        uint64_t setEvidence(const std::string &name, size_t state);
+
+        /// Clears evidence or observation of node @a name and returns the new evidence version
+        uint64_t clearEvidence(const std::string &name);
+
+        /// Observes sensor value @a x on sensor node @a name and returns the new evidence version
+        uint64_t observe(const std::string &name, double x);
+
+        /// Applies the evidence changes of @a operations in order and returns the beliefs of their GET_BELIEF operations
+        /** All nodes are validated before any evidence is changed, so either all or none of the changes are applied.
+         *  Inference is applied at most once, after all changes, thus the beliefs reflect the evidence of all operations
+         *  regardless of their position in the batch, unless the schedule defers inference. Other clients of the session
+         *  do not observe intermediate states.
+         */
+        Beliefs batch(const std::vector<Operation> &operations);
+
+        /// Evaluates the beliefs of @a targets for each of the @a values of node @a name like bayesNet::Network::sweep()
+        /** Each thread of @a pool evaluates the values on its own context holding the evidence of the session,
+         *  the session itself is left unchanged.
+         */
+        bayesNet::inference::BeliefMatrix sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets, bayesNet::utils::ThreadPool &pool);
+
+        /// Registers @a listener, which is called by the changing thread after each evidence change, and returns its id
+        /** Listeners are called while the listeners are locked, thus they must not block or add or remove listeners.
+         */
+        size_t addListener(const std::function<void()> &listener);
+
+        /// Removes the listener @a id
+        void removeListener(size_t id);
+
+    private:
+        /// Calls all listeners
+        void notify();
+
+        /// Applies inference if evidence changed since the last run, the caller has to hold the mutex
+        void update();
+
+        /// Applies inference if evidence changed and the schedule requires a run before reading, the caller has to hold the mutex
+        void refresh();
+
+        /// Applies inference if the schedule requires a run after changes, the caller has to hold the mutex
+        void changed();
+
+        /// Returns the factor of node @a id holding the evidence of this session, created from the base factor if needed
+        bayesNet::Factor &getFactor(size_t id);
+
+        /// Sets evidence @a state on node @a id, the caller has to hold the mutex
+        void applyEvidence(size_t id, size_t state);
+
+        /// Observes sensor value @a x on sensor node @a id, the caller has to hold the mutex
+        void applyObservation(size_t id, double x);
+
+        /// Clears evidence or observation of node @a id, the caller has to hold the mutex
+        void removeEvidence(size_t id);
+
+        /// Returns a new context holding the evidence of this session
+        std::unique_ptr<bayesNet::inference::Context> createContext() const;
+
+        /// Stores the session name
+        std::string _name;
+
+        /// Stores the compiled network
+        std::shared_ptr<const CompiledNetwork> _network;
+
+        /// Stores the inference context
+        std::unique_ptr<bayesNet::inference::Context> _context;
+
+        /// Stores the factors of all nodes with evidence or observations, by node id
+        std::map<size_t, bayesNet::Factor> _factors;
+
+        /// Stores the evidence state or observed value of all nodes with evidence or observations, by node id, replayed by rebind()
+        std::map<size_t, Operation> _evidence;
+
+        /// Stores the ids of nodes changed since the last run
+        std::vector<size_t> _changed;
+
+        /// Stores the schedule
+        Schedule _schedule;
+
+        /// Stores the evidence version
+        uint64_t _version;
+
+        /// Stores the evidence version of the last run
+        uint64_t _resultVersion;
+
+        /// Stores the time of the last run
+        std::chrono::steady_clock::time_point _lastRun;
+
+        /// Stores the metrics, may be null
+        Metrics *_metrics;
+
+        /// Stores closed flag
+        std::atomic<bool> _closed;
+
+        /// Serializes access of several clients
+        mutable std::mutex _mutex;
+
+        /// Stores the listeners by id
+        std::map<size_t, std::function<void()> > _listeners;
+
+        /// Stores the id of the next listener
+        size_t _nextListener;
+
+        /// Serializes access to the listeners
+        std::mutex _listenerMutex;
+    };
+
+    /// Represents the compiled networks and named sessions of a server
+    /** Each network file is compiled only once while sessions on it exist. Named sessions can be shared by several
+     *  clients, private sessions are only known to the client which created them. The registry is thread safe.
+     */
+    class Registry {
+    public:
+        /// Constructs an empty registry, compiled networks are cached in @a cacheDirectory if not empty
+        explicit Registry(const std::string &cacheDirectory = "", Metrics *metrics = nullptr);
+
+        /// Returns the compiled network of @a file, which is loaded if no session uses it yet
+        /** The network is loaded without holding the registry lock, concurrent requests for the same file wait for
+         *  the first load instead of loading the file again.
+         */
+        std::shared_ptr<const CompiledNetwork> getNetwork(const std::string &file);
+
+        /// Creates a session on network @a file, a non empty @a name registers the session so it can be attached by other clients
+        std::shared_ptr<Session> createSession(const std::string &name, const std::string &file);
+
+        /// Returns the named session @a name
+        std::shared_ptr<Session> getSession(const std::string &name) const;
+
+        /// Unregisters and closes the named session @a name, attached clients are detached on their next request
+        void closeSession(const std::string &name);
+
+        /// Returns the number of named sessions
+        size_t nrSessions() const;
+
+        /// Returns the number of compiled networks in use
+        size_t nrNetworks() const;
+
+        /// Returns the schedule of new sessions
+        Schedule getSchedule() const;
+
+        /// Sets the schedule of new sessions
+        void setSchedule(const Schedule &schedule);
+
+        /// Compiles network @a file again and rebinds all sessions on it, see Session::rebind()
+        /** The new version is compiled without holding any lock, so requests continue on the previous version until
+         *  it is swapped in. New sessions use the new version afterwards. If the file can not be compiled or its
+         *  node table differs from the previous version, the previous version is kept and the error is thrown.
+         */
+        void reload(const std::string &file);
+
+        /// Creates the named sessions listed in the preload configuration @a config and warms them up, returns their network files
+        /** Each line of the configuration holds a session name, a network file and optionally a schedule, lines
+         *  starting with ';' are comments. The networks are compiled in parallel.
+         */
+        std::vector<std::string> preload(const std::string &config);
+
+    private:
+        /// Stores the compiled network cache directory
+        std::string _cacheDirectory;
+
+        /// Stores the schedule of new sessions
+        Schedule _schedule;
+
+        /// Stores the metrics of new sessions, may be null
+        Metrics *_metrics;
+
+        /// Stores the compiled networks by file, released as soon as no session uses them
+        std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> > _networks;
+
+        /// Stores the networks currently loaded by file
+        std::unordered_map<std::string, std::shared_future<std::shared_ptr<const CompiledNetwork> > > _loading;
+
+        /// Stores the named sessions
+        std::unordered_map<std::string, std::shared_ptr<Session> > _sessions;
+
+        /// Stores the sessions by network file, rebound when the file is reloaded, released ones are pruned on insert
+        std::unordered_map<std::string, std::vector<std::weak_ptr<Session> > > _bound;
+
+        /// Guards networks and sessions
+        mutable std::mutex _mutex;
+    };
+}
@@ -0,0 +1,57 @@
+/// @file
+/// @brief Defines the types exchanged between the BayesServer and its clients, which need neither the server nor inference.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <bayesnet/state.h>
+
+namespace bayesServer {
+
+    /// Represents one operation of a batch, see Session::batch()
+    struct Operation {
+        /// Enumeration of operation types
+        enum Type {
+            SET_EVIDENCE,
+            CLEAR_EVIDENCE,
+            OBSERVE,
+            GET_BELIEF
+        };
+
+        /// Stores the operation type
+        Type type;
+
+        /// Stores the node id, see CompiledNetwork::getNodeId()
+        size_t node;
+
+        /// Stores the evidence state or the observed sensor value
+        double value;
+    };
+
+    /// Represents beliefs read from a session together with the evidence they reflect
+    struct Beliefs {
+        /// Stores the beliefs
+        std::vector<bayesNet::state::BayesBelief> beliefs;
+
+        /// Stores the evidence version the beliefs reflect
+        uint64_t version;
+
+        /// Stores the evidence version of the session when the beliefs were read, greater than version if they are stale
+        uint64_t evidenceVersion;
+    };
+
+    /// Represents a node of the node table of a network, the handle of a node is its position in the table
+    struct NodeEntry {
+        /// Stores the node name
+        std::string name;
+
+        /// Stores the number of states
+        size_t nrStates;
+
+        /// Stores whether the node is a sensor node
+        bool sensor;
+    };
+}
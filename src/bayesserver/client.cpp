@@ -0,0 +1,307 @@
+#include <bayesserver/client.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <bayesnet/exception.h>
+
+namespace bayesServer {
+
+    namespace {
+
+        // bytes read from the socket at once, so small frames are received by a single system call
+        const size_t READ_SIZE = 64 * 1024;
+
+        // avoids SIGPIPE if the server closed the connection, where the platform supports it
+#ifdef MSG_NOSIGNAL
+        const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+        const int SEND_FLAGS = 0;
+#endif
+    }
+
+    LocalClient::LocalClient(const std::string &path) : _socket(-1), _nextId(1) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path)) {
+            BAYESNET_THROWE(CONNECTION_FAILED, "socket path too long: " + path);
+        }
+
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        _socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (_socket < 0 || ::connect(_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            std::string error = std::strerror(errno);
+
+            if (_socket >= 0) {
+                ::close(_socket);
+            }
+
+            BAYESNET_THROWE(CONNECTION_FAILED, path + ": " + error);
+        }
+    }
+
+    LocalClient::~LocalClient() {
+        ::close(_socket);
+    }
+
+    const std::vector<NodeEntry> &LocalClient::loadNetwork(const std::string &file, const std::string &session) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeString(file);
+        writer.writeString(session);
+
+        readNodes(call(protocol::LOAD_NETWORK, payload));
+
+        return _nodes;
+    }
+
+    const std::vector<NodeEntry> &LocalClient::attachSession(const std::string &session) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeString(session);
+
+        readNodes(call(protocol::ATTACH_SESSION, payload));
+
+        return _nodes;
+    }
+
+    void LocalClient::closeSession(const std::string &session) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeString(session);
+
+        call(protocol::CLOSE_SESSION, payload);
+    }
+
+    const std::vector<NodeEntry> &LocalClient::getNodes() const {
+        return _nodes;
+    }
+
+    size_t LocalClient::getHandle(const std::string &name) const {
+        std::unordered_map<std::string, size_t>::const_iterator it = _handles.find(name);
+
+        if (it == _handles.end()) {
+            BAYESNET_THROWE(NODE_NOT_FOUND, name);
+        }
+
+        return it->second;
+    }
+
+    uint64_t LocalClient::setEvidence(size_t node, size_t state) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeUInt32(static_cast<uint32_t>(node));
+        writer.writeUInt32(static_cast<uint32_t>(state));
+
+        std::string response = call(protocol::SET_EVIDENCE, payload);
+        protocol::Reader reader(response.data(), response.size());
+
+        return reader.readUInt64();
+    }
+
+    uint64_t LocalClient::clearEvidence(size_t node) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeUInt32(static_cast<uint32_t>(node));
+
+        std::string response = call(protocol::CLEAR_EVIDENCE, payload);
+        protocol::Reader reader(response.data(), response.size());
+
+        return reader.readUInt64();
+    }
+
+    uint64_t LocalClient::observe(size_t node, double value) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeUInt32(static_cast<uint32_t>(node));
+        writer.writeDouble(value);
+
+        std::string response = call(protocol::OBSERVE, payload);
+        protocol::Reader reader(response.data(), response.size());
+
+        return reader.readUInt64();
+    }
+
+    Beliefs LocalClient::getBeliefs(const std::vector<size_t> &nodes) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        writer.writeUInt32(static_cast<uint32_t>(nodes.size()));
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            writer.writeUInt32(static_cast<uint32_t>(nodes[i]));
+        }
+
+        return readBeliefs(call(protocol::GET_BELIEFS, payload), nodes);
+    }
+
+    Beliefs LocalClient::batch(const std::vector<Operation> &operations) {
+        std::string payload;
+        protocol::Writer writer(payload);
+        std::vector<size_t> nodes;
+        writer.writeUInt32(static_cast<uint32_t>(operations.size()));
+
+        for (size_t i = 0; i < operations.size(); ++i) {
+            writer.writeUInt8(static_cast<uint8_t>(operations[i].type));
+            writer.writeUInt32(static_cast<uint32_t>(operations[i].node));
+            writer.writeDouble(operations[i].value);
+
+            if (operations[i].type == Operation::GET_BELIEF) {
+                nodes.push_back(operations[i].node);
+            }
+        }
+
+        return readBeliefs(call(protocol::BATCH, payload), nodes);
+    }
+
+    std::string LocalClient::request(const std::string &message) {
+        send(message);
+
+        // skip binary frames, which are pushed updates
+        for (;;) {
+            std::string response = receive();
+
+            if (response.empty() || static_cast<uint8_t>(response[0]) != protocol::VERSION) {
+                return response;
+            }
+        }
+    }
+
+    std::string LocalClient::call(uint8_t opcode, const std::string &payload) {
+        uint32_t id = _nextId++;
+        std::string message;
+        protocol::Writer writer(message);
+        writer.writeHeader(protocol::Header{protocol::VERSION, opcode, protocol::SUCCESS, id});
+        message.append(payload);
+
+        send(message);
+
+        for (;;) {
+            std::string response = receive();
+
+            // skip pushed updates and json frames
+            if (response.empty() || static_cast<uint8_t>(response[0]) != protocol::VERSION) {
+                continue;
+            }
+
+            protocol::Reader reader(response.data(), response.size());
+            protocol::Header header = reader.readHeader();
+
+            if (header.opcode == protocol::UPDATE || header.id != id) {
+                continue;
+            }
+
+            if (header.status != protocol::SUCCESS) {
+                BAYESNET_THROWE(REQUEST_FAILED, reader.readString());
+            }
+
+            return response.substr(protocol::HEADER_SIZE);
+        }
+    }
+
+    void LocalClient::readNodes(const std::string &payload) {
+        protocol::Reader reader(payload.data(), payload.size());
+
+        _nodes = protocol::readNodes(reader);
+        _handles.clear();
+
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            _handles[_nodes[i].name] = i;
+        }
+    }
+
+    Beliefs LocalClient::readBeliefs(const std::string &payload, const std::vector<size_t> &nodes) const {
+        protocol::Reader reader(payload.data(), payload.size());
+        Beliefs beliefs;
+        beliefs.version = reader.readUInt64();
+        beliefs.evidenceVersion = reader.readUInt64();
+        uint32_t n = reader.readUInt32();
+        size_t expected = 0;
+
+        // the values are packed, the number of states of each node is known from the node table
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i] >= _nodes.size()) {
+                BAYESNET_THROWE(INVALID_MESSAGE, "unknown node handle " + std::to_string(nodes[i]));
+            }
+
+            expected += _nodes[nodes[i]].nrStates;
+        }
+
+        // a mismatch means the node table does not belong to the network of the session
+        if (n != expected) {
+            BAYESNET_THROWE(INVALID_MESSAGE, std::to_string(n) + " belief values received, expected " + std::to_string(expected));
+        }
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            bayesNet::state::BayesBelief belief(_nodes[nodes[i]].nrStates == 2);
+
+            for (size_t s = 0; s < belief.nrStates(); ++s) {
+                belief.set(s, reader.readDouble());
+            }
+
+            beliefs.beliefs.push_back(belief);
+        }
+
+        return beliefs;
+    }
+
+    void LocalClient::send(const std::string &message) {
+        // length prefix and message are sent by a single system call
+        std::string frame;
+        protocol::Writer writer(frame);
+        writer.writeUInt32(static_cast<uint32_t>(message.size()));
+        frame.append(message);
+
+        size_t sent = 0;
+
+        while (sent < frame.size()) {
+            ssize_t n = ::send(_socket, frame.data() + sent, frame.size() - sent, SEND_FLAGS);
+
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (n <= 0) {
+                BAYESNET_THROWE(CONNECTION_FAILED, std::strerror(errno));
+            }
+
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    std::string LocalClient::receive() {
+        char data[READ_SIZE];
+
+        for (;;) {
+            if (_buffer.size() >= 4) {
+                protocol::Reader reader(_buffer.data(), 4);
+                size_t size = reader.readUInt32();
+
+                if (_buffer.size() - 4 >= size) {
+                    std::string message = _buffer.substr(4, size);
+                    _buffer.erase(0, 4 + size);
+
+                    return message;
+                }
+            }
+
+            ssize_t n = ::recv(_socket, data, sizeof(data), 0);
+
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (n <= 0) {
+                BAYESNET_THROWE(CONNECTION_FAILED, n == 0 ? "connection closed by server" : std::strerror(errno));
+            }
+
+            _buffer.append(data, static_cast<size_t>(n));
+        }
+    }
+}
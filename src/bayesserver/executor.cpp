@@ -0,0 +1,146 @@
+#include <bayesserver/executor.h>
+
+#include <algorithm>
+
+namespace bayesServer {
+
+    Executor::Executor(size_t threads, size_t capacity) : _capacity(capacity), _queued(0), _ticket(0), _stop(false) {
+        if (threads == 0) {
+            threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        for (size_t i = 0; i < threads; ++i) {
+            _workers.push_back(std::thread(&Executor::work, this));
+        }
+    }
+
+    Executor::~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+
+        _wake.notify_all();
+
+        for (size_t i = 0; i < _workers.size(); ++i) {
+            _workers[i].join();
+        }
+    }
+
+    size_t Executor::size() const {
+        return _workers.size();
+    }
+
+    size_t Executor::getCapacity() const {
+        return _capacity;
+    }
+
+    size_t Executor::nrQueued() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queued;
+    }
+
+    uint64_t Executor::submit(const void *strand, const std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // reject instead of growing the queue without bound
+        if (_queued >= _capacity) {
+            return 0;
+        }
+
+        Task entry;
+        entry.ticket = ++_ticket;
+        entry.function = task;
+
+        Strand &s = _strands[strand];
+        s.tasks.push_back(entry);
+        _tickets[entry.ticket] = strand;
+        _queued++;
+
+        // a running strand is queued again by its worker
+        if (!s.running && s.tasks.size() == 1) {
+            _ready.push_back(strand);
+            _wake.notify_one();
+        }
+
+        return entry.ticket;
+    }
+
+    bool Executor::cancel(uint64_t ticket) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::unordered_map<uint64_t, const void *>::iterator search = _tickets.find(ticket);
+
+        if (search == _tickets.end()) {
+            return false;
+        }
+
+        // the strand stays in the ready queue and is dropped by the worker if no tasks are left
+        std::deque<Task> &tasks = _strands[search->second].tasks;
+
+        for (std::deque<Task>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+            if (it->ticket == ticket) {
+                tasks.erase(it);
+                break;
+            }
+        }
+
+        _tickets.erase(search);
+        _queued--;
+
+        return true;
+    }
+
+    void Executor::work() {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (true) {
+            _wake.wait(lock, [this] { return _stop || !_ready.empty(); });
+
+            if (_stop) {
+                return;
+            }
+
+            const void *strand = _ready.front();
+            _ready.pop_front();
+
+            std::unordered_map<const void *, Strand>::iterator search = _strands.find(strand);
+
+            // skip strands which are already running or whose tasks were cancelled
+            if (search == _strands.end() || search->second.running) {
+                continue;
+            }
+
+            if (search->second.tasks.empty()) {
+                _strands.erase(search);
+                continue;
+            }
+
+            Task task = search->second.tasks.front();
+            search->second.tasks.pop_front();
+            search->second.running = true;
+            _tickets.erase(task.ticket);
+            _queued--;
+
+            lock.unlock();
+
+            try {
+                task.function();
+            } catch (...) {
+                // tasks report their errors themselves
+            }
+
+            lock.lock();
+
+            // continue the strand with its next task, the strand is looked up again as other strands might have been erased
+            Strand &s = _strands[strand];
+            s.running = false;
+
+            if (s.tasks.empty()) {
+                _strands.erase(strand);
+            } else {
+                _ready.push_back(strand);
+                _wake.notify_one();
+            }
+        }
+    }
+}
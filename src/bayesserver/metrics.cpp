@@ -0,0 +1,253 @@
+#include <bayesserver/metrics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace bayesServer {
+
+    namespace {
+
+        // quantiles exported by summaries
+        const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+        // escapes a Prometheus label value
+        std::string escape(const std::string &value) {
+            std::string escaped;
+
+            for (size_t i = 0; i < value.size(); ++i) {
+                if (value[i] == '\\' || value[i] == '"') {
+                    escaped += '\\';
+                    escaped += value[i];
+                } else if (value[i] == '\n') {
+                    escaped += "\\n";
+                } else {
+                    escaped += value[i];
+                }
+            }
+
+            return escaped;
+        }
+
+        // writes the quantiles, sum and count of a histogram of nanoseconds as summary in seconds
+        void writeSummary(std::ostream &out, const std::string &name, const std::string &labels, const Histogram &histogram) {
+            for (double q : QUANTILES) {
+                out << name << "{" << labels << ",quantile=\"" << q << "\"} " << histogram.percentile(q) * 1e-9 << "\n";
+            }
+
+            out << name << "_sum{" << labels << "} " << histogram.sum() * 1e-9 << "\n";
+            out << name << "_count{" << labels << "} " << histogram.count() << "\n";
+        }
+    }
+
+    Histogram::Histogram() : _count(0), _sum(0), _max(0) {
+        for (size_t i = 0; i < NR_BUCKETS; ++i) {
+            _buckets[i] = 0;
+        }
+    }
+
+    void Histogram::record(uint64_t value) {
+        _buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t max = _max.load(std::memory_order_relaxed);
+
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t Histogram::count() const {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::sum() const {
+        return _sum.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::max() const {
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::percentile(double q) const {
+        uint64_t total = count();
+
+        if (total == 0) {
+            return 0;
+        }
+
+        // rank of the requested value, at least the first one
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+        rank = rank < 1 ? 1 : rank;
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < NR_BUCKETS; ++i) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+
+            if (seen >= rank) {
+                return std::min(getUpperBound(i), max());
+            }
+        }
+
+        return max();
+    }
+
+    size_t Histogram::getBucket(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+
+        // position of the highest bit, at least 4
+        size_t exponent = 63;
+
+        while (!(value & (uint64_t(1) << exponent))) {
+            exponent--;
+        }
+
+        // the 4 bits below the highest one select the linear sub bucket
+        size_t sub = static_cast<size_t>((value >> (exponent - 4)) & (SUB_BUCKETS - 1));
+
+        return SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+    }
+
+    uint64_t Histogram::getUpperBound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+
+        size_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+        uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS) << shift;
+
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+    Metrics::Action::Action() : errors(0) {}
+
+    Metrics::Metrics() : _rejected(0) {}
+
+    const char *Metrics::getStageName(Stage stage) {
+        switch (stage) {
+            case QUEUE_WAIT:
+                return "queue_wait";
+            case APPLY:
+                return "apply";
+            case RUN:
+                return "run";
+            case BELIEFS:
+                return "beliefs";
+            case SERIALIZE:
+                return "serialize";
+            default:
+                return "unknown";
+        }
+    }
+
+    uint64_t Metrics::elapsed(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    void Metrics::record(Stage stage, uint64_t nanoseconds) {
+        _stages[stage].record(nanoseconds);
+    }
+
+    void Metrics::recordRequest(const std::string &action, uint64_t nanoseconds, bool failed) {
+        Action *counters;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::unique_ptr<Action> &entry = _actions[action];
+
+            if (!entry) {
+                entry.reset(new Action());
+            }
+
+            counters = entry.get();
+        }
+
+        // actions are never removed, so the counters are updated without the lock
+        counters->latency.record(nanoseconds);
+
+        if (failed) {
+            counters->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Metrics::recordRejected() {
+        _rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const Histogram &Metrics::getHistogram(Stage stage) const {
+        return _stages[stage];
+    }
+
+    std::vector<std::string> Metrics::getActions() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> actions;
+
+        for (std::map<std::string, std::unique_ptr<Action> >::const_iterator it = _actions.begin(); it != _actions.end(); ++it) {
+            actions.push_back(it->first);
+        }
+
+        return actions;
+    }
+
+    const Metrics::Action &Metrics::getAction(const std::string &action) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return *_actions.at(action);
+    }
+
+    uint64_t Metrics::nrRejected() const {
+        return _rejected.load(std::memory_order_relaxed);
+    }
+
+    std::string Metrics::toPrometheus(const std::map<std::string, double> &gauges) const {
+        std::ostringstream out;
+        std::vector<std::string> actions = getActions();
+
+        // sums of seconds grow large, the default of 6 digits would round them
+        out.precision(12);
+
+        out << "# HELP bayesserver_requests_total Requests answered, by action.\n";
+        out << "# TYPE bayesserver_requests_total counter\n";
+
+        for (const std::string &action : actions) {
+            out << "bayesserver_requests_total{action=\"" << escape(action) << "\"} " << getAction(action).latency.count() << "\n";
+        }
+
+        out << "# HELP bayesserver_request_errors_total Requests answered by an error, by action.\n";
+        out << "# TYPE bayesserver_request_errors_total counter\n";
+
+        for (const std::string &action : actions) {
+            out << "bayesserver_request_errors_total{action=\"" << escape(action) << "\"} " << getAction(action).errors.load() << "\n";
+        }
+
+        out << "# HELP bayesserver_request_latency_seconds Time from receiving to answering requests, by action.\n";
+        out << "# TYPE bayesserver_request_latency_seconds summary\n";
+
+        for (const std::string &action : actions) {
+            writeSummary(out, "bayesserver_request_latency_seconds", "action=\"" + escape(action) + "\"", getAction(action).latency);
+        }
+
+        out << "# HELP bayesserver_stage_latency_seconds Time spent in each processing stage.\n";
+        out << "# TYPE bayesserver_stage_latency_seconds summary\n";
+
+        for (size_t i = 0; i < NUM_STAGES; ++i) {
+            Stage stage = static_cast<Stage>(i);
+            writeSummary(out, "bayesserver_stage_latency_seconds", std::string("stage=\"") + getStageName(stage) + "\"", _stages[i]);
+        }
+
+        out << "# HELP bayesserver_inference_runs_total Inference runs of all sessions.\n";
+        out << "# TYPE bayesserver_inference_runs_total counter\n";
+        out << "bayesserver_inference_runs_total " << _stages[RUN].count() << "\n";
+
+        out << "# HELP bayesserver_rejected_total Requests rejected because the queue was full.\n";
+        out << "# TYPE bayesserver_rejected_total counter\n";
+        out << "bayesserver_rejected_total " << nrRejected() << "\n";
+
+        for (std::map<std::string, double>::const_iterator it = gauges.begin(); it != gauges.end(); ++it) {
+            out << "# TYPE bayesserver_" << it->first << " gauge\n";
+            out << "bayesserver_" << it->first << " " << it->second << "\n";
+        }
+
+        return out.str();
+    }
+}
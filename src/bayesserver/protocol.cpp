@@ -0,0 +1,257 @@
+#include <bayesserver/protocol.h>
+
+#include <cstring>
+
+#include <bayesnet/exception.h>
+
+namespace bayesServer {
+
+    namespace protocol {
+
+        Writer::Writer(std::string &buffer) : _buffer(buffer) {}
+
+        void Writer::writeHeader(const Header &header) {
+            writeUInt8(header.version);
+            writeUInt8(header.opcode);
+            writeUInt16(header.status);
+            writeUInt32(header.id);
+        }
+
+        void Writer::writeUInt8(uint8_t value) {
+            _buffer.push_back(static_cast<char>(value));
+        }
+
+        void Writer::writeUInt16(uint16_t value) {
+            writeUInt8(static_cast<uint8_t>(value));
+            writeUInt8(static_cast<uint8_t>(value >> 8));
+        }
+
+        void Writer::writeUInt32(uint32_t value) {
+            writeUInt16(static_cast<uint16_t>(value));
+            writeUInt16(static_cast<uint16_t>(value >> 16));
+        }
+
+        void Writer::writeUInt64(uint64_t value) {
+            writeUInt32(static_cast<uint32_t>(value));
+            writeUInt32(static_cast<uint32_t>(value >> 32));
+        }
+
+        void Writer::writeDouble(double value) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            writeUInt64(bits);
+        }
+
+        void Writer::writeString(const std::string &value) {
+            if (value.size() > 0xffff) {
+                BAYESNET_THROWE(INVALID_MESSAGE, "string too long");
+            }
+
+            writeUInt16(static_cast<uint16_t>(value.size()));
+            _buffer.append(value);
+        }
+
+        Reader::Reader(const char *data, size_t size) : _data(reinterpret_cast<const unsigned char *>(data)), _size(size), _position(0) {}
+
+        Header Reader::readHeader() {
+            Header header;
+            header.version = readUInt8();
+            header.opcode = readUInt8();
+            header.status = readUInt16();
+            header.id = readUInt32();
+
+            return header;
+        }
+
+        uint8_t Reader::readUInt8() {
+            require(1);
+            return _data[_position++];
+        }
+
+        uint16_t Reader::readUInt16() {
+            uint16_t low = readUInt8();
+            return static_cast<uint16_t>(low | (readUInt8() << 8));
+        }
+
+        uint32_t Reader::readUInt32() {
+            uint32_t low = readUInt16();
+            return low | (static_cast<uint32_t>(readUInt16()) << 16);
+        }
+
+        uint64_t Reader::readUInt64() {
+            uint64_t low = readUInt32();
+            return low | (static_cast<uint64_t>(readUInt32()) << 32);
+        }
+
+        double Reader::readDouble() {
+            uint64_t bits = readUInt64();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            return value;
+        }
+
+        std::string Reader::readString() {
+            size_t size = readUInt16();
+            require(size);
+
+            std::string value(reinterpret_cast<const char *>(_data + _position), size);
+            _position += size;
+
+            return value;
+        }
+
+        size_t Reader::remaining() const {
+            return _size - _position;
+        }
+
+        void Reader::require(size_t n) const {
+            if (n > _size - _position) {
+                BAYESNET_THROWE(INVALID_MESSAGE, "message truncated");
+            }
+        }
+
+        void writeNodes(Writer &writer, const std::vector<NodeEntry> &nodes) {
+            writer.writeUInt32(static_cast<uint32_t>(nodes.size()));
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                writer.writeString(nodes[i].name);
+                writer.writeUInt8(static_cast<uint8_t>(nodes[i].nrStates));
+                writer.writeUInt8(nodes[i].sensor ? 1 : 0);
+            }
+        }
+
+        std::vector<NodeEntry> readNodes(Reader &reader) {
+            uint32_t n = reader.readUInt32();
+
+            // each node takes at least 4 bytes, so a bogus count can not allocate more than the message size
+            if (n > reader.remaining() / 4) {
+                BAYESNET_THROWE(INVALID_MESSAGE, "message truncated");
+            }
+
+            std::vector<NodeEntry> nodes(n);
+
+            for (uint32_t i = 0; i < n; ++i) {
+                nodes[i].name = reader.readString();
+                nodes[i].nrStates = reader.readUInt8();
+                nodes[i].sensor = reader.readUInt8() != 0;
+            }
+
+            return nodes;
+        }
+
+        std::vector<size_t> readHandles(Reader &reader) {
+            uint32_t n = reader.readUInt32();
+
+            // each handle takes 4 bytes, so a bogus count can not allocate more than the message size
+            if (n > reader.remaining() / 4) {
+                BAYESNET_THROWE(INVALID_MESSAGE, "message truncated");
+            }
+
+            std::vector<size_t> handles(n);
+
+            for (uint32_t i = 0; i < n; ++i) {
+                handles[i] = reader.readUInt32();
+            }
+
+            return handles;
+        }
+
+        std::vector<Operation> readOperations(uint8_t opcode, Reader &reader) {
+            std::vector<Operation> operations;
+            Operation operation;
+            operation.value = 0.0;
+
+            switch (opcode) {
+                case SET_EVIDENCE:
+                    operation.type = Operation::SET_EVIDENCE;
+                    operation.node = reader.readUInt32();
+                    operation.value = reader.readUInt32();
+                    operations.push_back(operation);
+                    break;
+                case CLEAR_EVIDENCE:
+                    operation.type = Operation::CLEAR_EVIDENCE;
+                    operation.node = reader.readUInt32();
+                    operations.push_back(operation);
+                    break;
+                case OBSERVE:
+                    operation.type = Operation::OBSERVE;
+                    operation.node = reader.readUInt32();
+                    operation.value = reader.readDouble();
+                    operations.push_back(operation);
+                    break;
+                case GET_BELIEFS: {
+                    std::vector<size_t> handles = readHandles(reader);
+                    operation.type = Operation::GET_BELIEF;
+
+                    for (size_t i = 0; i < handles.size(); ++i) {
+                        operation.node = handles[i];
+                        operations.push_back(operation);
+                    }
+
+                    break;
+                }
+                case BATCH: {
+                    uint32_t n = reader.readUInt32();
+
+                    // each operation takes 13 bytes
+                    if (n > reader.remaining() / 13) {
+                        BAYESNET_THROWE(INVALID_MESSAGE, "message truncated");
+                    }
+
+                    for (uint32_t i = 0; i < n; ++i) {
+                        uint8_t type = reader.readUInt8();
+
+                        if (type > Operation::GET_BELIEF) {
+                            BAYESNET_THROWE(INVALID_MESSAGE, "unknown batch operation " + std::to_string(type));
+                        }
+
+                        operation.type = static_cast<Operation::Type>(type);
+                        operation.node = reader.readUInt32();
+                        operation.value = reader.readDouble();
+                        operations.push_back(operation);
+                    }
+
+                    break;
+                }
+                default:
+                    BAYESNET_THROWE(INVALID_MESSAGE, "unknown opcode " + std::to_string(opcode));
+            }
+
+            return operations;
+        }
+
+        void writeBeliefs(Writer &writer, const Beliefs &beliefs) {
+            size_t n = 0;
+
+            for (size_t i = 0; i < beliefs.beliefs.size(); ++i) {
+                n += beliefs.beliefs[i].nrStates();
+            }
+
+            writer.writeUInt64(beliefs.version);
+            writer.writeUInt64(beliefs.evidenceVersion);
+            writer.writeUInt32(static_cast<uint32_t>(n));
+
+            for (size_t i = 0; i < beliefs.beliefs.size(); ++i) {
+                for (size_t s = 0; s < beliefs.beliefs[i].nrStates(); ++s) {
+                    writer.writeDouble(beliefs.beliefs[i].get(s));
+                }
+            }
+        }
+
+        void writeUpdate(Writer &writer, const std::vector<size_t> &handles, const Beliefs &beliefs) {
+            writer.writeUInt64(beliefs.version);
+            writer.writeUInt64(beliefs.evidenceVersion);
+            writer.writeUInt32(static_cast<uint32_t>(beliefs.beliefs.size()));
+
+            for (size_t i = 0; i < beliefs.beliefs.size(); ++i) {
+                writer.writeUInt32(static_cast<uint32_t>(handles[i]));
+
+                for (size_t s = 0; s < beliefs.beliefs[i].nrStates(); ++s) {
+                    writer.writeDouble(beliefs.beliefs[i].get(s));
+                }
+            }
+        }
+    }
+}
@@ -2,262 +2,1230 @@
 
 #include <QWebSocket>
 #include <QJsonDocument>
-#include <QJsonObject>
+#include <QJsonArray>
+#include <QMetaObject>
+#include <QTimer>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QHostAddress>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+#include <bayesnet/exception.h>
+#include <bayesnet/file.h>
 
 namespace bayesServer {
 
-    Server::Server(quint16 port, QObject* parent) : _network(nullptr), QObject(parent) {
+    namespace {
+
+        // defaults of subscriptions, pushing beliefs changed by more than 0.001 at most 20 times per second
+        const double DEFAULT_EPSILON = 0.001;
+        const double DEFAULT_MAX_RATE = 20.0;
+
+        // largest frame accepted from local clients, larger ones close the connection
+        const quint32 MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+        // milliseconds a changed network file has to stay unchanged before it is reloaded, so it is not read while written
+        const int RELOAD_DELAY = 500;
+
+        // returns the journal of network @a file, which incremental saves append to instead of changing the file
+        QString getJournal(const QString& file) {
+            return QString::fromStdString(bayesNet::file::Journal(file.toStdString()).getFilename());
+        }
+
+        // actions counted by name, others are counted as unknown so bogus requests can not grow the metrics
+        const char* const ACTIONS[] = {"load_network", "attach_session", "close_session", "set_evidence", "clear_evidence", "observe",
+                                       "get_belief", "batch", "subscribe", "unsubscribe", "set_schedule", "sweep"};
+
+        // names of the binary opcodes by value, prefixed to tell them apart from json actions
+        const char* const OPCODES[] = {"binary_unknown", "binary_load_network", "binary_attach_session", "binary_close_session",
+                                       "binary_set_evidence", "binary_clear_evidence", "binary_observe", "binary_get_beliefs",
+                                       "binary_batch", "binary_cancel", "binary_subscribe", "binary_unsubscribe"};
+
+        // converts a belief to its json representation
+        QJsonObject toJson(bayesNet::state::BayesBelief& belief) {
+            QJsonObject jsonBelief;
+
+            if (belief.nrStates() == 2) {
+                jsonBelief["TRUE"] = belief[bayesNet::state::TRUE];
+                jsonBelief["FALSE"] = belief[bayesNet::state::FALSE];
+            } else {
+                jsonBelief["GOOD"] = belief[bayesNet::state::GOOD];
+                jsonBelief["PROBABLY_GOOD"] = belief[bayesNet::state::PROBABLY_GOOD];
+                jsonBelief["PROBABLY_BAD"] = belief[bayesNet::state::PROBABLY_BAD];
+                jsonBelief["BAD"] = belief[bayesNet::state::BAD];
+            }
+
+            jsonBelief["continious_belief"] = std::to_string(bayesNet::Network::getContinousBelief(belief)).c_str();
+
+            return jsonBelief;
+        }
+
+        // states the evidence version the beliefs reflect and the current one, which is greater if the beliefs are stale
+        void setVersions(QJsonObject& json, const Beliefs& beliefs) {
+            json["version"] = static_cast<double>(beliefs.version);
+            json["evidence_version"] = static_cast<double>(beliefs.evidenceVersion);
+        }
+    }
+
+    Server::Server(quint16 port, QObject* parent) : Server(port, QString(), parent) {}
+
+    Server::Server(quint16 port, const QString& cacheDirectory, QObject* parent) : Server(port, cacheDirectory, 0, 1024, parent) {}
+
+    Server::Server(quint16 port, const QString& cacheDirectory, size_t threads, size_t queueCapacity, QObject* parent) :
+            QObject(parent), _metricsSocket(nullptr), _localSocket(nullptr), _watcher(nullptr), _registry(cacheDirectory.toStdString(), &_metrics), _executor(threads, queueCapacity) {
+        _clock.start();
         _socket = new QWebSocketServer("BayesServer", QWebSocketServer::NonSecureMode, this);
 
         if (_socket->listen(QHostAddress::Any, port)) {
             connect(_socket, &QWebSocketServer::newConnection, this, &Server::onNewConnection);
             connect(_socket, &QWebSocketServer::closed, this, &Server::closed);
-            
+
             emit listening();
         }
     }
 
-    Server::~Server() {
-        if (_network != nullptr) {
-            delete _network;
+    Server::~Server() {}
+
+    void Server::setSchedule(const Schedule& schedule) {
+        _registry.setSchedule(schedule);
+    }
+
+    bool Server::listenMetrics(quint16 port) {
+        _metricsSocket = new QTcpServer(this);
+
+        // only local scrapers are served, the endpoint is not authenticated
+        if (!_metricsSocket->listen(QHostAddress::LocalHost, port)) {
+            return false;
+        }
+
+        connect(_metricsSocket, &QTcpServer::newConnection, this, &Server::onMetricsConnection);
+
+        return true;
+    }
+
+    bool Server::listenLocal(const QString& path) {
+        _localSocket = new QLocalServer(this);
+
+        // remove the socket file left by a previous server
+        QLocalServer::removeServer(path);
+
+        if (!_localSocket->listen(path)) {
+            return false;
+        }
+
+        connect(_localSocket, &QLocalServer::newConnection, this, &Server::onLocalConnection);
+
+        return true;
+    }
+
+    void Server::preload(const QString& config) {
+        std::vector<std::string> files = _registry.preload(config.toStdString());
+
+        if (!_watcher) {
+            _watcher = new QFileSystemWatcher(this);
+            connect(_watcher, &QFileSystemWatcher::fileChanged, this, &Server::onNetworkChanged);
+            connect(_watcher, &QFileSystemWatcher::directoryChanged, this, &Server::onDirectoryChanged);
+        }
+
+        for (size_t i = 0; i < files.size(); ++i) {
+            QString file = QString::fromStdString(files[i]);
+
+            _networkFiles[file] = file;
+            _networkFiles[getJournal(file)] = file;
+            watch(file);
+        }
+    }
+
+    void Server::watch(const QString& file) {
+        QString journal = getJournal(file);
+        QString directory = QFileInfo(file).path();
+
+        // files are dropped from the watcher when they are removed or replaced, so they are added again
+        if (!_watcher->files().contains(file) && QFileInfo::exists(file)) {
+            _watcher->addPath(file);
+        }
+
+        if (!_watcher->files().contains(journal) && QFileInfo::exists(journal)) {
+            _watcher->addPath(journal);
+        }
+
+        if (!_watcher->directories().contains(directory)) {
+            _watcher->addPath(directory);
+        }
+    }
+
+    void Server::onNetworkChanged(const QString& path) {
+        // a changed journal reloads its network file
+        QString file = _networkFiles.value(path);
+
+        // a burst of changes of the file and its journal reloads the file once, after the delay
+        if (file.isEmpty() || _changedFiles.contains(file)) {
+            return;
+        }
+
+        _changedFiles.insert(file);
+
+        QTimer::singleShot(RELOAD_DELAY, this, [this, file]() {
+            _changedFiles.remove(file);
+
+            // editors replace files on save and the first incremental save creates the journal
+            watch(file);
+            reload(file);
+        });
+    }
+
+    void Server::onDirectoryChanged(const QString& path) {
+        // a created journal or a network file created again is not watched yet
+        for (const QString& watched : _networkFiles.keys()) {
+            if (QFileInfo(watched).path() == path && !_watcher->files().contains(watched) && QFileInfo::exists(watched)) {
+                onNetworkChanged(watched);
+            }
+        }
+    }
+
+    void Server::reload(const QString& file) {
+        // compile on a worker, sessions keep answering on the previous version until it is swapped in
+        quint64 ticket = _executor.submit(_watcher, [this, file]() {
+            QString message;
+
+            try {
+                _registry.reload(file.toStdString());
+            } catch(const std::exception& e) {
+                message = e.what();
+            }
+
+            QMetaObject::invokeMethod(this, [this, file, message]() {
+                emit networkReloaded(file, message);
+            }, Qt::QueuedConnection);
+        });
+
+        // retry after the delay if the queue is full
+        if (ticket == 0) {
+            QTimer::singleShot(RELOAD_DELAY, this, [this, file]() {
+                reload(file);
+            });
         }
     }
 
     void Server::onNewConnection() {
         // accept new incoming connection
         QWebSocket* socket = _socket->nextPendingConnection();
-	    connect(socket, &QWebSocket::textMessageReceived, this, &Server::processTextMessage);
+        _connections[socket] = std::make_shared<Connection>(socket, false);
+
+        connect(socket, &QWebSocket::textMessageReceived, this, &Server::processTextMessage);
+        connect(socket, &QWebSocket::binaryMessageReceived, this, &Server::processBinaryMessage);
         connect(socket, &QWebSocket::disconnected, this, &Server::socketDisconnected);
     }
 
+    void Server::onLocalConnection() {
+        QLocalSocket* socket = _localSocket->nextPendingConnection();
+        _connections[socket] = std::make_shared<Connection>(socket, true);
+
+        connect(socket, &QLocalSocket::readyRead, this, &Server::processLocalData);
+        connect(socket, &QLocalSocket::disconnected, this, &Server::socketDisconnected);
+    }
+
     void Server::processTextMessage(const QString& message) {
+        std::shared_ptr<Connection> connection = _connections.value(sender());
+
+        if (connection) {
+            processText(connection, message.toUtf8());
+        }
+    }
+
+    void Server::processBinaryMessage(const QByteArray& message) {
+        std::shared_ptr<Connection> connection = _connections.value(sender());
+
+        if (connection) {
+            processBinary(connection, message);
+        }
+    }
+
+    void Server::processLocalData() {
+        QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+        std::shared_ptr<Connection> connection = _connections.value(socket);
+
+        if (!connection) {
+            return;
+        }
+
+        connection->frames.append(socket->readAll());
+        int offset = 0;
+
+        // each frame is a 32 bit little endian length followed by a binary message or, if not starting with the protocol version, a json message
+        while (connection->frames.size() - offset >= 4) {
+            protocol::Reader reader(connection->frames.constData() + offset, 4);
+            quint32 size = reader.readUInt32();
+
+            if (size > MAX_FRAME_SIZE) {
+                socket->disconnectFromServer();
+                return;
+            }
+
+            if (static_cast<quint32>(connection->frames.size() - offset - 4) < size) {
+                break;
+            }
+
+            QByteArray message = connection->frames.mid(offset + 4, static_cast<int>(size));
+            offset += 4 + static_cast<int>(size);
+
+            if (!message.isEmpty() && static_cast<quint8>(message[0]) == protocol::VERSION) {
+                processBinary(connection, message);
+            } else {
+                processText(connection, message);
+            }
+
+            // the client may have disconnected while processing
+            if (_connections.value(socket) != connection) {
+                return;
+            }
+        }
+
+        connection->frames.remove(0, offset);
+    }
+
+    void Server::processText(const std::shared_ptr<Connection>& connection, const QByteArray& message) {
         // parse message as json
-	    QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(message);
 
         // parse as json object
-	    QJsonObject json = jsonDoc.object();
+        QJsonObject json = jsonDoc.object();
 
         // read action
         QString action = json["action"].toString();
         // read payload
-        QJsonObject payload = json["payload"].toObject(); 
+        QJsonObject payload = json["payload"].toObject();
+        // read optional request id, which is echoed by the response
+        QJsonValue id = json.value("id");
 
-        // handle actions
-        if (action == "load_network") {
-            QString file = payload["file"].toString();
+        // cancellation is handled right away, as it has to overtake the queued requests of the client
+        if (action == "cancel") {
+            QJsonObject result;
+            result["cancelled"] = payload.contains("id") && cancel(*connection, jsonKey(payload.value("id")));
+            send(*connection, false, response(id, action, result));
 
-            // delete old network if exists
-            if (_network != nullptr) {
-                delete _network;
-            }
+            return;
+        }
+
+        // statistics are answered right away as well, so they are available while the workers are saturated
+        if (action == "stats") {
+            send(*connection, false, response(id, action, stats()));
+            return;
+        }
+
+        Request request{0, false, action, id, 0, std::chrono::steady_clock::now()};
+
+        // requests without id can not be cancelled
+        submit(connection, id.isUndefined() ? QString() : jsonKey(id), request, [this, connection, id, action, payload](bool& failed) {
+            QJsonObject result;
 
-            // create network instance from given file
             try {
-                _network = new bayesNet::Network(file.toStdString());
-                _network->init();
-                _network->run();
-                _networkChanged = false;
-
-                QJsonObject json;
-                QJsonObject payload;
-                json["action"] = "response";
-                payload["status"] = "success";
-                payload["response_to"] = action;
-                json["payload"] = payload;
-
-                QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                client->sendTextMessage(QJsonDocument(json).toJson());
+                result = execute(*connection, action, payload);
             } catch(const std::exception& e) {
-                QJsonObject json;
-                QJsonObject payload;
-                json["action"] = "response";
-                payload["status"] = "error";
-                payload["error"] = e.what();
-                json["payload"] = payload;
-                
-                QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                client->sendTextMessage(QJsonDocument(json).toJson());
+                failed = true;
+                return error(id, action, e.what());
             }
 
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            QByteArray message = response(id, action, result);
+            _metrics.record(Metrics::SERIALIZE, Metrics::elapsed(start));
+
+            return message;
+        });
+    }
+
+    void Server::processBinary(const std::shared_ptr<Connection>& connection, const QByteArray& message) {
+        // only the header is parsed on the event loop, the payload is decoded by the worker
+        protocol::Reader reader(message.constData(), static_cast<size_t>(message.size()));
+        if (reader.remaining() < protocol::HEADER_SIZE) {
+            send(*connection, true, error(0, 0, protocol::FAILURE, "message truncated"));
             return;
         }
 
-        if (action == "set_evidence") {
-            QString node = payload["node"].toString();
-            size_t state = payload["state"].toInt();
-            
-            if (_network != nullptr) {
-                // create network instance from given file
-                try {
-                    _network->setEvidence(node.toStdString(), state);
-                    networkChanged();
-
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "success";
-                    payload["response_to"] = action;
-                    json["payload"] = payload;
-
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                } catch(const std::exception& e) {
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "error";
-                    payload["error"] = e.what();
-                    json["payload"] = payload;
-                    
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                }
+        protocol::Header header = reader.readHeader();
+
+        if (header.version != protocol::VERSION) {
+            send(*connection, true, error(header.opcode, header.id, protocol::FAILURE, "unsupported protocol version"));
+            return;
+        }
+
+        // cancellation is handled right away, as it has to overtake the queued requests of the client
+        if (header.opcode == protocol::CANCEL) {
+            if (reader.remaining() < 4) {
+                send(*connection, true, error(header.opcode, header.id, protocol::FAILURE, "message truncated"));
+                return;
             }
 
+            bool cancelled = cancel(*connection, binaryKey(reader.readUInt32()));
+
+            std::string buffer;
+            protocol::Writer writer(buffer);
+            writer.writeHeader(protocol::Header{protocol::VERSION, header.opcode, protocol::SUCCESS, header.id});
+            writer.writeUInt8(cancelled ? 1 : 0);
+            send(*connection, true, QByteArray(buffer.data(), static_cast<int>(buffer.size())));
+
             return;
         }
 
-        if (action == "clear_evidence") {
-            QString node = payload["node"].toString();
-            
-            if (_network != nullptr) {
-                // create network instance from given file
-                try {
-                    _network->clearEvidence(node.toStdString());
-                    networkChanged();
-
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "success";
-                    payload["response_to"] = action;
-                    json["payload"] = payload;
-
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                } catch(const std::exception& e) {
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "error";
-                    payload["error"] = e.what();
-                    json["payload"] = payload;
-                    
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                }
+        Request request{0, true, QString(), QJsonValue(static_cast<double>(header.id)), header.opcode, std::chrono::steady_clock::now()};
+
+        submit(connection, binaryKey(header.id), request, [this, connection, header, message](bool& failed) {
+            try {
+                return execute(*connection, header, message);
+            } catch(const std::exception& e) {
+                failed = true;
+                return error(header.opcode, header.id, protocol::FAILURE, e.what());
             }
+        });
+    }
+
+    void Server::submit(const std::shared_ptr<Connection>& connection, const QString& key, const Request& request, const std::function<QByteArray(bool& failed)>& work) {
+        // the ticket is assigned after submit and only read by the completion on the event loop
+        std::shared_ptr<quint64> ticket = std::make_shared<quint64>(0);
+
+        // execute on a worker, the requests of one client are executed in order
+        *ticket = _executor.submit(connection.get(), [this, connection, ticket, key, request, work]() {
+            _metrics.record(Metrics::QUEUE_WAIT, Metrics::elapsed(request.received));
+
+            bool failed = false;
+            QByteArray message = work(failed);
+
+            // send the reply from the event loop
+            QMetaObject::invokeMethod(this, [this, connection, ticket, key, request, message, failed]() {
+                _metrics.recordRequest(getActionName(request), Metrics::elapsed(request.received), failed);
+
+                // client disconnected meanwhile
+                if (_connections.value(connection->socket) != connection) {
+                    return;
+                }
+
+                if (!key.isEmpty() && connection->requests.value(key).ticket == *ticket) {
+                    connection->requests.remove(key);
+                }
+
+                send(*connection, request.binary, message);
+            }, Qt::QueuedConnection);
+        });
 
+        // reject requests exceeding the queue capacity instead of delaying all clients
+        if (*ticket == 0) {
+            _metrics.recordRejected();
+            send(*connection, request.binary, reject(request, protocol::BUSY, "server busy"));
             return;
         }
 
+        if (!key.isEmpty()) {
+            Request queued = request;
+            queued.ticket = *ticket;
+            connection->requests[key] = queued;
+        }
+    }
+
+    bool Server::cancel(Connection& connection, const QString& key) {
+        if (!connection.requests.contains(key)) {
+            return false;
+        }
+
+        Request request = connection.requests.value(key);
+
+        // requests already started can not be cancelled and are answered as usual
+        if (!_executor.cancel(request.ticket)) {
+            return false;
+        }
+
+        connection.requests.remove(key);
+        send(connection, request.binary, reject(request, protocol::CANCELLED, "request cancelled"));
+
+        return true;
+    }
+
+    void Server::send(Connection& connection, bool binary, const QByteArray& message) {
+        if (connection.local) {
+            std::string prefix;
+            protocol::Writer writer(prefix);
+            writer.writeUInt32(static_cast<uint32_t>(message.size()));
+
+            // both writes are sent together once the event loop is reached again
+            QLocalSocket* socket = static_cast<QLocalSocket*>(connection.socket);
+            socket->write(prefix.data(), static_cast<qint64>(prefix.size()));
+            socket->write(message);
+        } else if (binary) {
+            static_cast<QWebSocket*>(connection.socket)->sendBinaryMessage(message);
+        } else {
+            static_cast<QWebSocket*>(connection.socket)->sendTextMessage(message);
+        }
+    }
+
+    QByteArray Server::reject(const Request& request, protocol::Status status, const QString& message) {
+        if (request.binary) {
+            return error(request.opcode, static_cast<quint32>(request.id.toDouble()), status, message);
+        }
+
+        return error(request.id, request.action, message);
+    }
+
+    QJsonObject Server::execute(Connection& connection, const QString& action, const QJsonObject& payload) {
+        QJsonObject result;
+
+        // handle actions
+        if (action == "load_network") {
+            std::string file = payload["file"].toString().toStdString();
+            std::string name = payload["session"].toString().toStdString();
+
+            // create a new session, the network is only loaded if no other session uses it
+            setSession(connection, _registry.createSession(name, file));
+
+            return result;
+        }
+
+        if (action == "attach_session") {
+            // share evidence with all other clients attached to the session
+            setSession(connection, _registry.getSession(payload["session"].toString().toStdString()));
+
+            return result;
+        }
+
+        if (action == "close_session") {
+            // attached clients are detached on their next request
+            _registry.closeSession(payload["session"].toString().toStdString());
+
+            return result;
+        }
+
+        if (action == "set_evidence") {
+            std::string node = payload["node"].toString().toStdString();
+            size_t state = payload["state"].toInt();
+
+            result["evidence_version"] = static_cast<double>(getSession(connection)->setEvidence(node, state));
+
+            return result;
+        }
+
+        if (action == "clear_evidence") {
+            std::string node = payload["node"].toString().toStdString();
+
+            result["evidence_version"] = static_cast<double>(getSession(connection)->clearEvidence(node));
+
+            return result;
+        }
+
         if (action == "observe") {
-            QString node = payload["node"].toString();
+            std::string node = payload["node"].toString().toStdString();
             double value = payload["value"].toDouble();
-            
-            if (_network != nullptr) {
-                // create network instance from given file
-                try {
-                    _network->observe(node.toStdString(), value);
-                    networkChanged();
-
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "success";
-                    payload["response_to"] = action;
-                    json["payload"] = payload;
-                    
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                } catch(const std::exception& e) {
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "error";
-                    payload["error"] = e.what();
-                    json["payload"] = payload;
-                    
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
+
+            result["evidence_version"] = static_cast<double>(getSession(connection)->observe(node, value));
+
+            return result;
+        }
+
+        if (action == "get_belief") {
+            std::string node = payload["node"].toString().toStdString();
+
+            std::shared_ptr<Session> session = getSession(connection);
+
+            // read belief, inference is applied if evidence of the session has changed and the schedule requires
+            Beliefs beliefs = session->batch(std::vector<Operation>(1, Operation{Operation::GET_BELIEF, session->getNodeId(node), 0.0}));
+            result[node.c_str()] = toJson(beliefs.beliefs[0]);
+            setVersions(result, beliefs);
+
+            return result;
+        }
+
+        if (action == "batch") {
+            QJsonArray jsonOperations = payload["operations"].toArray();
+            std::shared_ptr<Session> session = getSession(connection);
+            std::vector<Operation> operations;
+            std::vector<std::string> nodes;
+
+            for (int i = 0; i < jsonOperations.size(); ++i) {
+                QJsonObject jsonOperation = jsonOperations[i].toObject();
+                QString type = jsonOperation["action"].toString();
+                std::string node = jsonOperation["node"].toString().toStdString();
+                Operation operation;
+                operation.node = session->getNodeId(node);
+                operation.value = 0.0;
+
+                if (type == "set_evidence") {
+                    operation.type = Operation::SET_EVIDENCE;
+                    operation.value = jsonOperation["state"].toDouble();
+                } else if (type == "clear_evidence") {
+                    operation.type = Operation::CLEAR_EVIDENCE;
+                } else if (type == "observe") {
+                    operation.type = Operation::OBSERVE;
+                    operation.value = jsonOperation["value"].toDouble();
+                } else if (type == "get_belief") {
+                    operation.type = Operation::GET_BELIEF;
+                    nodes.push_back(node);
+                } else {
+                    throw std::invalid_argument("unknown batch operation: " + type.toStdString());
                 }
+
+                operations.push_back(operation);
             }
 
-            return;
+            // apply all evidence changes at once and run inference at most once
+            Beliefs beliefs = session->batch(operations);
+            QJsonObject jsonBeliefs;
+
+            for (size_t i = 0; i < beliefs.beliefs.size(); ++i) {
+                jsonBeliefs[nodes[i].c_str()] = toJson(beliefs.beliefs[i]);
+            }
+
+            result["beliefs"] = jsonBeliefs;
+            setVersions(result, beliefs);
+
+            return result;
         }
 
-        if (action == "get_belief") {
+        if (action == "subscribe") {
+            QJsonArray jsonNodes = payload["nodes"].toArray();
+            std::shared_ptr<Session> session = getSession(connection);
+            std::vector<size_t> nodes;
+
+            for (int i = 0; i < jsonNodes.size(); ++i) {
+                nodes.push_back(session->getNodeId(jsonNodes[i].toString().toStdString()));
+            }
+
+            double epsilon = payload.value("epsilon").toDouble(DEFAULT_EPSILON);
+            double maxRate = payload.value("max_rate").toDouble(DEFAULT_MAX_RATE);
+
+            // respond with the current beliefs of all subscribed nodes, later changes are pushed
+            std::shared_ptr<Subscription> subscription = subscribe(connection, nodes, epsilon, maxRate, false);
+            QJsonObject jsonBeliefs;
+
+            for (size_t i = 0; i < subscription->nodes.size(); ++i) {
+                jsonBeliefs[session->getNodeName(subscription->nodes[i]).c_str()] = toJson(subscription->beliefs.beliefs[i]);
+            }
+
+            result["beliefs"] = jsonBeliefs;
+            setVersions(result, subscription->beliefs);
+
+            return result;
+        }
+
+        if (action == "unsubscribe") {
+            QJsonArray jsonNodes = payload["nodes"].toArray();
+            std::vector<size_t> nodes;
+
+            for (int i = 0; i < jsonNodes.size(); ++i) {
+                nodes.push_back(getSession(connection)->getNodeId(jsonNodes[i].toString().toStdString()));
+            }
+
+            // without nodes all subscriptions are removed
+            unsubscribe(connection, nodes);
+
+            return result;
+        }
+
+        if (action == "set_schedule") {
+            std::shared_ptr<Session> session = getSession(connection);
+
+            // applies to all clients of a named session
+            session->setSchedule(Schedule(payload["schedule"].toString().toStdString()));
+            result["schedule"] = session->getSchedule().toString().c_str();
+
+            return result;
+        }
+
+        if (action == "sweep") {
             std::string node = payload["node"].toString().toStdString();
-            
-            if (_network != nullptr) {
-                // create network instance from given file
-                try {
-                    // apply inference if network has changed
-                    if (_networkChanged) {
-                        _network->run();
-                        _networkChanged = false;
-                    }
+            QJsonArray jsonValues = payload["values"].toArray();
+            QJsonArray jsonTargets = payload["targets"].toArray();
+            std::shared_ptr<Session> session = getSession(connection);
+
+            std::vector<double> values;
+            std::vector<std::string> targets;
+
+            for (int i = 0; i < jsonValues.size(); ++i) {
+                values.push_back(jsonValues[i].toDouble());
+            }
 
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "success";
-                    payload["response_to"] = action;
-
-                    // read belief
-                    QJsonObject jsonBelief;
-                    auto belief = _network->getBelief(node);
-                    auto continiousBelief = _network->getContinousBelief(node);
-
-                    if (belief.nrStates() == 2) {
-                        jsonBelief["TRUE"] = belief[bayesNet::state::TRUE];
-                        jsonBelief["FALSE"] = belief[bayesNet::state::FALSE];
-                    } else {
-                        jsonBelief["GOOD"] = belief[bayesNet::state::GOOD];
-                        jsonBelief["PROBABLY_GOOD"] = belief[bayesNet::state::PROBABLY_GOOD];
-                        jsonBelief["PROBABLY_BAD"] = belief[bayesNet::state::PROBABLY_BAD];
-                        jsonBelief["BAD"] = belief[bayesNet::state::BAD];
+            for (int i = 0; i < jsonTargets.size(); ++i) {
+                targets.push_back(jsonTargets[i].toString().toStdString());
+            }
+
+            // evaluate all values in parallel on contexts holding the evidence of the session, concurrent sweeps share the pool one after another
+            bayesNet::inference::BeliefMatrix matrix = session->sweep(node, values, targets, _sweepPool);
+
+            // one list of beliefs per value for each target
+            QJsonObject jsonBeliefs;
+
+            for (size_t t = 0; t < targets.size(); ++t) {
+                size_t end = t + 1 < targets.size() ? matrix.offsets[t + 1] : matrix.columns;
+                QJsonArray rows;
+
+                for (size_t i = 0; i < matrix.rows; ++i) {
+                    QJsonArray row;
+
+                    for (size_t j = matrix.offsets[t]; j < end; ++j) {
+                        row.append(matrix.values[i * matrix.columns + j]);
                     }
-                    
-                    jsonBelief["continious_belief"] = std::to_string(continiousBelief).c_str();
-                    payload[node.c_str()] = jsonBelief;
-                    
-                    json["payload"] = payload;
-
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
-                } catch(const std::exception& e) {
-                    QJsonObject json;
-                    QJsonObject payload;
-                    json["action"] = "response";
-                    payload["status"] = "error";
-                    payload["error"] = e.what();
-                    json["payload"] = payload;
-                    
-                    QWebSocket* client = qobject_cast<QWebSocket*>(sender());
-                    client->sendTextMessage(QJsonDocument(json).toJson());
+
+                    rows.append(row);
                 }
+
+                jsonBeliefs[targets[t].c_str()] = rows;
             }
 
-            return;
+            result["node"] = node.c_str();
+            result["values"] = jsonValues;
+            result["beliefs"] = jsonBeliefs;
+
+            return result;
+        }
+
+        throw std::invalid_argument("unknown action: " + action.toStdString());
+    }
+
+    QByteArray Server::execute(Connection& connection, const protocol::Header& header, const QByteArray& message) {
+        protocol::Reader reader(message.constData() + protocol::HEADER_SIZE, static_cast<size_t>(message.size()) - protocol::HEADER_SIZE);
+        std::string buffer;
+        protocol::Writer writer(buffer);
+        writer.writeHeader(protocol::Header{protocol::VERSION, header.opcode, protocol::SUCCESS, header.id});
+
+        switch (header.opcode) {
+            case protocol::LOAD_NETWORK: {
+                std::string file = reader.readString();
+                std::string name = reader.readString();
+                std::shared_ptr<Session> session = _registry.createSession(name, file);
+                setSession(connection, session);
+
+                // negotiate the node handles, later requests address nodes by their position in the table
+                protocol::writeNodes(writer, session->getNetwork()->getNodeTable());
+                break;
+            }
+            case protocol::ATTACH_SESSION: {
+                std::shared_ptr<Session> session = _registry.getSession(reader.readString());
+                setSession(connection, session);
+
+                protocol::writeNodes(writer, session->getNetwork()->getNodeTable());
+                break;
+            }
+            case protocol::CLOSE_SESSION:
+                _registry.closeSession(reader.readString());
+                break;
+            case protocol::SUBSCRIBE: {
+                double epsilon = reader.readDouble();
+                double maxRate = reader.readDouble();
+                std::vector<size_t> nodes = protocol::readHandles(reader);
+                std::shared_ptr<Subscription> subscription = subscribe(connection, nodes, epsilon, maxRate, true);
+
+                protocol::writeUpdate(writer, subscription->nodes, subscription->beliefs);
+                break;
+            }
+            case protocol::UNSUBSCRIBE:
+                unsubscribe(connection, protocol::readHandles(reader));
+                break;
+            default: {
+                // all evidence and belief requests are executed as batch, so nodes are never looked up by name
+                std::vector<Operation> operations = protocol::readOperations(header.opcode, reader);
+                Beliefs beliefs = getSession(connection)->batch(operations);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                if (header.opcode == protocol::GET_BELIEFS || header.opcode == protocol::BATCH) {
+                    protocol::writeBeliefs(writer, beliefs);
+                } else {
+                    writer.writeUInt64(beliefs.evidenceVersion);
+                }
+
+                _metrics.record(Metrics::SERIALIZE, Metrics::elapsed(start));
+                break;
+            }
         }
 
+        return QByteArray(buffer.data(), static_cast<int>(buffer.size()));
+    }
+
+    void Server::onMetricsConnection() {
+        QTcpSocket* socket = _metricsSocket->nextPendingConnection();
+        std::shared_ptr<QByteArray> buffer = std::make_shared<QByteArray>();
 
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket, buffer]() {
+            buffer->append(socket->readAll());
+
+            // wait for the end of the request header, requests are not expected to have a body
+            if (!buffer->contains("\r\n\r\n")) {
+                if (buffer->size() > 8192) {
+                    socket->disconnectFromHost();
+                }
+
+                return;
+            }
+
+            QByteArray body;
+            QByteArray status;
+
+            if (buffer->startsWith("GET /metrics ") || buffer->startsWith("GET / ")) {
+                status = "200 OK";
+                body = QByteArray::fromStdString(_metrics.toPrometheus(gauges()));
+            } else {
+                status = "404 Not Found";
+                body = "not found\n";
+            }
+
+            QByteArray reply = "HTTP/1.1 " + status + "\r\n";
+            reply += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+            reply += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+            reply += "Connection: close\r\n\r\n";
+            reply += body;
+
+            buffer->clear();
+            socket->write(reply);
+            socket->disconnectFromHost();
+        });
     }
 
     void Server::socketDisconnected() {
-        // receive websocket client disconnecting
-        QWebSocket* client = qobject_cast<QWebSocket*>(sender());
+        // receive websocket or local client disconnecting
+        QObject* client = sender();
 
-        // remove client from list and delete from memory
+        // remove client and delete from memory, its private session is released with the last running request
         if (client != nullptr) {
-            _clients.removeAll(client);
+            std::shared_ptr<Connection> connection = _connections.take(client);
+
+            if (connection) {
+                // drop queued requests of the client
+                for (const Request& request : connection->requests.values()) {
+                    _executor.cancel(request.ticket);
+                }
+
+                // stop pushing beliefs
+                std::lock_guard<std::mutex> lock(connection->mutex);
+
+                if (connection->subscription) {
+                    connection->subscription->session->removeListener(connection->subscription->listener);
+                    connection->subscription.reset();
+                }
+            }
+
             client->deleteLater();
         }
     }
 
-    void Server::networkChanged() {
-        _networkChanged = true;
+    std::shared_ptr<Session> Server::getSession(Connection& connection) {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+
+        // release closed sessions
+        if (connection.session && connection.session->isClosed()) {
+            connection.session.reset();
+        }
+
+        if (!connection.session) {
+            BAYESNET_THROWE(SESSION_NOT_FOUND, "no network loaded or session attached");
+        }
+
+        return connection.session;
+    }
+
+    void Server::setSession(Connection& connection, const std::shared_ptr<Session>& session) {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        connection.session = session;
+
+        // subscriptions refer to the nodes of the previous session
+        if (connection.subscription && connection.subscription->session != session) {
+            connection.subscription->session->removeListener(connection.subscription->listener);
+            connection.subscription.reset();
+        }
+    }
+
+    std::shared_ptr<Server::Subscription> Server::subscribe(Connection& connection, const std::vector<size_t>& nodes, double epsilon, double maxRate, bool binary) {
+        std::shared_ptr<Session> session = getSession(connection);
+
+        if (!(epsilon >= 0.0) || !(maxRate > 0.0)) {
+            throw std::invalid_argument("epsilon must not be negative and the maximum rate must be positive");
+        }
+
+        std::shared_ptr<Subscription> previous;
+
+        {
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            previous = connection.subscription;
+        }
+
+        // extend the subscription of the session, settings are replaced
+        std::shared_ptr<Subscription> subscription = std::make_shared<Subscription>();
+        subscription->session = session;
+        subscription->epsilon = epsilon;
+        subscription->interval = std::max(1, static_cast<int>(std::ceil(1000.0 / maxRate)));
+        subscription->binary = binary;
+
+        if (previous && previous->session == session) {
+            subscription->nodes = previous->nodes;
+            subscription->listener = previous->listener;
+        }
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            // validate node
+            session->getNodeName(nodes[i]);
+
+            if (std::find(subscription->nodes.begin(), subscription->nodes.end(), nodes[i]) == subscription->nodes.end()) {
+                subscription->nodes.push_back(nodes[i]);
+            }
+        }
+
+        if (!previous || previous->session != session) {
+            if (previous) {
+                previous->session->removeListener(previous->listener);
+            }
+
+            std::weak_ptr<Connection> weak = connection.shared_from_this();
+
+            // called by the thread changing evidence of the session, possibly the one of another client
+            subscription->listener = session->addListener([this, weak]() {
+                std::shared_ptr<Connection> connection = weak.lock();
+
+                if (connection && !connection->pending.exchange(true)) {
+                    QMetaObject::invokeMethod(this, [this, connection]() {
+                        schedulePush(connection);
+                    }, Qt::QueuedConnection);
+                }
+            });
+        }
+
+        // the subscription is stored before reading the beliefs, so changes meanwhile are pushed afterwards
+        {
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            connection.subscription = subscription;
+        }
+
+        std::vector<Operation> operations(subscription->nodes.size(), Operation{Operation::GET_BELIEF, 0, 0.0});
+
+        for (size_t i = 0; i < operations.size(); ++i) {
+            operations[i].node = subscription->nodes[i];
+        }
+
+        subscription->beliefs = session->batch(operations);
+
+        return subscription;
+    }
+
+    void Server::unsubscribe(Connection& connection, const std::vector<size_t>& nodes) {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        std::shared_ptr<Subscription> previous = connection.subscription;
+
+        if (!previous) {
+            return;
+        }
+
+        std::shared_ptr<Subscription> subscription = std::make_shared<Subscription>(*previous);
+        subscription->nodes.clear();
+        subscription->beliefs.beliefs.clear();
+
+        for (size_t i = 0; i < previous->nodes.size() && !nodes.empty(); ++i) {
+            if (std::find(nodes.begin(), nodes.end(), previous->nodes[i]) == nodes.end()) {
+                subscription->nodes.push_back(previous->nodes[i]);
+                subscription->beliefs.beliefs.push_back(previous->beliefs.beliefs[i]);
+            }
+        }
+
+        if (subscription->nodes.empty()) {
+            previous->session->removeListener(previous->listener);
+            connection.subscription.reset();
+        } else {
+            connection.subscription = subscription;
+        }
+    }
+
+    void Server::schedulePush(const std::shared_ptr<Connection>& connection) {
+        // client disconnected meanwhile
+        if (_connections.value(connection->socket) != connection) {
+            return;
+        }
+
+        int interval;
+
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+
+            if (!connection->subscription) {
+                connection->pending = false;
+                return;
+            }
+
+            interval = connection->subscription->interval;
+        }
+
+        // push right away if the last push is longer ago than the interval of the maximum rate
+        qint64 delay = connection->lastPush + interval - _clock.elapsed();
+
+        QTimer::singleShot(delay > 0 ? static_cast<int>(delay) : 0, this, [this, connection]() {
+            push(connection);
+        });
+    }
+
+    void Server::push(const std::shared_ptr<Connection>& connection) {
+        if (_connections.value(connection->socket) != connection) {
+            return;
+        }
+
+        // changes from now on schedule the next push
+        connection->pending = false;
+        connection->lastPush = _clock.elapsed();
+
+        // read beliefs in order with the requests of the client
+        quint64 ticket = _executor.submit(connection.get(), [this, connection]() {
+            bool binary = false;
+            QByteArray message;
+
+            try {
+                message = pushBeliefs(*connection, binary);
+            } catch(const std::exception&) {
+                // the session was closed or detached meanwhile
+            }
+
+            if (message.isEmpty()) {
+                return;
+            }
+
+            QMetaObject::invokeMethod(this, [this, connection, binary, message]() {
+                if (_connections.value(connection->socket) != connection) {
+                    return;
+                }
+
+                send(*connection, binary, message);
+            }, Qt::QueuedConnection);
+        });
+
+        // retry after the interval if the queue is full
+        if (ticket == 0 && !connection->pending.exchange(true)) {
+            schedulePush(connection);
+        }
     }
-}
 
+    QByteArray Server::pushBeliefs(Connection& connection, bool& binary) {
+        std::shared_ptr<Subscription> subscription;
+
+        {
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            subscription = connection.subscription;
+        }
+
+        if (!subscription || subscription->session->isClosed()) {
+            return QByteArray();
+        }
+
+        std::vector<Operation> operations(subscription->nodes.size(), Operation{Operation::GET_BELIEF, 0, 0.0});
+
+        for (size_t i = 0; i < operations.size(); ++i) {
+            operations[i].node = subscription->nodes[i];
+        }
+
+        // inference is applied once for all changes since the last push, if the schedule requires
+        Beliefs beliefs = subscription->session->batch(operations);
+        std::vector<size_t> nodes;
+        Beliefs changed;
+        changed.version = beliefs.version;
+        changed.evidenceVersion = beliefs.evidenceVersion;
+
+        // stale beliefs of an interval schedule are refreshed by a later push
+        if (beliefs.version != beliefs.evidenceVersion && subscription->session->getSchedule().mode == Schedule::INTERVAL && !connection.pending.exchange(true)) {
+            std::shared_ptr<Connection> shared = connection.shared_from_this();
+
+            QMetaObject::invokeMethod(this, [this, shared]() {
+                schedulePush(shared);
+            }, Qt::QueuedConnection);
+        }
+
+        for (size_t i = 0; i < beliefs.beliefs.size(); ++i) {
+            double difference = 0.0;
+
+            for (size_t s = 0; s < beliefs.beliefs[i].nrStates(); ++s) {
+                difference = std::max(difference, std::fabs(beliefs.beliefs[i].get(s) - subscription->beliefs.beliefs[i].get(s)));
+            }
+
+            // compare to the last pushed belief, so slow drifts are pushed once they exceed epsilon
+            if (difference > subscription->epsilon) {
+                subscription->beliefs.beliefs[i] = beliefs.beliefs[i];
+                nodes.push_back(subscription->nodes[i]);
+                changed.beliefs.push_back(beliefs.beliefs[i]);
+            }
+        }
+
+        subscription->beliefs.version = beliefs.version;
+        subscription->beliefs.evidenceVersion = beliefs.evidenceVersion;
+
+        if (changed.beliefs.empty()) {
+            return QByteArray();
+        }
+
+        binary = subscription->binary;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if (binary) {
+            std::string buffer;
+            protocol::Writer writer(buffer);
+            writer.writeHeader(protocol::Header{protocol::VERSION, protocol::UPDATE, protocol::SUCCESS, 0});
+            protocol::writeUpdate(writer, nodes, changed);
+            _metrics.record(Metrics::SERIALIZE, Metrics::elapsed(start));
+
+            return QByteArray(buffer.data(), static_cast<int>(buffer.size()));
+        }
+
+        QJsonObject json;
+        QJsonObject payload;
+        QJsonObject jsonBeliefs;
+
+        for (size_t i = 0; i < changed.beliefs.size(); ++i) {
+            jsonBeliefs[subscription->session->getNodeName(nodes[i]).c_str()] = toJson(changed.beliefs[i]);
+        }
+
+        payload["beliefs"] = jsonBeliefs;
+        setVersions(payload, changed);
+        json["action"] = "update";
+        json["payload"] = payload;
+
+        QByteArray message = QJsonDocument(json).toJson();
+        _metrics.record(Metrics::SERIALIZE, Metrics::elapsed(start));
+
+        return message;
+    }
+
+    QJsonObject Server::stats() const {
+        QJsonObject result;
+        QJsonObject jsonActions;
+        QJsonObject jsonStages;
+        QJsonObject jsonGauges;
+
+        // latencies are reported in microseconds
+        for (const std::string& name : _metrics.getActions()) {
+            const Metrics::Action& action = _metrics.getAction(name);
+            const Histogram& latency = action.latency;
+            QJsonObject jsonAction;
+
+            jsonAction["count"] = static_cast<double>(latency.count());
+            jsonAction["errors"] = static_cast<double>(action.errors.load());
+            jsonAction["mean_us"] = latency.count() > 0 ? latency.sum() * 1e-3 / latency.count() : 0.0;
+            jsonAction["p50_us"] = latency.percentile(0.5) * 1e-3;
+            jsonAction["p99_us"] = latency.percentile(0.99) * 1e-3;
+            jsonAction["p999_us"] = latency.percentile(0.999) * 1e-3;
+            jsonAction["max_us"] = latency.max() * 1e-3;
+            jsonActions[name.c_str()] = jsonAction;
+        }
+
+        for (size_t i = 0; i < Metrics::NUM_STAGES; ++i) {
+            Metrics::Stage stage = static_cast<Metrics::Stage>(i);
+            const Histogram& histogram = _metrics.getHistogram(stage);
+            QJsonObject jsonStage;
+
+            jsonStage["count"] = static_cast<double>(histogram.count());
+            jsonStage["mean_us"] = histogram.count() > 0 ? histogram.sum() * 1e-3 / histogram.count() : 0.0;
+            jsonStage["p50_us"] = histogram.percentile(0.5) * 1e-3;
+            jsonStage["p99_us"] = histogram.percentile(0.99) * 1e-3;
+            jsonStage["p999_us"] = histogram.percentile(0.999) * 1e-3;
+            jsonStage["max_us"] = histogram.max() * 1e-3;
+            jsonStages[Metrics::getStageName(stage)] = jsonStage;
+        }
+
+        std::map<std::string, double> values = gauges();
+
+        for (std::map<std::string, double>::const_iterator it = values.begin(); it != values.end(); ++it) {
+            jsonGauges[it->first.c_str()] = it->second;
+        }
+
+        result["actions"] = jsonActions;
+        result["stages"] = jsonStages;
+        result["gauges"] = jsonGauges;
+        result["inference_runs"] = static_cast<double>(_metrics.getHistogram(Metrics::RUN).count());
+        result["rejected"] = static_cast<double>(_metrics.nrRejected());
+
+        return result;
+    }
+
+    std::map<std::string, double> Server::gauges() const {
+        std::map<std::string, double> values;
+        std::set<const Session*> sessions;
+
+        // count the distinct sessions attached by clients, private ones included
+        for (const std::shared_ptr<Connection>& connection : _connections.values()) {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+
+            if (connection->session && !connection->session->isClosed()) {
+                sessions.insert(connection->session.get());
+            }
+        }
+
+        values["clients"] = _connections.size();
+        values["sessions"] = static_cast<double>(sessions.size());
+        values["named_sessions"] = static_cast<double>(_registry.nrSessions());
+        values["networks"] = static_cast<double>(_registry.nrNetworks());
+        values["queue_depth"] = static_cast<double>(_executor.nrQueued());
+        values["workers"] = static_cast<double>(_executor.size());
+
+        return values;
+    }
+
+    std::string Server::getActionName(const Request& request) {
+        if (request.binary) {
+            return request.opcode < sizeof(OPCODES) / sizeof(OPCODES[0]) ? OPCODES[request.opcode] : OPCODES[0];
+        }
+
+        for (const char* action : ACTIONS) {
+            if (request.action == action) {
+                return action;
+            }
+        }
+
+        return "unknown";
+    }
+
+    QString Server::jsonKey(const QJsonValue& id) {
+        QJsonArray array;
+        array.append(id);
+
+        // 1 and 1.0 are the same id, "1" is another one
+        return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+    }
+
+    QString Server::binaryKey(quint32 id) {
+        // json serializations never start with a letter other than t, f and n
+        return "binary:" + QString::number(id);
+    }
+
+    QByteArray Server::response(const QJsonValue& id, const QString& action, QJsonObject payload) {
+        QJsonObject json;
+        json["action"] = "response";
+
+        if (!id.isUndefined()) {
+            json["id"] = id;
+        }
+
+        payload["status"] = "success";
+        payload["response_to"] = action;
+        json["payload"] = payload;
+
+        return QJsonDocument(json).toJson();
+    }
+
+    QByteArray Server::error(const QJsonValue& id, const QString& action, const QString& message) {
+        QJsonObject json;
+        QJsonObject payload;
+        json["action"] = "response";
+
+        if (!id.isUndefined()) {
+            json["id"] = id;
+        }
+
+        payload["status"] = "error";
+        payload["response_to"] = action;
+        payload["error"] = message;
+        json["payload"] = payload;
+
+        return QJsonDocument(json).toJson();
+    }
+
+    QByteArray Server::error(quint8 opcode, quint32 id, protocol::Status status, const QString& message) {
+        std::string buffer;
+        protocol::Writer writer(buffer);
+        writer.writeHeader(protocol::Header{protocol::VERSION, opcode, static_cast<uint16_t>(status), id});
+        // strings are limited to 16 bit lengths
+        writer.writeString(message.toStdString().substr(0, 0xffff));
+
+        return QByteArray(buffer.data(), static_cast<int>(buffer.size()));
+    }
+}
@@ -0,0 +1,862 @@
+#include <bayesserver/session.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <bayesnet/exception.h>
+
+namespace bayesServer {
+
+    CompiledNetwork::CompiledNetwork(const std::string &file, const std::string &cacheDirectory) : _file(file) {
+        if (cacheDirectory.empty()) {
+            _network.reset(new bayesNet::Network(file));
+        } else {
+            _network.reset(new bayesNet::Network(file, cacheDirectory));
+        }
+
+        // initialize and run once, so contexts start with valid beliefs
+        _network->init();
+        _network->run();
+
+        // capture nodes and base factors, the network is never changed afterwards
+        for (size_t i = 0; i < _network->nrNodes(); ++i) {
+            bayesNet::Node &node = _network->getNode(i);
+
+            _nodes.push_back(&node);
+            _sensors.push_back(bayesNet::Network::isSensor(node) ? &bayesNet::Network::getSensor(node) : nullptr);
+            _factors.push_back(node.getFactor());
+            _table.push_back(NodeEntry{node.getName(), node.nrStates(), _sensors.back() != nullptr});
+        }
+    }
+
+    const std::string &CompiledNetwork::getFile() const {
+        return _file;
+    }
+
+    size_t CompiledNetwork::nrNodes() const {
+        return _nodes.size();
+    }
+
+    size_t CompiledNetwork::getNodeId(const std::string &name) const {
+        return _network->getNodeId(name);
+    }
+
+    const bayesNet::Node &CompiledNetwork::getNode(size_t id) const {
+        if (id >= _nodes.size()) {
+            BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+        }
+
+        return *_nodes[id];
+    }
+
+    const bayesNet::Factor &CompiledNetwork::getFactor(size_t id) const {
+        if (id >= _factors.size()) {
+            BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+        }
+
+        return _factors[id];
+    }
+
+    bool CompiledNetwork::isSensor(size_t id) const {
+        return id < _sensors.size() && _sensors[id] != nullptr;
+    }
+
+    const std::vector<NodeEntry> &CompiledNetwork::getNodeTable() const {
+        return _table;
+    }
+
+    void CompiledNetwork::mapObservation(size_t id, double x, std::vector<double> &probabilities) const {
+        if (!isSensor(id)) {
+            BAYESNET_THROWE(NO_SENSOR, getNode(id).getName());
+        }
+
+        _sensors[id]->mapObservation(x, probabilities);
+    }
+
+    std::unique_ptr<bayesNet::inference::Context> CompiledNetwork::createContext() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _network->createContext();
+    }
+
+    std::string CompiledNetwork::compareNodes(const CompiledNetwork &other) const {
+        if (nrNodes() != other.nrNodes()) {
+            return "number of nodes changed from " + std::to_string(nrNodes()) + " to " + std::to_string(other.nrNodes());
+        }
+
+        for (size_t i = 0; i < nrNodes(); ++i) {
+            const NodeEntry &node = _table[i];
+            const NodeEntry &otherNode = other._table[i];
+
+            if (node.name != otherNode.name) {
+                return "node " + std::to_string(i) + " changed from " + node.name + " to " + otherNode.name;
+            }
+
+            if (node.nrStates != otherNode.nrStates || node.sensor != otherNode.sensor) {
+                return "states or sensor of node " + node.name + " changed";
+            }
+        }
+
+        return "";
+    }
+
+    Schedule::Schedule() : mode(ON_DEMAND), interval(0), updates(0) {}
+
+    Schedule::Schedule(const std::string &schedule) : mode(ON_DEMAND), interval(0), updates(0) {
+        if (schedule == "on_demand") {
+            return;
+        }
+
+        size_t separator = schedule.find(':');
+        std::string type = schedule.substr(0, separator);
+        size_t value = 0;
+
+        // read the positive number following the mode
+        if (separator != std::string::npos && separator + 1 < schedule.size() && schedule.find_first_not_of("0123456789", separator + 1) == std::string::npos) {
+            value = std::strtoul(schedule.c_str() + separator + 1, nullptr, 10);
+        }
+
+        if (type == "interval" && value > 0) {
+            mode = INTERVAL;
+            interval = value;
+        } else if (type == "updates" && value > 0) {
+            mode = UPDATES;
+            updates = value;
+        } else {
+            BAYESNET_THROWE(INVALID_SCHEDULE, schedule);
+        }
+    }
+
+    std::string Schedule::toString() const {
+        switch (mode) {
+            case INTERVAL:
+                return "interval:" + std::to_string(interval);
+            case UPDATES:
+                return "updates:" + std::to_string(updates);
+            default:
+                return "on_demand";
+        }
+    }
+
+    Session::Session(const std::string &name, const std::shared_ptr<const CompiledNetwork> &network, const Schedule &schedule, Metrics *metrics) :
+            _name(name), _network(network), _context(network->createContext()), _schedule(schedule), _version(0), _resultVersion(0),
+            _lastRun(std::chrono::steady_clock::now()), _metrics(metrics), _closed(false), _nextListener(0) {}
+
+    const std::string &Session::getName() const {
+        return _name;
+    }
+
+    std::shared_ptr<const CompiledNetwork> Session::getNetwork() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _network;
+    }
+
+    size_t Session::getNodeId(const std::string &name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _network->getNodeId(name);
+    }
+
+    std::string Session::getNodeName(size_t id) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _network->getNode(id).getName();
+    }
+
+    void Session::rebind(const std::shared_ptr<const CompiledNetwork> &network) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::string difference = _network->compareNodes(*network);
+
+            if (!difference.empty()) {
+                BAYESNET_THROWE(INCOMPATIBLE_NETWORK, network->getFile() + ": " + difference);
+            }
+
+            std::map<size_t, Operation> evidence;
+            evidence.swap(_evidence);
+
+            _network = network;
+            _factors.clear();
+
+            // node ids are the same in both networks, so the evidence applies to the same nodes again
+            for (std::map<size_t, Operation>::const_iterator it = evidence.begin(); it != evidence.end(); ++it) {
+                if (it->second.type == Operation::SET_EVIDENCE) {
+                    applyEvidence(it->first, static_cast<size_t>(it->second.value));
+                } else {
+                    applyObservation(it->first, it->second.value);
+                }
+            }
+
+            // start over on a context of the new network, beliefs of the previous one are never returned
+            _context = createContext();
+            _changed.clear();
+            _version++;
+            update();
+        }
+
+        notify();
+    }
+
+    void Session::warmUp() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _context->init();
+        _context->run();
+
+        for (size_t i = 0; i < _network->nrNodes(); ++i) {
+            _context->belief(_network->getNode(i));
+        }
+    }
+
+    void Session::close() {
+        _closed = true;
+    }
+
+    bool Session::isClosed() const {
+        return _closed;
+    }
+
+    uint64_t Session::setEvidence(const std::string &name, size_t state) {
+        uint64_t version;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            applyEvidence(_network->getNodeId(name), state);
+
+            if (_metrics) {
+                _metrics->record(Metrics::APPLY, Metrics::elapsed(start));
+            }
+
+            changed();
+            version = _version;
+        }
+
+        notify();
+
+        return version;
+    }
+
+    uint64_t Session::clearEvidence(const std::string &name) {
+        uint64_t version;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            removeEvidence(_network->getNodeId(name));
+
+            if (_metrics) {
+                _metrics->record(Metrics::APPLY, Metrics::elapsed(start));
+            }
+
+            changed();
+            version = _version;
+        }
+
+        notify();
+
+        return version;
+    }
+
+    uint64_t Session::observe(const std::string &name, double x) {
+        uint64_t version;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            applyObservation(_network->getNodeId(name), x);
+
+            if (_metrics) {
+                _metrics->record(Metrics::APPLY, Metrics::elapsed(start));
+            }
+
+            changed();
+            version = _version;
+        }
+
+        notify();
+
+        return version;
+    }
+
+    Schedule Session::getSchedule() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _schedule;
+    }
+
+    void Session::setSchedule(const Schedule &schedule) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _schedule = schedule;
+    }
+
+    uint64_t Session::getVersion() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _version;
+    }
+
+    void Session::update() {
+        if (_resultVersion == _version) {
+            return;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // replace the factors of changed nodes only, once per node
+        std::sort(_changed.begin(), _changed.end());
+        _changed.erase(std::unique(_changed.begin(), _changed.end()), _changed.end());
+
+        for (size_t i = 0; i < _changed.size(); ++i) {
+            size_t id = _changed[i];
+            std::map<size_t, bayesNet::Factor>::const_iterator search = _factors.find(id);
+
+            _context->setFactor(_network->getNode(id), search != _factors.end() ? search->second : _network->getFactor(id));
+        }
+
+        _changed.clear();
+        _context->init();
+        _context->run();
+
+        _resultVersion = _version;
+        _lastRun = std::chrono::steady_clock::now();
+
+        if (_metrics) {
+            _metrics->record(Metrics::RUN, Metrics::elapsed(start));
+        }
+    }
+
+    void Session::refresh() {
+        switch (_schedule.mode) {
+            case Schedule::INTERVAL:
+                // keep the previous beliefs until the interval passed
+                if (std::chrono::steady_clock::now() - _lastRun < std::chrono::milliseconds(_schedule.interval)) {
+                    return;
+                }
+
+                break;
+            case Schedule::UPDATES:
+                // inference is applied by changes only
+                return;
+            default:
+                break;
+        }
+
+        update();
+    }
+
+    void Session::changed() {
+        if (_schedule.mode == Schedule::UPDATES && _version - _resultVersion >= _schedule.updates) {
+            update();
+        }
+    }
+
+    Beliefs Session::batch(const std::vector<Operation> &operations) {
+        Beliefs beliefs;
+        bool modified = false;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            // validate all operations before changing any evidence, on the network the changes are applied to
+            for (size_t i = 0; i < operations.size(); ++i) {
+                const Operation &operation = operations[i];
+                const bayesNet::Node &node = _network->getNode(operation.node);
+
+                if (operation.type == Operation::SET_EVIDENCE) {
+                    if (operation.value < 0 || operation.value >= node.nrStates() || operation.value != static_cast<double>(static_cast<size_t>(operation.value))) {
+                        BAYESNET_THROWE(UNKNOWN_STATE_VALUE, std::to_string(operation.value));
+                    }
+                } else if (operation.type == Operation::OBSERVE && !_network->isSensor(operation.node)) {
+                    BAYESNET_THROWE(NO_SENSOR, node.getName());
+                }
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < operations.size(); ++i) {
+                switch (operations[i].type) {
+                    case Operation::SET_EVIDENCE:
+                        applyEvidence(operations[i].node, static_cast<size_t>(operations[i].value));
+                        break;
+                    case Operation::CLEAR_EVIDENCE:
+                        removeEvidence(operations[i].node);
+                        break;
+                    case Operation::OBSERVE:
+                        applyObservation(operations[i].node, operations[i].value);
+                        break;
+                    default:
+                        continue;
+                }
+
+                modified = true;
+            }
+
+            if (_metrics && modified) {
+                _metrics->record(Metrics::APPLY, Metrics::elapsed(start));
+            }
+
+            // apply inference once for all changes, if the schedule requires
+            changed();
+            refresh();
+
+            start = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < operations.size(); ++i) {
+                if (operations[i].type == Operation::GET_BELIEF) {
+                    beliefs.beliefs.push_back(_context->belief(_network->getNode(operations[i].node)));
+                }
+            }
+
+            if (_metrics && !beliefs.beliefs.empty()) {
+                _metrics->record(Metrics::BELIEFS, Metrics::elapsed(start));
+            }
+
+            beliefs.version = _resultVersion;
+            beliefs.evidenceVersion = _version;
+        }
+
+        if (modified) {
+            notify();
+        }
+
+        return beliefs;
+    }
+
+    bayesNet::inference::BeliefMatrix Session::sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets, bayesNet::utils::ThreadPool &pool) {
+        std::shared_ptr<const CompiledNetwork> network;
+        std::vector<std::unique_ptr<bayesNet::inference::Context> > contexts;
+
+        // use one context holding the evidence of the session per thread, taken together with the network they belong to
+        size_t nrContexts = std::min(pool.size(), values.size());
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            network = _network;
+
+            for (size_t c = 0; c < nrContexts; ++c) {
+                contexts.push_back(createContext());
+            }
+        }
+
+        size_t id = network->getNodeId(name);
+        bayesNet::inference::BeliefMatrix matrix;
+        std::vector<const bayesNet::Node *> targetNodes;
+
+        // lookup targets and assign their columns
+        matrix.columns = 0;
+
+        for (size_t t = 0; t < targets.size(); ++t) {
+            targetNodes.push_back(&network->getNode(network->getNodeId(targets[t])));
+            matrix.offsets.push_back(matrix.columns);
+            matrix.columns += targetNodes[t]->nrStates();
+        }
+
+        matrix.rows = values.size();
+        matrix.values.resize(matrix.rows * matrix.columns);
+
+        // prepare the factor of each value up front, so the threads only apply inference
+        std::vector<bayesNet::Factor> factors(values.size(), network->getFactor(id));
+
+        if (network->isSensor(id)) {
+            std::vector<double> probabilities;
+
+            for (size_t i = 0; i < values.size(); ++i) {
+                network->mapObservation(id, values[i], probabilities);
+
+                for (size_t j = 0; j < probabilities.size(); ++j) {
+                    factors[i].set(j, dai::Real(probabilities[j]));
+                }
+            }
+        } else {
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (values[i] < 0 || values[i] != static_cast<double>(static_cast<size_t>(values[i]))) {
+                    BAYESNET_THROWE(UNKNOWN_STATE_VALUE, std::to_string(values[i]));
+                }
+
+                factors[i].setEvidence(static_cast<size_t>(values[i]));
+            }
+        }
+
+        const bayesNet::Node &node = network->getNode(id);
+
+        pool.parallelFor(nrContexts, [&](size_t c) {
+            bayesNet::inference::Context &context = *contexts[c];
+
+            for (size_t i = c; i < values.size(); i += nrContexts) {
+                context.setFactor(node, factors[i]);
+                context.init();
+                context.run();
+
+                double *row = matrix.values.data() + i * matrix.columns;
+
+                for (size_t t = 0; t < targetNodes.size(); ++t) {
+                    bayesNet::state::BayesBelief belief = context.belief(*targetNodes[t]);
+
+                    for (size_t s = 0; s < belief.nrStates(); ++s) {
+                        row[matrix.offsets[t] + s] = belief[s];
+                    }
+                }
+            }
+        });
+
+        return matrix;
+    }
+
+    size_t Session::addListener(const std::function<void()> &listener) {
+        std::lock_guard<std::mutex> lock(_listenerMutex);
+        _listeners[_nextListener] = listener;
+
+        return _nextListener++;
+    }
+
+    void Session::removeListener(size_t id) {
+        std::lock_guard<std::mutex> lock(_listenerMutex);
+        _listeners.erase(id);
+    }
+
+    void Session::notify() {
+        std::lock_guard<std::mutex> lock(_listenerMutex);
+
+        for (std::map<size_t, std::function<void()> >::const_iterator it = _listeners.begin(); it != _listeners.end(); ++it) {
+            it->second();
+        }
+    }
+
+    bayesNet::Factor &Session::getFactor(size_t id) {
+        _changed.push_back(id);
+        _version++;
+
+        std::map<size_t, bayesNet::Factor>::iterator search = _factors.find(id);
+
+        if (search == _factors.end()) {
+            search = _factors.insert(std::make_pair(id, _network->getFactor(id))).first;
+        }
+
+        return search->second;
+    }
+
+    void Session::applyEvidence(size_t id, size_t state) {
+        if (state >= _network->getNode(id).nrStates()) {
+            BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+        }
+
+        // evidence replaces previous evidence or observations of the node
+        bayesNet::Factor &factor = getFactor(id);
+        factor = _network->getFactor(id);
+        factor.setEvidence(state);
+        _evidence[id] = Operation{Operation::SET_EVIDENCE, id, static_cast<double>(state)};
+    }
+
+    void Session::applyObservation(size_t id, double x) {
+        std::vector<double> probabilities;
+        _network->mapObservation(id, x, probabilities);
+
+        // observations replace previous evidence or observations of the node
+        bayesNet::Factor &factor = getFactor(id);
+        factor = _network->getFactor(id);
+
+        for (size_t i = 0; i < probabilities.size(); ++i) {
+            factor.set(i, dai::Real(probabilities[i]));
+        }
+
+        _evidence[id] = Operation{Operation::OBSERVE, id, x};
+    }
+
+    void Session::removeEvidence(size_t id) {
+        // fall back to the base factor
+        _evidence.erase(id);
+
+        if (_factors.erase(id) > 0) {
+            _changed.push_back(id);
+            _version++;
+        }
+    }
+
+    std::unique_ptr<bayesNet::inference::Context> Session::createContext() const {
+        std::unique_ptr<bayesNet::inference::Context> context = _network->createContext();
+
+        for (std::map<size_t, bayesNet::Factor>::const_iterator it = _factors.begin(); it != _factors.end(); ++it) {
+            context->setFactor(_network->getNode(it->first), it->second);
+        }
+
+        return context;
+    }
+
+    Registry::Registry(const std::string &cacheDirectory, Metrics *metrics) : _cacheDirectory(cacheDirectory), _metrics(metrics) {}
+
+    std::shared_ptr<const CompiledNetwork> Registry::getNetwork(const std::string &file) {
+        std::promise<std::shared_ptr<const CompiledNetwork> > promise;
+        std::shared_future<std::shared_ptr<const CompiledNetwork> > loading;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> >::iterator cached = _networks.find(file);
+
+            if (cached != _networks.end()) {
+                std::shared_ptr<const CompiledNetwork> network = cached->second.lock();
+
+                if (network) {
+                    return network;
+                }
+
+                // no session uses the network anymore
+                _networks.erase(cached);
+            }
+
+            // wait for a concurrent load of the same file
+            std::unordered_map<std::string, std::shared_future<std::shared_ptr<const CompiledNetwork> > >::const_iterator search = _loading.find(file);
+
+            if (search != _loading.end()) {
+                loading = search->second;
+            } else {
+                _loading[file] = promise.get_future().share();
+            }
+        }
+
+        if (loading.valid()) {
+            return loading.get();
+        }
+
+        // compile the network only if no session uses it
+        try {
+            std::shared_ptr<const CompiledNetwork> network = std::make_shared<const CompiledNetwork>(file, _cacheDirectory);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            // forget networks released by their last session, entries are only added for files which compiled
+            for (std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> >::iterator it = _networks.begin(); it != _networks.end();) {
+                if (it->second.expired()) {
+                    // no session on the network is left to rebind either
+                    _bound.erase(it->first);
+                    it = _networks.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            _networks[file] = network;
+            _loading.erase(file);
+            promise.set_value(network);
+
+            return network;
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _loading.erase(file);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    std::shared_ptr<Session> Registry::createSession(const std::string &name, const std::string &file) {
+        if (!name.empty()) {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            if (_sessions.find(name) != _sessions.end()) {
+                BAYESNET_THROWE(SESSION_ALREADY_EXISTS, name);
+            }
+        }
+
+        std::shared_ptr<Session> session = std::make_shared<Session>(name, getNetwork(file), getSchedule(), _metrics);
+        std::shared_ptr<const CompiledNetwork> current;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            // the name might have been taken while the network was loaded
+            if (!name.empty() && !_sessions.insert(std::make_pair(name, session)).second) {
+                BAYESNET_THROWE(SESSION_ALREADY_EXISTS, name);
+            }
+
+            // drop released sessions, so private sessions of a long running server do not pile up
+            std::vector<std::weak_ptr<Session> > &bound = _bound[file];
+            bound.erase(std::remove_if(bound.begin(), bound.end(), [](const std::weak_ptr<Session> &entry) {
+                return entry.expired();
+            }), bound.end());
+            bound.push_back(session);
+
+            std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> >::const_iterator cached = _networks.find(file);
+
+            if (cached != _networks.end()) {
+                current = cached->second.lock();
+            }
+        }
+
+        // the file might have been reloaded after the network was taken
+        if (current && current != session->getNetwork()) {
+            session->rebind(current);
+        }
+
+        return session;
+    }
+
+    void Registry::reload(const std::string &file) {
+        std::shared_ptr<const CompiledNetwork> network = std::make_shared<const CompiledNetwork>(file, _cacheDirectory);
+        std::vector<std::shared_ptr<Session> > sessions;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> >::const_iterator cached = _networks.find(file);
+            std::shared_ptr<const CompiledNetwork> previous = cached != _networks.end() ? cached->second.lock() : nullptr;
+
+            // clients address nodes by id, a changed node table or a file read while it is written keeps the previous version
+            if (previous) {
+                std::string difference = previous->compareNodes(*network);
+
+                if (!difference.empty()) {
+                    BAYESNET_THROWE(INCOMPATIBLE_NETWORK, file + ": " + difference);
+                }
+            }
+
+            _networks[file] = network;
+
+            // collect the sessions still in use and forget the released ones
+            std::vector<std::weak_ptr<Session> > &bound = _bound[file];
+            std::vector<std::weak_ptr<Session> > alive;
+
+            for (size_t i = 0; i < bound.size(); ++i) {
+                std::shared_ptr<Session> session = bound[i].lock();
+
+                if (session && !session->isClosed()) {
+                    sessions.push_back(session);
+                    alive.push_back(session);
+                }
+            }
+
+            bound.swap(alive);
+        }
+
+        // each session is swapped under its own lock, requests of other sessions are not blocked
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            sessions[i]->rebind(network);
+        }
+    }
+
+    std::vector<std::string> Registry::preload(const std::string &config) {
+        std::ifstream in(config);
+
+        if (!in) {
+            BAYESNET_THROWE(UNABLE_TO_OPEN_FILE, config);
+        }
+
+        std::vector<std::string> names;
+        std::vector<std::string> files;
+        std::vector<std::string> schedules;
+        std::string line;
+        size_t number = 0;
+
+        // read all entries before creating any session
+        while (std::getline(in, line)) {
+            number++;
+
+            std::istringstream fields(line);
+            std::string name;
+            std::string file;
+            std::string schedule;
+            std::string rest;
+
+            if (!(fields >> name) || name[0] == ';') {
+                continue;
+            }
+
+            if (!(fields >> file) || ((fields >> schedule) && (fields >> rest))) {
+                BAYESNET_THROWE(INVALID_PRELOAD_CONFIG, config + ":" + std::to_string(number) + ": expected <session> <network_file> [<schedule>]");
+            }
+
+            // validate the schedule up front
+            if (!schedule.empty()) {
+                static_cast<void>(Schedule(schedule));
+            }
+
+            names.push_back(name);
+            files.push_back(file);
+            schedules.push_back(schedule);
+        }
+
+        // compile the networks and warm up the sessions in parallel, sessions on the same file share its network
+        std::vector<std::future<void> > tasks;
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            tasks.push_back(std::async(std::launch::async, [this, &names, &files, &schedules, i]() {
+                std::shared_ptr<Session> session = createSession(names[i], files[i]);
+
+                if (!schedules[i].empty()) {
+                    session->setSchedule(Schedule(schedules[i]));
+                }
+
+                session->warmUp();
+            }));
+        }
+
+        // wait for all tasks before rethrowing the first error
+        std::exception_ptr error;
+
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            try {
+                tasks[i].get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+
+        return files;
+    }
+
+    std::shared_ptr<Session> Registry::getSession(const std::string &name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::unordered_map<std::string, std::shared_ptr<Session> >::const_iterator search = _sessions.find(name);
+
+        if (search == _sessions.end()) {
+            BAYESNET_THROWE(SESSION_NOT_FOUND, name);
+        }
+
+        return search->second;
+    }
+
+    void Registry::closeSession(const std::string &name) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::unordered_map<std::string, std::shared_ptr<Session> >::iterator search = _sessions.find(name);
+
+        if (search == _sessions.end()) {
+            BAYESNET_THROWE(SESSION_NOT_FOUND, name);
+        }
+
+        // clients attached to the session release it on their next request
+        search->second->close();
+        _sessions.erase(search);
+    }
+
+    size_t Registry::nrSessions() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sessions.size();
+    }
+
+    size_t Registry::nrNetworks() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t count = 0;
+
+        for (std::unordered_map<std::string, std::weak_ptr<const CompiledNetwork> >::const_iterator it = _networks.begin(); it != _networks.end(); ++it) {
+            if (!it->second.expired()) {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    Schedule Registry::getSchedule() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _schedule;
+    }
+
+    void Registry::setSchedule(const Schedule &schedule) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _schedule = schedule;
+    }
+}
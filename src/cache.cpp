@@ -0,0 +1,526 @@
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bayesnet/cache.h>
+#include <bayesnet/util.h>
+
+
+/// Magic bytes at the beginning of each cache entry
+#define CACHE_MAGIC "BNCACHE"
+
+/// Version of the cache entry format, increment on any format change
+#define CACHE_VERSION 1
+
+/// Magic bytes at the beginning of each cpt cache entry
+#define CPT_CACHE_MAGIC "BNCPT"
+
+/// Version of the cpt cache entry format, increment on any format change
+#define CPT_CACHE_VERSION 1
+
+
+namespace bayesNet {
+
+    namespace cache {
+
+        namespace {
+
+            /// Serializes plain values into a byte buffer
+            class Writer {
+            public:
+                template<typename T>
+                void put(const T &value) {
+                    _buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+                }
+
+                void putSize(size_t value) {
+                    put(static_cast<uint64_t>(value));
+                }
+
+                void putString(const std::string &s) {
+                    putSize(s.size());
+                    _buffer.append(s);
+                }
+
+                void putDoubles(const std::vector<double> &v) {
+                    putSize(v.size());
+                    _buffer.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(double));
+                }
+
+                const std::string &buffer() const {
+                    return _buffer;
+                }
+
+            private:
+                std::string _buffer;
+            };
+
+            /// Deserializes plain values from a byte buffer, each read returns false if the buffer is exhausted
+            class Reader {
+            public:
+                explicit Reader(const std::string &buffer) : _pos(buffer.data()), _end(buffer.data() + buffer.size()) {}
+
+                template<typename T>
+                bool get(T &value) {
+                    if (static_cast<size_t>(_end - _pos) < sizeof(T)) {
+                        return false;
+                    }
+
+                    std::memcpy(&value, _pos, sizeof(T));
+                    _pos += sizeof(T);
+                    return true;
+                }
+
+                bool getSize(size_t &value) {
+                    uint64_t v;
+
+                    if (!get(v) || v > static_cast<uint64_t>(_end - _pos)) {
+                        return false;
+                    }
+
+                    value = static_cast<size_t>(v);
+                    return true;
+                }
+
+                bool getString(std::string &s) {
+                    size_t size;
+
+                    if (!getSize(size)) {
+                        return false;
+                    }
+
+                    s.assign(_pos, size);
+                    _pos += size;
+                    return true;
+                }
+
+                bool getDoubles(std::vector<double> &v) {
+                    size_t size;
+
+                    if (!getSize(size) || static_cast<size_t>(_end - _pos) / sizeof(double) < size) {
+                        return false;
+                    }
+
+                    v.resize(size);
+                    std::memcpy(v.data(), _pos, size * sizeof(double));
+                    _pos += size * sizeof(double);
+                    return true;
+                }
+
+                bool atEnd() const {
+                    return _pos == _end;
+                }
+
+            private:
+                const char *_pos;
+                const char *_end;
+            };
+
+            /// Writes @a buffer to a temporary file and renames it to @a filename, so readers never see a partial entry
+            bool writeEntry(const std::string &filename, const std::string &buffer) {
+                // writers of other processes and threads use their own temporary file, rename replaces atomically
+                std::string tmpFilename = filename + ".tmp." + std::to_string(::getpid()) + "." +
+                                          std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+                std::ofstream file(tmpFilename, std::ios::binary | std::ios::trunc);
+
+                if (!file.is_open()) {
+                    return false;
+                }
+
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                file.close();
+
+                if (!file || std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+                    std::remove(tmpFilename.c_str());
+                    return false;
+                }
+
+                return true;
+            }
+
+            /// Returns hash of the algorithm file @a filename, an empty filename hashes to zero
+            bool algorithmKey(const std::string &filename, uint64_t &key) {
+                key = 0;
+
+                if (filename.empty()) {
+                    return true;
+                }
+
+                std::string content;
+
+                if (!utils::readFile(filename, content)) {
+                    return false;
+                }
+
+                key = utils::hash(content);
+                return true;
+            }
+        }
+
+        NetworkCache::NetworkCache(const std::string &directory) : _directory(directory) {
+            // create cache directory, an already existing directory is fine
+            mkdir(_directory.c_str(), 0755);
+        }
+
+        NetworkCache::~NetworkCache() {}
+
+        const std::string &NetworkCache::getDirectory() const {
+            return _directory;
+        }
+
+        bool NetworkCache::key(const std::string &filename, uint64_t &key) {
+            std::string content;
+
+            if (!utils::readFile(filename, content)) {
+                return false;
+            }
+
+            key = utils::hash(content);
+
+            // journal entries change the network as well
+            file::Journal journal(filename);
+
+            if (journal.exists() && utils::readFile(journal.getFilename(), content)) {
+                key = utils::hash(content, key);
+            }
+
+            return true;
+        }
+
+        std::string NetworkCache::getEntryFilename(uint64_t key) const {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.bnc", static_cast<unsigned long long>(key));
+
+            return _directory + "/" + name;
+        }
+
+        bool NetworkCache::load(const std::string &filename, file::InitializationVector &iv, std::vector<std::vector<size_t> > &clusters) const {
+            uint64_t networkKey;
+
+            if (!key(filename, networkKey)) {
+                return false;
+            }
+
+            std::string content;
+
+            if (!utils::readFile(getEntryFilename(networkKey), content)) {
+                return false;
+            }
+
+            Reader reader(content);
+
+            // check header
+            char magic[sizeof(CACHE_MAGIC)];
+            uint32_t version;
+            uint64_t storedKey;
+
+            if (!reader.get(magic) || std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) {
+                return false;
+            }
+
+            if (!reader.get(version) || version != CACHE_VERSION || !reader.get(storedKey) || storedKey != networkKey) {
+                return false;
+            }
+
+            // check algorithm file
+            std::string algorithm;
+            uint64_t storedAlgorithmKey;
+            uint64_t algorithmFileKey;
+
+            if (!reader.getString(algorithm) || !reader.get(storedAlgorithmKey)) {
+                return false;
+            }
+
+            if (!algorithmKey(algorithm, algorithmFileKey) || algorithmFileKey != storedAlgorithmKey) {
+                return false;
+            }
+
+            // read into temporaries, so a corrupt entry does not leave iv half filled
+            size_t count;
+
+            // read nodes
+            if (!reader.getSize(count)) {
+                return false;
+            }
+
+            std::vector<std::string> names(count);
+            std::vector<uint64_t> states(count);
+            std::vector<uint8_t> isSensor(count);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (!reader.getString(names[i]) || !reader.get(states[i]) || !reader.get(isSensor[i])) {
+                    return false;
+                }
+            }
+
+            // read connections
+            std::unordered_map<std::string, std::vector<std::string> > connections;
+
+            if (!reader.getSize(count)) {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                std::string name;
+                size_t children;
+
+                if (!reader.getString(name) || !reader.getSize(children)) {
+                    return false;
+                }
+
+                std::vector<std::string> &nodeConnections = connections[name];
+                nodeConnections.resize(children);
+
+                for (size_t j = 0; j < children; ++j) {
+                    if (!reader.getString(nodeConnections[j])) {
+                        return false;
+                    }
+                }
+            }
+
+            // read cpts
+            std::unordered_map<std::string, std::vector<double> > cpts;
+
+            if (!reader.getSize(count)) {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                std::string name;
+
+                if (!reader.getString(name) || !reader.getDoubles(cpts[name])) {
+                    return false;
+                }
+            }
+
+            // read fuzzy sets
+            std::unordered_map<std::string, std::vector<std::string> > fuzzySets;
+
+            if (!reader.getSize(count)) {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                std::string name;
+                size_t size;
+
+                if (!reader.getString(name) || !reader.getSize(size)) {
+                    return false;
+                }
+
+                std::vector<std::string> &mf = fuzzySets[name];
+                mf.resize(size);
+
+                for (size_t j = 0; j < size; ++j) {
+                    if (!reader.getString(mf[j])) {
+                        return false;
+                    }
+                }
+            }
+
+            // read junction tree clusters
+            std::vector<std::vector<size_t> > entryClusters;
+
+            if (!reader.getSize(count)) {
+                return false;
+            }
+
+            entryClusters.resize(count);
+
+            for (size_t i = 0; i < count; ++i) {
+                size_t size;
+
+                if (!reader.getSize(size)) {
+                    return false;
+                }
+
+                entryClusters[i].resize(size);
+
+                for (size_t j = 0; j < size; ++j) {
+                    uint64_t label;
+
+                    if (!reader.get(label)) {
+                        return false;
+                    }
+
+                    entryClusters[i][j] = static_cast<size_t>(label);
+                }
+            }
+
+            if (!reader.atEnd()) {
+                return false;
+            }
+
+            // entry is valid, move it to iv
+            for (size_t i = 0; i < names.size(); ++i) {
+                iv.addNode(names[i], static_cast<size_t>(states[i]), isSensor[i] != 0);
+            }
+
+            iv.getConnections().swap(connections);
+            iv.getCPTs().swap(cpts);
+            iv.getFuzzySets().swap(fuzzySets);
+            iv.setInferenceAlgorithm(algorithm);
+            clusters.swap(entryClusters);
+
+            return true;
+        }
+
+        bool NetworkCache::store(const std::string &filename, file::InitializationVector &iv, const std::vector<std::vector<size_t> > &clusters) const {
+            uint64_t networkKey;
+            uint64_t algorithmFileKey;
+
+            if (!key(filename, networkKey) || !algorithmKey(iv.getInferenceAlgorithm(), algorithmFileKey)) {
+                return false;
+            }
+
+            Writer writer;
+
+            // write header
+            writer.put(CACHE_MAGIC);
+            writer.put(static_cast<uint32_t>(CACHE_VERSION));
+            writer.put(networkKey);
+
+            // write algorithm file
+            writer.putString(iv.getInferenceAlgorithm());
+            writer.put(algorithmFileKey);
+
+            // write nodes
+            std::vector<file::Node *> &nodes = iv.getNodes();
+            writer.putSize(nodes.size());
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                writer.putString(nodes[i]->getName());
+                writer.put(static_cast<uint64_t>(nodes[i]->nrStates()));
+                writer.put(static_cast<uint8_t>(nodes[i]->isSensor()));
+            }
+
+            // write connections
+            std::unordered_map<std::string, std::vector<std::string> > &connections = iv.getConnections();
+            writer.putSize(connections.size());
+
+            for (std::unordered_map<std::string, std::vector<std::string> >::const_iterator it = connections.begin(); it != connections.end(); it++) {
+                writer.putString(it->first);
+                writer.putSize(it->second.size());
+
+                for (size_t i = 0; i < it->second.size(); ++i) {
+                    writer.putString(it->second[i]);
+                }
+            }
+
+            // write cpts
+            std::unordered_map<std::string, std::vector<double> > &cpts = iv.getCPTs();
+            writer.putSize(cpts.size());
+
+            for (std::unordered_map<std::string, std::vector<double> >::const_iterator it = cpts.begin(); it != cpts.end(); it++) {
+                writer.putString(it->first);
+                writer.putDoubles(it->second);
+            }
+
+            // write fuzzy sets
+            std::unordered_map<std::string, std::vector<std::string> > &fuzzySets = iv.getFuzzySets();
+            writer.putSize(fuzzySets.size());
+
+            for (std::unordered_map<std::string, std::vector<std::string> >::const_iterator it = fuzzySets.begin(); it != fuzzySets.end(); it++) {
+                writer.putString(it->first);
+                writer.putSize(it->second.size());
+
+                for (size_t i = 0; i < it->second.size(); ++i) {
+                    writer.putString(it->second[i]);
+                }
+            }
+
+            // write junction tree clusters
+            writer.putSize(clusters.size());
+
+            for (size_t i = 0; i < clusters.size(); ++i) {
+                writer.putSize(clusters[i].size());
+
+                for (size_t j = 0; j < clusters[i].size(); ++j) {
+                    writer.put(static_cast<uint64_t>(clusters[i][j]));
+                }
+            }
+
+            return writeEntry(getEntryFilename(networkKey), writer.buffer());
+        }
+
+        bool NetworkCache::update(const std::string &filename, const std::vector<std::vector<size_t> > &clusters) const {
+            file::InitializationVector iv;
+            std::vector<std::vector<size_t> > oldClusters;
+
+            if (!load(filename, iv, oldClusters)) {
+                return false;
+            }
+
+            return store(filename, iv, clusters);
+        }
+
+        CPTCache::CPTCache(const std::string &directory) : _directory(directory) {
+            // create cache directory, an already existing directory is fine
+            mkdir(_directory.c_str(), 0755);
+        }
+
+        CPTCache::~CPTCache() {}
+
+        const std::string &CPTCache::getDirectory() const {
+            return _directory;
+        }
+
+        std::string CPTCache::getEntryFilename(uint64_t key) const {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.cpt", static_cast<unsigned long long>(key));
+
+            return _directory + "/" + name;
+        }
+
+        bool CPTCache::load(uint64_t key, size_t size, CPT &cpt) const {
+            std::string content;
+
+            if (!utils::readFile(getEntryFilename(key), content)) {
+                return false;
+            }
+
+            Reader reader(content);
+
+            // check header
+            char magic[sizeof(CPT_CACHE_MAGIC)];
+            uint32_t version;
+            uint64_t storedKey;
+
+            if (!reader.get(magic) || std::memcmp(magic, CPT_CACHE_MAGIC, sizeof(CPT_CACHE_MAGIC)) != 0) {
+                return false;
+            }
+
+            if (!reader.get(version) || version != CPT_CACHE_VERSION || !reader.get(storedKey) || storedKey != key) {
+                return false;
+            }
+
+            // read probabilities
+            std::vector<double> probabilities;
+
+            if (!reader.getDoubles(probabilities) || probabilities.size() != size || !reader.atEnd()) {
+                return false;
+            }
+
+            cpt = CPT(probabilities);
+            return true;
+        }
+
+        bool CPTCache::store(uint64_t key, const CPT &cpt) const {
+            Writer writer;
+
+            // write header
+            writer.put(CPT_CACHE_MAGIC);
+            writer.put(static_cast<uint32_t>(CPT_CACHE_VERSION));
+            writer.put(key);
+
+            // write probabilities
+            writer.putDoubles(cpt.getProbabilities());
+
+            return writeEntry(getEntryFilename(key), writer.buffer());
+        }
+    }
+}
@@ -40,7 +40,7 @@ namespace bayesNet {
         return _probabilities;
     }
 
-    std::vector<double> CPT::getProbabilities() const {
+    const std::vector<double> &CPT::getProbabilities() const {
         return _probabilities;
     }
 
@@ -40,6 +40,17 @@ namespace bayesNet {
         "Unknown inference algorithm type",
         "Node is no sensor",
         "Invalid rule state",
-        "Generator logic file not set"
+        "Generator logic file not set",
+        "Invalid fuzzy rule",
+        "Invalid tabulation",
+        "Invalid pipeline state",
+        "Session not found",
+        "Session already exists",
+        "Invalid message",
+        "Invalid schedule",
+        "Connection failed",
+        "Request failed",
+        "Invalid preload configuration",
+        "Incompatible network"
     };
 }
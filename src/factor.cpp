@@ -25,16 +25,19 @@ namespace bayesNet {
         // backup factor
         backup();
 
-        // calculate factor states which has to be set to probability 1
+        // the own state is the most significant digit of the factor, so each state is a contiguous block of entries
         size_t jointStates = nrStates();
         size_t evidenceEntries = jointStates / _states;
         size_t evidenceBeginIndex = evidenceEntries * state;
         size_t evidenceEndIndex = evidenceBeginIndex + evidenceEntries;
 
-        for (size_t i = 0; i < jointStates; i++) {
-            if (i < evidenceBeginIndex || i >= evidenceEndIndex) {
-                set(i, 0);
-            }
+        // zero the blocks of all other states
+        for (size_t i = 0; i < evidenceBeginIndex; i++) {
+            set(i, 0);
+        }
+
+        for (size_t i = evidenceEndIndex; i < jointStates; i++) {
+            set(i, 0);
         }
 
         // set evidence flag
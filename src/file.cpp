@@ -1,6 +1,9 @@
 #include <fstream>
+#include <sstream>
 #include <regex>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 #include <bayesnet/file.h>
 #include <bayesnet/util.h>
@@ -12,6 +15,93 @@ namespace bayesNet {
 
     namespace file {
 
+        namespace {
+
+            /// Writes the cpt section for @a cpts to @a os using @a indent
+            void writeCPTSection(std::ostream &os, const std::unordered_map<std::string, std::vector<double> > &cpts, const std::string &indent) {
+                // begin cpt section
+                os << indent << "\"cpt\": {" << std::endl;
+
+                // write each cpt
+                size_t itCounter = 0;
+                std::streamsize precision = os.precision(PRECISION);
+
+                for (std::unordered_map<std::string, std::vector<double> >::const_iterator it = cpts.begin(); it != cpts.end(); it++) {
+                    os << indent << indent << "\"" << (*it).first << "\": [";
+
+                    for (size_t i = 0; i < (*it).second.size(); ++i) {
+                        os << (*it).second[i];
+
+                        if (i == (*it).second.size() - 1) {
+                            os << "]";
+                        } else {
+                            os << ", ";
+                        }
+                    }
+
+                    if (++itCounter < cpts.size()) {
+                        os << "," << std::endl;
+                    } else {
+                        os << std::endl;
+                    }
+                }
+
+                // end cpt section
+                os << indent << "}";
+                os.precision(precision);
+            }
+
+            /// Writes the fuzzy sets section for @a fuzzySets to @a os using @a indent
+            void writeFuzzySetsSection(std::ostream &os, const std::unordered_map<std::string, std::vector<std::string> > &fuzzySets, const std::string &indent) {
+                // begin fuzzy sets section
+                os << indent << "\"fuzzySets\": {" << std::endl;
+
+                // write each fuzzy set
+                size_t itCounter = 0;
+
+                for (std::unordered_map<std::string, std::vector<std::string> >::const_iterator it = fuzzySets.begin(); it != fuzzySets.end(); it++) {
+                    os << indent << indent << "\"" << (*it).first << "\": {" << std::endl;
+
+                    for (size_t i = 0; i < (*it).second.size(); ++i) {
+                        os << indent << indent << indent << i << ": {";
+
+                        if ((*it).second[i] != "NULL") {
+                            os << (*it).second[i];
+                        }
+
+                        if (i == (*it).second.size() - 1) {
+                            os << "}" << std::endl;
+                        } else {
+                            os << "}," << std::endl;
+                        }
+                    }
+
+                    if (++itCounter < fuzzySets.size()) {
+                        os << indent << indent << "}," << std::endl;
+                    } else {
+                        os << indent << indent << "}" << std::endl;
+                    }
+                }
+
+                // end fuzzy section
+                os << indent << "}";
+            }
+        }
+
+        bool isWrittenEqual(double a, double b) {
+            if (a == b) {
+                return true;
+            }
+
+            // compare the text written by streams at PRECISION, which also uses %g
+            char textA[32];
+            char textB[32];
+            std::snprintf(textA, sizeof(textA), "%.*g", PRECISION, a);
+            std::snprintf(textB, sizeof(textB), "%.*g", PRECISION, b);
+
+            return std::strcmp(textA, textB) == 0;
+        }
+
         Node::Node(const std::string &name, size_t states, bool isSensor) : _name(name), _states(states), _isSensor(isSensor) {}
 
         Node::~Node() {}
@@ -86,6 +176,33 @@ namespace bayesNet {
         }
 
         InitializationVector *InitializationVector::parse(const std::string &filename) {
+            // open file
+            std::ifstream file(filename);
+
+            // parsing file
+            if (file.is_open()) {
+                // new InitializationVector instance
+                InitializationVector *iv = new InitializationVector();
+                parse(file, *iv);
+
+                // close file descriptor
+                file.close();
+
+                // replay journaled changes on top of the parsed network
+                Journal journal(filename);
+
+                if (journal.exists()) {
+                    journal.replay(*iv);
+                }
+
+                // return initialization vector
+                return iv;
+            } else {
+                BAYESNET_THROWE(UNABLE_TO_OPEN_FILE, filename);
+            }
+        }
+
+        bool InitializationVector::parse(std::istream &stream, InitializationVector &iv) {
             // make sure that string to double conversion through std::stod works correctly
             setlocale(LC_ALL, "C/de_DE.UTF-8/en_US.UTF-8/C/C/C/C");
 
@@ -101,220 +218,207 @@ namespace bayesNet {
             std::regex fuzzySetSensorStateRegEx("^\\s*[0-9]+\\s*:\\s*\\{(\\s*\"([a-zA-Z0-9_]+)\"\\s*:\\s*\\[((\\s*[0-9]+\\.?)\\s*,?)*\\]\\s*)\\},?$");
             std::regex inferenceRegEx("^\\s*\"inference\"\\s*:\\s*\"([a-zA-Z0-9_.\\/]*)\"\\s*$");
 
-            // open file
-            std::ifstream file(filename);
             std::string line;
 
-            // parsing file
-            if (file.is_open()) {
-                // new InitializationVector instance
-                InitializationVector *iv = new InitializationVector();
+            // section flags
+            bool beginFile = false;
+            bool sectionNodes = false;
+            bool sectionSensors = false;
+            bool sectionConnections = false;
+            bool sectionCPT = false;
+            bool sectionFuzzySets = false;
+            bool sectionSensorFuzzySetBegin = false;
+
+            // regex matcher
+            std::smatch match;
+            // last parsed sensor name info
+            std::string lastSensorName;
+
+            // parse stream til end of document
+            while (getline(stream, line)) {
+                // check for begin of file
+                if (!beginFile && std::regex_match(line, beginRegEx)) {
+                    beginFile = true;
+                    continue;
+                }
 
-                // section flags
-                bool beginFile = false;
-                bool sectionNodes = false;
-                bool sectionSensors = false;
-                bool sectionConnections = false;
-                bool sectionCPT = false;
-                bool sectionFuzzySets = false;
-                bool sectionSensorFuzzySetBegin = false;
+                // check for end of section/file
+                if (std::regex_match(line, match, endRegEx)) {
+                    if (sectionSensorFuzzySetBegin) {
+                        sectionSensorFuzzySetBegin = false;
+                        continue;
+                    }
 
-                // regex matcher
-                std::smatch match;
-                // last parsed sensor name info
-                std::string lastSensorName;
+                    // end of section nodes/sensors/connections/cpt/fuzzySets
+                    if (sectionNodes || sectionSensors || sectionConnections || sectionCPT || sectionFuzzySets) {
+                        sectionNodes = false;
+                        sectionSensors = false;
+                        sectionConnections = false;
+                        sectionCPT = false;
+                        sectionFuzzySets = false;
 
-                // parse file til end
-                while (getline(file, line)) {
-                    // check for begin of file
-                    if (!beginFile && std::regex_match(line, beginRegEx)) {
-                        beginFile = true;
                         continue;
                     }
 
-                    // check for end of section/file
-                    if (std::regex_match(line, match, endRegEx)) {
-                        if (sectionSensorFuzzySetBegin) {
-                            sectionSensorFuzzySetBegin = false;
-                            continue;
-                        }
+                    // end of document, stop parsing
+                    return beginFile;
+                }
 
-                        // end of section nodes/sensors/connections/cpt/fuzzySets
-                        if (sectionNodes || sectionSensors || sectionConnections || sectionCPT || sectionFuzzySets) {
-                            sectionNodes = false;
-                            sectionSensors = false;
-                            sectionConnections = false;
-                            sectionCPT = false;
-                            sectionFuzzySets = false;
+                // check for node name and count of states
+                if (sectionNodes && std::regex_match(line, match, nodesRegEx)) {
+                    // add node to iv
+                    size_t states = std::stoul(match.str(2));
+                    iv.addNode(match.str(1), states);
 
-                            continue;
-                        }
+                    continue;
+                }
 
-                        // end of file, stop parsing
-                        break;
-                    }
+                // check for sensor node name and count of states
+                if (sectionSensors && std::regex_match(line, match, nodesRegEx)) {
+                    // add node to iv
+                    size_t states = std::stoul(match.str(2));
+                    iv.addNode(match.str(1), states, true);
 
-                    // check for node name and count of states
-                    if (sectionNodes && std::regex_match(line, match, nodesRegEx)) {
-                        // add node to iv
-                        size_t states = std::stoul(match.str(2));
-                        iv->addNode(match.str(1), states);
+                    continue;
+                }
 
-                        continue;
-                    }
+                // check for connections
+                if (sectionConnections && std::regex_match(line, match, connectionsRegEx)) {
+                    // get connection list
+                    std::string connections = match.str(2);
 
-                    // check for sensor node name and count of states
-                    if (sectionSensors && std::regex_match(line, match, nodesRegEx)) {
-                        // add node to iv
-                        size_t states = std::stoul(match.str(2));
-                        iv->addNode(match.str(1), states, true);
+                    // further string processing
+                    // remove whitespaces and quotation marks
+                    connections.erase(
+                            std::remove_if(connections.begin(), connections.end(), utils::isWhitespaceOrQuotationMark),
+                            connections.end()
+                    );
 
-                        continue;
-                    }
+                    // split connection list and at to iv
+                    iv.setConnections(match.str(1), utils::split(connections, ','));
 
-                    // check for connections
-                    if (sectionConnections && std::regex_match(line, match, connectionsRegEx)) {
-                        // get connection list
-                        std::string connections = match.str(2);
+                    continue;
+                }
+                
+                // check for cpts
+                if (sectionCPT) {
+                    // regex not working for large strings
+                    // so we use a manual parsing approach
+                    bool cptBegin = false;
+                    bool nameBegin = false;
+                    std::vector<double> cpt;
+                    std::string cptName;
+                    std::string cptNumber;
+
+                    for (size_t i = 0; i < line.size(); i++) {
+                        
+                        // check for begin of cpt name
+                        if (!nameBegin && line[i] == '"') {
+                            nameBegin = true;
+                            continue;
+                        } 
+                        
+                        // check for end of cpt name
+                        if (nameBegin && line[i] == '"') {
+                            nameBegin = false;
+                            continue;
+                        } 
+                        
+                        // check for begin of cpt
+                        if (!cptBegin && line[i] == '[') {
+                            cptBegin = true;
+                            continue;
+                        } 
+                        
+                        // check for end of cpt
+                        if (cptBegin && line[i] == ']') {
+                            cptBegin = false;
+
+                            // save last parsed cpt entry
+                            cpt.push_back(std::stod(cptNumber));
+                            // set cpt of iv
+                            iv.setCPT(cptName, cpt);
+                    
+                            continue;
+                        }
 
-                        // further string processing
-                        // remove whitespaces and quotation marks
-                        connections.erase(
-                                std::remove_if(connections.begin(), connections.end(), utils::isWhitespaceOrQuotationMark),
-                                connections.end()
-                        );
+                        // parse cpt name
+                        if (nameBegin) {
+                            cptName += line[i];
+                            continue;
+                        }
 
-                        // split connection list and at to iv
-                        iv->setConnections(match.str(1), utils::split(connections, ','));
+                        // parse cpt entries
+                        if (cptBegin) {
 
-                        continue;
-                    }
-                    
-                    // check for cpts
-                    if (sectionCPT) {
-                        // regex not working for large strings
-                        // so we use a manual parsing approach
-                        bool cptBegin = false;
-                        bool nameBegin = false;
-                        std::vector<double> cpt;
-                        std::string cptName;
-                        std::string cptNumber;
-
-                        for (size_t i = 0; i < line.size(); i++) {
-                            
-                            // check for begin of cpt name
-                            if (!nameBegin && line[i] == '"') {
-                                nameBegin = true;
-                                continue;
-                            } 
-                            
-                            // check for end of cpt name
-                            if (nameBegin && line[i] == '"') {
-                                nameBegin = false;
+                            // ignore whitespaces
+                            if (line[i] == ' ') {
                                 continue;
-                            } 
-                            
-                            // check for begin of cpt
-                            if (!cptBegin && line[i] == '[') {
-                                cptBegin = true;
-                                continue;
-                            } 
-                            
-                            // check for end of cpt
-                            if (cptBegin && line[i] == ']') {
-                                cptBegin = false;
+                            }
 
-                                // save last parsed cpt entry
+                            // next cpt entry
+                            if (line[i] == ',') {
+                                // save cpt entry
                                 cpt.push_back(std::stod(cptNumber));
-                                // set cpt of iv
-                                iv->setCPT(cptName, cpt);
-                        
-                                continue;
-                            }
+                                // reset to cpt number to empty string
+                                cptNumber = "";
 
-                            // parse cpt name
-                            if (nameBegin) {
-                                cptName += line[i];
                                 continue;
                             }
 
-                            // parse cpt entries
-                            if (cptBegin) {
-
-                                // ignore whitespaces
-                                if (line[i] == ' ') {
-                                    continue;
-                                }
-
-                                // next cpt entry
-                                if (line[i] == ',') {
-                                    // save cpt entry
-                                    cpt.push_back(std::stod(cptNumber));
-                                    // reset to cpt number to empty string
-                                    cptNumber = "";
-
-                                    continue;
-                                }
+                            // add current char as part of cpt entry
+                            cptNumber += line[i];
 
-                                // add current char as part of cpt entry
-                                cptNumber += line[i];
-
-                                continue;
-                            }
+                            continue;
                         }
-
-                        continue;
                     }
 
-                    // check for fuzzy set membership function
-                    if (sectionSensorFuzzySetBegin && std::regex_match(line, match, fuzzySetSensorStateRegEx)) {
-                        iv->addFuzzySetMembershipFunction(lastSensorName, match.str(1));
+                    continue;
+                }
 
-                        continue;
-                    }
+                // check for fuzzy set membership function
+                if (sectionSensorFuzzySetBegin && std::regex_match(line, match, fuzzySetSensorStateRegEx)) {
+                    iv.addFuzzySetMembershipFunction(lastSensorName, match.str(1));
 
-                    // check for fuzzy sets 
-                    if (sectionFuzzySets && std::regex_match(line, match, fuzzySetsRegEx)) {
-                        sectionSensorFuzzySetBegin = true;
-                        lastSensorName = match.str(1);
+                    continue;
+                }
 
-                        continue;
-                    }
+                // check for fuzzy sets 
+                if (sectionFuzzySets && std::regex_match(line, match, fuzzySetsRegEx)) {
+                    sectionSensorFuzzySetBegin = true;
+                    lastSensorName = match.str(1);
 
-                    // check for section
-                    if (std::regex_match(line, match, sectionRegEx)) {
-                        std::string section = match.str(1);
-
-                        if (section == "nodes") {
-                            sectionNodes = true;
-                        } else if (section == "sensors") {
-                            sectionSensors = true;
-                        } else if (section == "connections") {
-                            sectionConnections = true;
-                        } else if (section == "cpt") {
-                            sectionCPT = true;
-                        } else if (section == "fuzzySets") {
-                            sectionFuzzySets = true;
-                        }
+                    continue;
+                }
 
-                        continue;
+                // check for section
+                if (std::regex_match(line, match, sectionRegEx)) {
+                    std::string section = match.str(1);
+
+                    if (section == "nodes") {
+                        sectionNodes = true;
+                    } else if (section == "sensors") {
+                        sectionSensors = true;
+                    } else if (section == "connections") {
+                        sectionConnections = true;
+                    } else if (section == "cpt") {
+                        sectionCPT = true;
+                    } else if (section == "fuzzySets") {
+                        sectionFuzzySets = true;
                     }
 
-                    // check for inference option
-                    if (std::regex_match(line, match, inferenceRegEx)) {
-                        iv->setInferenceAlgorithm(match.str(1));
-                        continue;
-                    }
+                    continue;
                 }
 
-                // close file descriptor
-                file.close();
-
-                // return initialization vector
-                return iv;
-            } else {
-                BAYESNET_THROWE(UNABLE_TO_OPEN_FILE, filename);
+                // check for inference option
+                if (std::regex_match(line, match, inferenceRegEx)) {
+                    iv.setInferenceAlgorithm(match.str(1));
+                    continue;
+                }
             }
+
+            // stream ended before document was complete
+            return false;
         }
 
         void InitializationVector::save(const std::string &filename) {
@@ -433,86 +537,106 @@ namespace bayesNet {
             // end connections section
             os << indent << "}," << std::endl;
             // write cpt section
-            // begin cpt section
-            os << indent << "\"cpt\": {" << std::endl;
+            writeCPTSection(os, iv.getCPTs(), indent);
+            os << "," << std::endl;
 
-            // write each connection
-            itCounter = 0;
+            // write fuzzy sets section
+            writeFuzzySetsSection(os, iv.getFuzzySets(), indent);
 
-            std::unordered_map<std::string, std::vector<double> > &cpts = iv.getCPTs();
+            // inference section
+            std::string algorithm = iv.getInferenceAlgorithm();
+            
+            if (!algorithm.empty()) {
+                os << "," << std::endl << indent << "\"inference\": \"" << algorithm << "\"" << std::endl;
+            } else {
+                os << std::endl;
+            }
 
-            for (std::unordered_map<std::string, std::vector<double> >::const_iterator it = cpts.begin(); it != cpts.end(); it++) {
-                os << indent << indent << "\"" << (*it).first << "\": [";
+            // write end file
+            os << "}" << std::endl;
 
-                for (size_t i = 0; i < (*it).second.size(); ++i) {
-                    os << (*it).second[i];
+            return os;
+        }
 
-                    if (i == (*it).second.size() - 1) {
-                        os << "]";
-                    } else {
-                        os << ", ";
-                    }
-                }
+        Journal::Journal(const std::string &networkFilename) : _filename(networkFilename + ".journal") {}
 
-                if (++itCounter < cpts.size()) {
-                    os << "," << std::endl;
-                } else {
-                    os << std::endl;
-                }
+        Journal::~Journal() {}
+
+        const std::string &Journal::getFilename() const {
+            return _filename;
+        }
+
+        bool Journal::exists() const {
+            std::ifstream file(_filename);
+            return file.good();
+        }
+
+        size_t Journal::size() const {
+            std::ifstream file(_filename, std::ios::binary | std::ios::ate);
+
+            if (!file.is_open()) {
+                return 0;
             }
 
-            // end cpt section
-            os << indent << "}," << std::endl;
+            return static_cast<size_t>(file.tellg());
+        }
 
-            // write fuzzy sets section
-            // begin fuzzy sets section
-            os << indent << "\"fuzzySets\": {" << std::endl;
+        void Journal::append(InitializationVector &iv) {
+            // build the entry in memory first, so it is appended by a single write
+            std::stringstream entry;
+            std::string indent(2, ' ');
 
-            // write each fuzzy set
-            std::unordered_map<std::string, std::vector<std::string> > &fuzzySets = iv.getFuzzySets();
+            entry << "{" << std::endl;
+            writeCPTSection(entry, iv.getCPTs(), indent);
+            entry << "," << std::endl;
+            writeFuzzySetsSection(entry, iv.getFuzzySets(), indent);
+            entry << std::endl << "}" << std::endl;
 
-            itCounter = 0;
+            // open journal in append mode
+            std::ofstream file(_filename, std::ios::app);
 
-            for (std::unordered_map<std::string, std::vector<std::string> >::const_iterator it = fuzzySets.begin(); it != fuzzySets.end(); it++) {
-                os << indent << indent << "\"" << (*it).first << "\": {" << std::endl;
+            if (file.is_open()) {
+                file << entry.str();
+                file.close();
+            } else {
+                BAYESNET_THROWE(UNABLE_TO_WRITE_FILE, _filename);
+            }
+        }
 
-                for (size_t i = 0; i < (*it).second.size(); ++i) {
-                    os << indent << indent << indent << i << ": {";
+        void Journal::replay(InitializationVector &iv) const {
+            std::ifstream file(_filename);
 
-                    if ((*it).second[i] != "NULL") {
-                        os << (*it).second[i];
-                    }
+            if (!file.is_open()) {
+                BAYESNET_THROWE(UNABLE_TO_OPEN_FILE, _filename);
+            }
 
-                    if (i == (*it).second.size() - 1) {
-                        os << "}" << std::endl;
-                    } else {
-                        os << "}," << std::endl;
-                    }
+            // apply entries in order, so later entries overwrite earlier ones
+            while (file.good()) {
+                InitializationVector entry;
+
+                // skip incomplete entries, e.g. a torn write at the end of the journal
+                if (!InitializationVector::parse(file, entry)) {
+                    break;
                 }
 
-                if (++itCounter < fuzzySets.size()) {
-                    os << indent << indent << "}," << std::endl;
-                } else {
-                    os << indent << indent << "}" << std::endl;
+                std::unordered_map<std::string, std::vector<double> > &cpts = entry.getCPTs();
+
+                for (std::unordered_map<std::string, std::vector<double> >::const_iterator it = cpts.begin(); it != cpts.end(); it++) {
+                    iv.setCPT(it->first, it->second);
                 }
-            }
 
-            // end fuzzy section
-            os << indent << "}";
+                std::unordered_map<std::string, std::vector<std::string> > &fuzzySets = entry.getFuzzySets();
 
-            // inference section
-            std::string algorithm = iv.getInferenceAlgorithm();
-            
-            if (!algorithm.empty()) {
-                os << "," << std::endl << indent << "\"inference\": \"" << algorithm << "\"" << std::endl;
-            } else {
-                os << std::endl;
+                for (std::unordered_map<std::string, std::vector<std::string> >::const_iterator it = fuzzySets.begin(); it != fuzzySets.end(); it++) {
+                    iv.setFuzzySet(it->first, it->second);
+                }
             }
 
-            // write end file
-            os << "}" << std::endl;
+            file.close();
+        }
 
-            return os;
+        void Journal::clear() {
+            std::remove(_filename.c_str());
         }
 
         FuzzyRule::FuzzyRule() {}
@@ -625,6 +749,261 @@ namespace bayesNet {
         }
 
 
+        const unsigned char FuzzyRuleTable::NO_STATE;
+
+        FuzzyRuleTable::FuzzyRuleTable(const std::string &name) : _name(name) {}
+
+        FuzzyRuleTable::~FuzzyRuleTable() {}
+
+        const std::string &FuzzyRuleTable::getName() const {
+            return _name;
+        }
+
+        const std::vector<std::string> &FuzzyRuleTable::getColumns() const {
+            return _columns;
+        }
+
+        size_t FuzzyRuleTable::addColumn(const std::string &name) {
+            for (size_t i = 0; i < _columns.size(); ++i) {
+                if (_columns[i] == name) {
+                    return i;
+                }
+            }
+
+            // widen matrix by one column, existing rules have no clause for the new column
+            size_t width = _columns.size();
+            std::vector<unsigned char> states(_thenStates.size() * (width + 1), NO_STATE);
+
+            for (size_t i = 0; i < _thenStates.size(); ++i) {
+                std::copy(_states.begin() + i * width, _states.begin() + (i + 1) * width, states.begin() + i * (width + 1));
+            }
+
+            _states.swap(states);
+            _columns.push_back(name);
+
+            return width;
+        }
+
+        size_t FuzzyRuleTable::addRule(unsigned char thenState) {
+            _states.resize(_states.size() + _columns.size(), NO_STATE);
+            _thenStates.push_back(thenState);
+
+            return _thenStates.size() - 1;
+        }
+
+        void FuzzyRuleTable::setState(size_t rule, size_t column, unsigned char state) {
+            _states[rule * _columns.size() + column] = state;
+        }
+
+        unsigned char FuzzyRuleTable::getState(size_t rule, size_t column) const {
+            return _states[rule * _columns.size() + column];
+        }
+
+        unsigned char FuzzyRuleTable::getThenState(size_t rule) const {
+            return _thenStates[rule];
+        }
+
+        size_t FuzzyRuleTable::nrRules() const {
+            return _thenStates.size();
+        }
+
+        namespace {
+
+            /// Represents an if-clause found by the tokenizer, referencing the node name in the file buffer
+            struct Clause {
+                const char *name;
+                size_t length;
+                unsigned char state;
+            };
+
+            /// Skips whitespace within a line
+            inline void skipWhitespace(const char *&pos, const char *end) {
+                while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\v' || *pos == '\f')) {
+                    pos++;
+                }
+            }
+
+            /// Reads a word consisting of [a-zA-Z0-9_] and returns its length
+            inline size_t readWord(const char *&pos, const char *end) {
+                const char *begin = pos;
+
+                while (pos < end && ((*pos >= 'a' && *pos <= 'z') || (*pos >= 'A' && *pos <= 'Z') || (*pos >= '0' && *pos <= '9') || *pos == '_')) {
+                    pos++;
+                }
+
+                return static_cast<size_t>(pos - begin);
+            }
+
+            /// Returns true if @a word of @a length equals the null terminated @a keyword
+            inline bool isKeyword(const char *word, size_t length, const char *keyword) {
+                return std::strlen(keyword) == length && std::memcmp(word, keyword, length) == 0;
+            }
+
+            /// Returns the state value of rule state @a word of @a length or FuzzyRuleTable::NO_STATE if it is no rule state
+            unsigned char ruleState(const char *word, size_t length) {
+                if (isKeyword(word, length, "false") || isKeyword(word, length, "good")) {
+                    return 0;
+                }
+
+                if (isKeyword(word, length, "true") || isKeyword(word, length, "probably_good")) {
+                    return 1;
+                }
+
+                if (isKeyword(word, length, "probably_bad")) {
+                    return 2;
+                }
+
+                if (isKeyword(word, length, "bad")) {
+                    return 3;
+                }
+
+                return FuzzyRuleTable::NO_STATE;
+            }
+
+            /// Tokenizes a rule line of the form "if a=good & b=bad then bad" into @a clauses and @a thenState, returns false if malformed
+            bool tokenizeRule(const char *pos, const char *end, std::vector<Clause> &clauses, unsigned char &thenState) {
+                clauses.clear();
+
+                skipWhitespace(pos, end);
+                const char *word = pos;
+
+                if (!isKeyword(word, readWord(pos, end), "if")) {
+                    return false;
+                }
+
+                while (true) {
+                    skipWhitespace(pos, end);
+
+                    // read node name
+                    const char *name = pos;
+                    size_t nameLength = readWord(pos, end);
+
+                    if (nameLength == 0) {
+                        return false;
+                    }
+
+                    if (pos < end && *pos == '=') {
+                        // read if-clause state
+                        pos++;
+                        const char *state = pos;
+                        Clause clause = {name, nameLength, ruleState(state, readWord(pos, end))};
+
+                        if (clause.state == FuzzyRuleTable::NO_STATE) {
+                            return false;
+                        }
+
+                        clauses.push_back(clause);
+
+                        // clauses are optionally separated by '&'
+                        skipWhitespace(pos, end);
+
+                        if (pos < end && *pos == '&') {
+                            pos++;
+                        }
+
+                        continue;
+                    }
+
+                    // a word without assignment has to be the then-clause
+                    if (clauses.empty() || !isKeyword(name, nameLength, "then")) {
+                        return false;
+                    }
+
+                    skipWhitespace(pos, end);
+                    const char *state = pos;
+                    thenState = ruleState(state, readWord(pos, end));
+                    skipWhitespace(pos, end);
+
+                    return thenState != FuzzyRuleTable::NO_STATE && pos == end;
+                }
+            }
+        }
+
+        std::vector<FuzzyRuleTable> FuzzyRuleTable::parse(const std::string &filename) {
+            std::string content;
+
+            // read whole file at once
+            if (!utils::readFile(filename, content)) {
+                BAYESNET_THROWE(UNABLE_TO_OPEN_FILE, filename);
+            }
+
+            std::vector<FuzzyRuleTable> tables;
+            std::vector<Clause> clauses;
+            bool section = false;
+
+            const char *pos = content.data();
+            const char *end = pos + content.size();
+
+            // parse file line by line
+            while (pos < end) {
+                const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+
+                if (lineEnd == NULL) {
+                    lineEnd = end;
+                }
+
+                const char *line = pos;
+                pos = lineEnd + 1;
+
+                // read first word of line
+                const char *cursor = line;
+                skipWhitespace(cursor, lineEnd);
+                const char *word = cursor;
+                size_t wordLength = readWord(cursor, lineEnd);
+
+                if (!section) {
+                    // section header of the form "name begin"
+                    if (wordLength > 0) {
+                        skipWhitespace(cursor, lineEnd);
+                        const char *keyword = cursor;
+                        size_t keywordLength = readWord(cursor, lineEnd);
+                        skipWhitespace(cursor, lineEnd);
+
+                        if (isKeyword(keyword, keywordLength, "begin") && cursor == lineEnd) {
+                            tables.push_back(FuzzyRuleTable(std::string(word, wordLength)));
+                            section = true;
+                        }
+                    }
+
+                    continue;
+                }
+
+                // section end
+                if (isKeyword(word, wordLength, "end")) {
+                    skipWhitespace(cursor, lineEnd);
+
+                    if (cursor == lineEnd) {
+                        section = false;
+                        continue;
+                    }
+                }
+
+                // rule
+                unsigned char thenState;
+
+                if (!tokenizeRule(line, lineEnd, clauses, thenState)) {
+                    continue;
+                }
+
+                FuzzyRuleTable &table = tables.back();
+                size_t rule = table.addRule(thenState);
+
+                for (size_t i = 0; i < clauses.size(); ++i) {
+                    size_t column = i;
+
+                    // rules usually name the nodes in the same order, so check the expected column first
+                    if (column >= table._columns.size() || table._columns[column].size() != clauses[i].length ||
+                        std::memcmp(table._columns[column].data(), clauses[i].name, clauses[i].length) != 0) {
+                        column = table.addColumn(std::string(clauses[i].name, clauses[i].length));
+                    }
+
+                    table.setState(rule, column, clauses[i].state);
+                }
+            }
+
+            return tables;
+        }
+
         GeneratorLogic::GeneratorLogic(const std::string& file) : _file(file) {}
 
         void GeneratorLogic::setLogicFile(const std::string& file) {
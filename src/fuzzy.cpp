@@ -1,8 +1,10 @@
 #include <math.h>
 #include <limits>
 #include <sstream>
-#include <regex>
 #include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
 
 #include <bayesnet/fuzzy.h>
 #include <bayesnet/util.h>
@@ -52,6 +54,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Linear::getCurve() const {
+                Curve curve = {Curve::LINEAR, {_fxMin, _fxMax, _m}};
+                return curve;
+            }
+
             Triangle::Triangle(double begin, double max, double end) : _begin(begin), _max(max), _end(end),
                                                                        _increasing(_begin, _max),
                                                                        _decreasing(_end, _max) {
@@ -84,6 +91,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Triangle::getCurve() const {
+                Curve curve = {Curve::TRIANGLE, {_begin, _max, _end, 1 / (_max - _begin), 1 / (_max - _end)}};
+                return curve;
+            }
+
             Trapezoid::Trapezoid(double x1, double x2, double x3, double x4) : _increasingBegin(x1), _increasingEnd(x2), 
                                                                                _decreasingBegin(x3), _decreasingEnd(x4),
                                                                                _increasingLinear(x1, x2), _decreasingLinear(x4, x3) {}
@@ -114,6 +126,12 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Trapezoid::getCurve() const {
+                Curve curve = {Curve::TRAPEZOID, {_increasingBegin, _increasingEnd, _decreasingBegin, _decreasingEnd,
+                                                  1 / (_increasingEnd - _increasingBegin), 1 / (_decreasingBegin - _decreasingEnd)}};
+                return curve;
+            }
+
             SShape::SShape(double a, double b) : _a(a), _b(b) {}
 
             double SShape::fx(double x) const {
@@ -150,6 +168,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve SShape::getCurve() const {
+                Curve curve = {Curve::SSHAPE, {_a, _b}};
+                return curve;
+            }
+
             ZShape::ZShape(double a, double b) : _sShape(a, b) {}
 
             double ZShape::fx(double x) const {
@@ -174,6 +197,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve ZShape::getCurve() const {
+                Curve curve = {Curve::ZSHAPE, {_sShape.getMinPos(), _sShape.getMaxPos()}};
+                return curve;
+            }
+
             Bell::Bell(double a, double b, double c) : _a(a), _b(b), _c(c) {}
 
             double Bell::fx(double x) const {
@@ -190,6 +218,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Bell::getCurve() const {
+                Curve curve = {Curve::BELL, {_a, _b, _c}};
+                return curve;
+            }
+
             double Gaussian::fx(double x) const {
                 return std::exp(-std::pow(x - _mean, 2) / (2 * std::pow(_deviation, 2)));
             }
@@ -214,6 +247,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Gaussian::getCurve() const {
+                Curve curve = {Curve::GAUSSIAN, {_mean, _deviation}};
+                return curve;
+            }
+
             Gaussian2::Gaussian2(double meanLeft, double deviationLeft, double meanRight, double deviationRight) : _left(meanLeft, deviationLeft), 
                                                                                                                    _right(meanRight, deviationRight) {}
 
@@ -246,6 +284,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Gaussian2::getCurve() const {
+                Curve curve = {Curve::GAUSSIAN2, {_left.getMean(), _left.getDeviation(), _right.getMean(), _right.getDeviation()}};
+                return curve;
+            }
+
             PiShape::PiShape(double a, double b, double c, double d) : _sShape(a, b), _zShape(c, d) {}
 
             double PiShape::fx(double x) const {
@@ -266,6 +309,11 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve PiShape::getCurve() const {
+                Curve curve = {Curve::PISHAPE, {_sShape.getMinPos(), _sShape.getMaxPos(), _zShape.getMaxPos(), _zShape.getMinPos()}};
+                return curve;
+            }
+
             Sigmoid::Sigmoid(double a, double c) : _a(a), _c(c) {}
 
             double Sigmoid::fx(double x) const {
@@ -295,17 +343,124 @@ namespace bayesNet {
                 return ss.str();
             }
 
+            Curve Sigmoid::getCurve() const {
+                Curve curve = {Curve::SIGMOID, {_a, _c}};
+                return curve;
+            }
+
+            namespace {
+
+                /// Returns true if @a c matches the regex character class \s
+                inline bool isSpace(char c) {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+                }
+
+                /// Returns true if @a c is a decimal digit
+                inline bool isDigit(char c) {
+                    return c >= '0' && c <= '9';
+                }
+
+                /// Matches @a s against the curve string grammar and extracts the curve @a name and its comma separated @a values
+                /** Hand written equivalent of the regular expression
+                 *  ^\s*"([a-zA-Z0-9_]+)"\s*:\s*\[((\s*([0-9]+\.?)\s*,?)*)\]$
+                 *  which is too slow to be matched for each membership function of a large network.
+                 */
+                bool matchCurveString(const std::string &s, std::string &name, std::string &values) {
+                    size_t i = 0;
+                    size_t n = s.size();
+
+                    while (i < n && isSpace(s[i])) {
+                        i++;
+                    }
+
+                    // curve name
+                    if (i == n || s[i] != '"') {
+                        return false;
+                    }
+
+                    size_t nameBegin = ++i;
+
+                    while (i < n && (isDigit(s[i]) || (s[i] >= 'a' && s[i] <= 'z') || (s[i] >= 'A' && s[i] <= 'Z') || s[i] == '_')) {
+                        i++;
+                    }
+
+                    if (i == nameBegin || i == n || s[i] != '"') {
+                        return false;
+                    }
+
+                    name = s.substr(nameBegin, i - nameBegin);
+                    i++;
+
+                    while (i < n && isSpace(s[i])) {
+                        i++;
+                    }
+
+                    if (i == n || s[i] != ':') {
+                        return false;
+                    }
+
+                    i++;
+
+                    while (i < n && isSpace(s[i])) {
+                        i++;
+                    }
+
+                    if (i == n || s[i] != '[') {
+                        return false;
+                    }
+
+                    // values, each consisting of whitespace, digits, an optional dot, whitespace and an optional comma
+                    size_t valuesBegin = ++i;
+
+                    while (true) {
+                        size_t valueBegin = i;
+
+                        while (i < n && isSpace(s[i])) {
+                            i++;
+                        }
+
+                        // leading whitespace belongs to a value only
+                        if (i == n || !isDigit(s[i])) {
+                            i = valueBegin;
+                            break;
+                        }
+
+                        while (i < n && isDigit(s[i])) {
+                            i++;
+                        }
+
+                        if (i < n && s[i] == '.') {
+                            i++;
+                        }
+
+                        while (i < n && isSpace(s[i])) {
+                            i++;
+                        }
+
+                        if (i < n && s[i] == ',') {
+                            i++;
+                        }
+                    }
+
+                    if (i != n - 1 || s[i] != ']') {
+                        return false;
+                    }
+
+                    values = s.substr(valuesBegin, i - valuesBegin);
+                    return true;
+                }
+            }
+
             MembershipFunction *fromString(std::string s) {
                 // make sure that string to double conversion through std::stod works correctly
                 setlocale(LC_ALL, "C/de_DE.UTF-8/en_US.UTF-8/C/C/C/C");
 
-                // regex for curve string processing and matching
-                std::regex curveRegEx("^\\s*\"([a-zA-Z0-9_]+)\"\\s*:\\s*\\[((\\s*([0-9]+\\.?)\\s*,?)*)\\]$");
-                std::smatch match;
+                std::string curveName;
+                std::string curveValues;
 
-                // match string against regex
-                if (std::regex_match(s, match, curveRegEx)) {
-                    std::vector<std::string> valuesStr = utils::split(match.str(2), ',');
+                // match string against curve grammar
+                if (matchCurveString(s, curveName, curveValues)) {
+                    std::vector<std::string> valuesStr = utils::split(curveValues, ',');
                     std::vector<double> values;
 
                     for (size_t i = 0; i < valuesStr.size(); i++) {
@@ -314,8 +469,6 @@ namespace bayesNet {
                     
                     MembershipFunction *mf = nullptr;
 
-                    std::string curveName = match.str(1);
-
                     if (curveName == "linear") {
                         mf = new Linear(values[0], values[1]);
                         goto factoryReturn;
@@ -376,18 +529,435 @@ namespace bayesNet {
             }
         }
 
+        const size_t Curve::MAX_PARAMS;
+
+        namespace curves {
+
+            namespace {
+
+                /// Evaluates a linear curve from @a fxMin to @a fxMax with slope @a m like membershipFunctions::Linear
+                inline double linear(double fxMin, double fxMax, double m, double x) {
+                    if (fxMin < fxMax) {
+                        if (x <= fxMin) {
+                            return 0;
+                        }
+
+                        if (x >= fxMax) {
+                            return 1;
+                        }
+                    } else {
+                        if (x <= fxMax) {
+                            return 1;
+                        }
+
+                        if (x >= fxMin) {
+                            return 0;
+                        }
+                    }
+
+                    return (m * (x - fxMin));
+                }
+
+                /// Evaluates a s-shaped curve from @a a to @a b like membershipFunctions::SShape
+                inline double sShape(double a, double b, double x) {
+                    if (x <= a) {
+                        return 0;
+                    }
+
+                    if (x >= b) {
+                        return 1;
+                    }
+
+                    if (x > a && x <= (a + b) / 2) {
+                        return 2 * std::pow((x - a) / (b - a), 2);
+                    }
+
+                    return 1 - 2 * std::pow((x - b) / (b - a), 2);
+                }
+
+                /// Evaluates a gaussian curve with @a mean and @a deviation like membershipFunctions::Gaussian
+                inline double gaussian(double mean, double deviation, double x) {
+                    return std::exp(-std::pow(x - mean, 2) / (2 * std::pow(deviation, 2)));
+                }
+            }
+
+            double evaluate(const Curve &curve, double x) {
+                const double *p = curve.params;
+
+                switch (curve.type) {
+                    case Curve::LINEAR:
+                        return linear(p[0], p[1], p[2], x);
+
+                    case Curve::TRIANGLE:
+                        if (x <= p[0] || x >= p[2]) {
+                            return 0;
+                        }
+
+                        if (x > p[0] && x < p[1]) {
+                            return linear(p[0], p[1], p[3], x);
+                        }
+
+                        if (x > p[1] && x < p[2]) {
+                            return linear(p[2], p[1], p[4], x);
+                        }
+
+                        return 1;
+
+                    case Curve::TRAPEZOID:
+                        if (x <= p[0] || x >= p[3]) {
+                            return 0;
+                        }
+
+                        if (x >= p[1] && x <= p[2]) {
+                            return 1;
+                        }
+
+                        if (x > p[0] && x < p[1]) {
+                            return linear(p[0], p[1], p[4], x);
+                        }
+
+                        return linear(p[3], p[2], p[5], x);
+
+                    case Curve::SSHAPE:
+                        return sShape(p[0], p[1], x);
+
+                    case Curve::ZSHAPE:
+                        return 1 - sShape(p[0], p[1], x);
+
+                    case Curve::PISHAPE:
+                        if (x <= p[2]) {
+                            return sShape(p[0], p[1], x);
+                        }
+
+                        return 1 - sShape(p[2], p[3], x);
+
+                    case Curve::SIGMOID:
+                        return 1 / (1 + std::exp(-1 * p[0] * (x - p[1])));
+
+                    case Curve::BELL:
+                        return 1 / (1 + std::pow(std::abs((x - p[2]) / p[0]), 2 * p[1]));
+
+                    case Curve::GAUSSIAN:
+                        return gaussian(p[0], p[1], x);
+
+                    case Curve::GAUSSIAN2:
+                        return (x >= p[0] ? 1 : gaussian(p[0], p[1], x)) * (x <= p[2] ? 1 : gaussian(p[2], p[3], x));
+
+                    case Curve::CUSTOM:
+                        break;
+                }
+
+                BAYESNET_THROWE(INVALID_MF_STRING, "custom curves can not be evaluated without their membership function");
+            }
+
+            namespace {
+
+                /// Returns the bits of @a x
+                inline uint64_t bits(double x) {
+                    uint64_t b;
+                    std::memcpy(&b, &x, sizeof(b));
+                    return b;
+                }
+
+                /// Returns the double represented by @a b
+                inline double fromBits(uint64_t b) {
+                    double x;
+                    std::memcpy(&x, &b, sizeof(x));
+                    return x;
+                }
+
+                /// Returns exp(@a x) using range reduction and a polynomial, without branches
+                inline double fastExp(double x) {
+                    const double log2e = 1.4426950408889634;
+                    const double ln2Hi = 6.93147180369123816490e-01;
+                    const double ln2Lo = 1.90821492927058770002e-10;
+                    const double shifter = 6755399441055744.0;
+
+                    // results below the normal range are flushed to zero below
+                    double clamped = std::min(std::max(x, -708.0), 709.0);
+
+                    // split into 2^k * exp(r), k is rounded into the low bits of t
+                    double t = clamped * log2e + shifter;
+                    double k = t - shifter;
+                    double r = clamped - k * ln2Hi - k * ln2Lo;
+
+                    // taylor polynomial of degree 12, |r| <= ln(2) / 2
+                    double p = 1.0 / 479001600;
+                    p = p * r + 1.0 / 39916800;
+                    p = p * r + 1.0 / 3628800;
+                    p = p * r + 1.0 / 362880;
+                    p = p * r + 1.0 / 40320;
+                    p = p * r + 1.0 / 5040;
+                    p = p * r + 1.0 / 720;
+                    p = p * r + 1.0 / 120;
+                    p = p * r + 1.0 / 24;
+                    p = p * r + 1.0 / 6;
+                    p = p * r + 0.5;
+                    p = p * r + 1;
+                    p = p * r + 1;
+
+                    // build 2^k from the low bits of t
+                    double scale = fromBits((bits(t) + 1023) << 52);
+                    double result = p * scale;
+
+                    return x < -708.0 ? 0 : result;
+                }
+
+                /// Returns log(@a x) for positive normal @a x using a polynomial, without branches
+                inline double fastLog(double x) {
+                    const double ln2 = 0.6931471805599453;
+                    const double sqrt2 = 1.4142135623730951;
+
+                    // split into 2^e * m with m in [1, 2)
+                    uint64_t b = bits(x);
+                    double e = fromBits(0x4330000000000000ULL | (b >> 52)) - 4503599627371519.0;
+                    double m = fromBits((b & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+
+                    // move m to [sqrt(2) / 2, sqrt(2))
+                    bool high = m > sqrt2;
+                    m = high ? m * 0.5 : m;
+                    e = high ? e + 1 : e;
+
+                    // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| <= 0.172
+                    double f = m - 1;
+                    double s = f / (2 + f);
+                    double s2 = s * s;
+                    double p = 1.0 / 21;
+                    p = p * s2 + 1.0 / 19;
+                    p = p * s2 + 1.0 / 17;
+                    p = p * s2 + 1.0 / 15;
+                    p = p * s2 + 1.0 / 13;
+                    p = p * s2 + 1.0 / 11;
+                    p = p * s2 + 1.0 / 9;
+                    p = p * s2 + 1.0 / 7;
+                    p = p * s2 + 1.0 / 5;
+                    p = p * s2 + 1.0 / 3;
+                    p = p * s2 + 1;
+
+                    return e * ln2 + 2 * s * p;
+                }
+
+                /// Returns the s-shaped curve from @a a to @a b at @a x, without branches
+                inline double sShapeSelect(double a, double b, double x) {
+                    double rising = (x - a) / (b - a);
+                    double falling = (x - b) / (b - a);
+                    double lower = 2 * (rising * rising);
+                    double upper = 1 - 2 * (falling * falling);
+
+                    double v = ((x > a) & (x <= (a + b) / 2)) ? lower : upper;
+                    v = x >= b ? 1 : v;
+                    v = x <= a ? 0 : v;
+
+                    return v;
+                }
+
+                /// Returns the increasing linear curve from @a fxMin to @a fxMax with slope @a m at @a x, without branches
+                inline double increasingSelect(double fxMin, double fxMax, double m, double x) {
+                    double v = m * (x - fxMin);
+                    v = x >= fxMax ? 1 : v;
+                    v = x <= fxMin ? 0 : v;
+
+                    return v;
+                }
+
+                /// Returns the decreasing linear curve from @a fxMin to @a fxMax with slope @a m at @a x, without branches
+                inline double decreasingSelect(double fxMin, double fxMax, double m, double x) {
+                    double v = m * (x - fxMin);
+                    v = x >= fxMin ? 0 : v;
+                    v = x <= fxMax ? 1 : v;
+
+                    return v;
+                }
+
+                /// Returns the linear curve from @a fxMin to @a fxMax with slope @a m at @a x, without branches
+                inline double linearSelect(double fxMin, double fxMax, double m, double x) {
+                    return fxMin < fxMax ? increasingSelect(fxMin, fxMax, m, x) : decreasingSelect(fxMin, fxMax, m, x);
+                }
+
+                /// Returns the gaussian curve with @a mean and @a deviation at @a x, without branches
+                inline double gaussianSelect(double mean, double deviation, double x) {
+                    double d = x - mean;
+                    return fastExp(-(d * d) / (2 * (deviation * deviation)));
+                }
+
+                /// Applies @a kernel to the @a n values @a xs and writes the results to @a out
+                template<typename Kernel>
+                inline void apply(const double *xs, size_t n, double *out, Kernel kernel) {
+                    for (size_t i = 0; i < n; ++i) {
+                        out[i] = kernel(xs[i]);
+                    }
+                }
+            }
+
+            void evaluate(const Curve &curve, const double *xs, size_t n, double *out) {
+                // copy parameters, so they can not alias the output
+                double p0 = curve.params[0];
+                double p1 = curve.params[1];
+                double p2 = curve.params[2];
+                double p3 = curve.params[3];
+                double p4 = curve.params[4];
+                double p5 = curve.params[5];
+
+                // each case is a separate branch free loop, so the compiler can vectorize it
+                switch (curve.type) {
+                    case Curve::LINEAR:
+                        if (p0 < p1) {
+                            apply(xs, n, out, [=](double x) { return increasingSelect(p0, p1, p2, x); });
+                        } else {
+                            apply(xs, n, out, [=](double x) { return decreasingSelect(p0, p1, p2, x); });
+                        }
+
+                        return;
+
+                    case Curve::TRIANGLE:
+                        apply(xs, n, out, [=](double x) {
+                            double increasing = linearSelect(p0, p1, p3, x);
+                            double decreasing = linearSelect(p2, p1, p4, x);
+
+                            double v = ((x > p1) & (x < p2)) ? decreasing : 1;
+                            v = ((x > p0) & (x < p1)) ? increasing : v;
+                            v = ((x <= p0) | (x >= p2)) ? 0 : v;
+
+                            return v;
+                        });
+
+                        return;
+
+                    case Curve::TRAPEZOID:
+                        apply(xs, n, out, [=](double x) {
+                            double increasing = linearSelect(p0, p1, p4, x);
+                            double decreasing = linearSelect(p3, p2, p5, x);
+
+                            double v = ((x > p0) & (x < p1)) ? increasing : decreasing;
+                            v = ((x >= p1) & (x <= p2)) ? 1 : v;
+                            v = ((x <= p0) | (x >= p3)) ? 0 : v;
+
+                            return v;
+                        });
+
+                        return;
+
+                    case Curve::SSHAPE:
+                        apply(xs, n, out, [=](double x) { return sShapeSelect(p0, p1, x); });
+                        return;
+
+                    case Curve::ZSHAPE:
+                        apply(xs, n, out, [=](double x) { return 1 - sShapeSelect(p0, p1, x); });
+                        return;
+
+                    case Curve::PISHAPE:
+                        apply(xs, n, out, [=](double x) {
+                            double rising = sShapeSelect(p0, p1, x);
+                            double falling = 1 - sShapeSelect(p2, p3, x);
+
+                            return x <= p2 ? rising : falling;
+                        });
+
+                        return;
+
+                    case Curve::SIGMOID:
+                        apply(xs, n, out, [=](double x) { return 1 / (1 + fastExp(-1 * p0 * (x - p1))); });
+                        return;
+
+                    case Curve::BELL: {
+                        // |(x - c) / a|^(2b) as exp(2b log |(x - c) / a|), zero base handled separately
+                        double exponent = 2 * p1;
+                        double zeroPower = exponent > 0 ? 0 : (exponent < 0 ? std::numeric_limits<double>::infinity() : 1);
+
+                        apply(xs, n, out, [=](double x) {
+                            double base = std::abs((x - p2) / p0);
+                            double power = fastExp(exponent * fastLog(base));
+
+                            return 1 / (1 + (base == 0 ? zeroPower : power));
+                        });
+
+                        return;
+                    }
+
+                    case Curve::GAUSSIAN:
+                        apply(xs, n, out, [=](double x) { return gaussianSelect(p0, p1, x); });
+                        return;
+
+                    case Curve::GAUSSIAN2:
+                        apply(xs, n, out, [=](double x) {
+                            double left = gaussianSelect(p0, p1, x);
+                            double right = gaussianSelect(p2, p3, x);
+
+                            return (x >= p0 ? 1 : left) * (x <= p2 ? 1 : right);
+                        });
+
+                        return;
+
+                    case Curve::CUSTOM:
+                        break;
+                }
+
+                BAYESNET_THROWE(INVALID_MF_STRING, "custom curves can not be evaluated without their membership function");
+            }
+        }
+
         MembershipFunction::MembershipFunction() {}
 
         MembershipFunction::~MembershipFunction() {}
 
+        Curve MembershipFunction::getCurve() const {
+            Curve curve = {Curve::CUSTOM, {}};
+            return curve;
+        }
+
         std::ostream &operator<<(std::ostream &os, MembershipFunction &mf) {
             os << mf.toString();
             return os;
         }
 
-        FuzzySet::FuzzySet(size_t states) : _mf(states) {
+        namespace {
+            /// Maximum number of lookup table entries of a tabulated state
+            const size_t MAX_TABLE_SIZE = 1 << 20;
+
+            /// Returns an upper bound of the absolute second derivative of @a curve, or a negative value if none is known
+            double secondDerivativeBound(const Curve &curve) {
+                const double *p = curve.params;
+
+                switch (curve.type) {
+                    case Curve::SIGMOID:
+                        // |f''| = a^2 |f (1 - f) (1 - 2f)| <= a^2 / (6 sqrt(3))
+                        return p[0] * p[0] / (6 * std::sqrt(3.0));
+
+                    case Curve::BELL: {
+                        // with t = |u|^n, n = 2b, |f''| = n |u|^(n - 2) |(n - 1) - (n + 1) t| / (1 + t)^3 / a^2 <= n (n + 1) / a^2
+                        double n = 2 * p[1];
+
+                        if (!(n >= 2)) {
+                            return -1;
+                        }
+
+                        return n * (n + 1) / (p[0] * p[0]);
+                    }
+
+                    case Curve::GAUSSIAN:
+                        // |f''| = f |(x - m)^2 / d^4 - 1 / d^2| <= 1 / d^2
+                        return 1 / (p[1] * p[1]);
+
+                    case Curve::GAUSSIAN2: {
+                        // product rule with |g''| <= 1 / d^2 and |g'| <= 1 / (d sqrt(e))
+                        double left = 1 / (p[1] * p[1]);
+                        double right = 1 / (p[3] * p[3]);
+                        double slopes = 2 / (p[1] * p[3] * std::exp(1.0));
+
+                        return left + slopes + right;
+                    }
+
+                    default:
+                        // cheap to evaluate exactly
+                        return -1;
+                }
+            }
+        }
+
+        FuzzySet::FuzzySet(size_t states) : _mf(states), _curves(states), _tabulationMin(0), _tabulationMax(0), _tabulationError(0) {
             for (size_t i = 0; i < states; i++) {
                 _mf[i] = nullptr;
+                _curves[i].type = Curve::CUSTOM;
             }
         }
 
@@ -404,15 +974,42 @@ namespace bayesNet {
             return _mf[state];
         }
 
+        const MembershipFunction *FuzzySet::getMembershipFunction(size_t state) const {
+            return _mf[state];
+        }
+
         std::vector<double> FuzzySet::getStrength(double x) const {
-            size_t states = _mf.size();
-            std::vector<double> beliefs(states);
+            std::vector<double> beliefs(_mf.size());
+            getStrength(x, beliefs.data());
 
-            for (size_t i = 0; i < states; ++i) {
-                beliefs[i] = _mf[i]->fx(x);
+            return beliefs;
+        }
+
+        void FuzzySet::getStrength(double x, double *strengths) const {
+            for (size_t i = 0; i < _curves.size(); ++i) {
+                strengths[i] = evaluate(i, x);
             }
+        }
 
-            return beliefs;
+        void FuzzySet::getStrength(const double *xs, size_t n, double *strengths) const {
+            for (size_t i = 0; i < _curves.size(); ++i) {
+                double *out = strengths + i * n;
+
+                if (!_tables.empty() && !_tables[i].values.empty()) {
+                    const Table &table = _tables[i];
+
+                    for (size_t j = 0; j < n; ++j) {
+                        double x = xs[j];
+                        out[j] = (x >= table.min && x <= table.max) ? interpolate(i, x) : curves::evaluate(_curves[i], x);
+                    }
+                } else if (_curves[i].type == Curve::CUSTOM) {
+                    for (size_t j = 0; j < n; ++j) {
+                        out[j] = _mf[i]->fx(xs[j]);
+                    }
+                } else {
+                    curves::evaluate(_curves[i], xs, n, out);
+                }
+            }
         }
 
         double FuzzySet::getStrength(double x, size_t state) const {
@@ -420,7 +1017,88 @@ namespace bayesNet {
                 BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
             }
 
-            return _mf[state]->fx(x);
+            return evaluate(state, x);
+        }
+
+        double FuzzySet::evaluate(size_t state, double x) const {
+            const Curve &curve = _curves[state];
+
+            // use lookup table within its domain
+            if (!_tables.empty()) {
+                const Table &table = _tables[state];
+
+                if (!table.values.empty() && x >= table.min && x <= table.max) {
+                    return interpolate(state, x);
+                }
+            }
+
+            // only membership functions not shipped with the framework need a virtual call
+            if (curve.type == Curve::CUSTOM) {
+                return _mf[state]->fx(x);
+            }
+
+            return curves::evaluate(curve, x);
+        }
+
+        double FuzzySet::interpolate(size_t state, double x) const {
+            const Table &table = _tables[state];
+            double pos = (x - table.min) * table.scale;
+            size_t i = std::min(static_cast<size_t>(pos), table.values.size() - 2);
+            double fraction = pos - static_cast<double>(i);
+
+            return table.values[i] + (table.values[i + 1] - table.values[i]) * fraction;
+        }
+
+        void FuzzySet::tabulate(double min, double max, double maxError) {
+            if (!(min < max) || !(maxError > 0)) {
+                BAYESNET_THROWE(INVALID_TABULATION, "empty domain or non-positive maximum error");
+            }
+
+            _tabulationMin = min;
+            _tabulationMax = max;
+            _tabulationError = maxError;
+            _tables.resize(_curves.size());
+
+            for (size_t i = 0; i < _curves.size(); ++i) {
+                tabulateState(i);
+            }
+        }
+
+        void FuzzySet::clearTabulation() {
+            _tables.clear();
+        }
+
+        bool FuzzySet::isTabulated() const {
+            return !_tables.empty();
+        }
+
+        void FuzzySet::tabulateState(size_t state) {
+            Table &table = _tables[state];
+            table.values.clear();
+
+            double bound = secondDerivativeBound(_curves[state]);
+
+            if (!(bound >= 0)) {
+                return;
+            }
+
+            // choose spacing h with h^2 / 8 * bound <= maxError
+            double width = _tabulationMax - _tabulationMin;
+            double intervals = bound > 0 ? std::ceil(width / std::sqrt(8 * _tabulationError / bound)) : 1;
+
+            if (!(intervals < static_cast<double>(MAX_TABLE_SIZE))) {
+                return;
+            }
+
+            size_t size = static_cast<size_t>(std::max(intervals, 1.0)) + 1;
+            table.min = _tabulationMin;
+            table.max = _tabulationMax;
+            table.scale = static_cast<double>(size - 1) / width;
+            table.values.resize(size);
+
+            for (size_t i = 0; i < size; ++i) {
+                table.values[i] = curves::evaluate(_curves[state], _tabulationMin + static_cast<double>(i) / table.scale);
+            }
         }
 
         double FuzzySet::findMaximum(size_t state) const {
@@ -429,6 +1107,16 @@ namespace bayesNet {
 
         void FuzzySet::setMembershipFunction(size_t state, MembershipFunction *mf) {
             _mf[state] = mf;
+
+            if (mf != nullptr) {
+                _curves[state] = mf->getCurve();
+            } else {
+                _curves[state].type = Curve::CUSTOM;
+            }
+
+            if (!_tables.empty()) {
+                tabulateState(state);
+            }
         }
 
         size_t FuzzySet::nrStates() const {
@@ -469,127 +1157,573 @@ namespace bayesNet {
 
         Rule::~Rule() {}
 
+        RuleTable::RuleTable() : _childNrStates(0) {}
+
+        RuleTable::RuleTable(const std::vector<size_t> &parentStates, size_t childStates) : _parentNrStates(parentStates),
+                                                                                           _childNrStates(childStates) {}
+
+        RuleTable::~RuleTable() {}
+
+        void RuleTable::addRule(const unsigned char *states, unsigned char childState) {
+            // check states
+            for (size_t i = 0; i < _parentNrStates.size(); ++i) {
+                if (states[i] >= _parentNrStates[i]) {
+                    BAYESNET_THROWE(INVALID_RULE_STATE, std::to_string(states[i]));
+                }
+            }
+
+            if (childState >= _childNrStates) {
+                BAYESNET_THROWE(INVALID_RULE_STATE, std::to_string(childState));
+            }
+
+            _parentStates.insert(_parentStates.end(), states, states + _parentNrStates.size());
+            _childStates.push_back(childState);
+        }
+
+        const unsigned char *RuleTable::getParentStates(size_t rule) const {
+            return _parentStates.data() + rule * _parentNrStates.size();
+        }
+
+        unsigned char RuleTable::getChildState(size_t rule) const {
+            return _childStates[rule];
+        }
+
+        size_t RuleTable::nrRules() const {
+            return _childStates.size();
+        }
+
+        size_t RuleTable::nrParents() const {
+            return _parentNrStates.size();
+        }
+
+        const std::vector<size_t> &RuleTable::getParentNrStates() const {
+            return _parentNrStates;
+        }
+
+        size_t RuleTable::getChildNrStates() const {
+            return _childNrStates;
+        }
+
+        size_t RuleTable::nrJointStates() const {
+            size_t jointStates = _childNrStates;
+
+            for (size_t i = 0; i < _parentNrStates.size(); ++i) {
+                jointStates *= _parentNrStates[i];
+            }
+
+            return jointStates;
+        }
+
+        RuleGenerator::RuleGenerator(const std::vector<size_t> &parentStates, const std::vector<double> &weights, size_t childStates)
+                : _parentNrStates(parentStates), _weights(weights), _childNrStates(childStates), _fuzzySet(childStates) {
+            if (weights.size() != parentStates.size()) {
+                BAYESNET_THROWE(INVALID_FUZZY_RULE, "expected one weight per parent");
+            }
+        }
+
+        RuleGenerator::~RuleGenerator() {}
+
+        FuzzySet &RuleGenerator::getFuzzySet() {
+            return _fuzzySet;
+        }
+
+        const FuzzySet &RuleGenerator::getFuzzySet() const {
+            return _fuzzySet;
+        }
+
+        double RuleGenerator::getWeight(size_t parent) const {
+            return _weights[parent];
+        }
+
+        size_t RuleGenerator::nrParents() const {
+            return _parentNrStates.size();
+        }
+
+        const std::vector<size_t> &RuleGenerator::getParentNrStates() const {
+            return _parentNrStates;
+        }
+
+        size_t RuleGenerator::getChildNrStates() const {
+            return _childNrStates;
+        }
+
+        size_t RuleGenerator::nrRules() const {
+            size_t rules = 1;
+
+            for (size_t i = 0; i < _parentNrStates.size(); ++i) {
+                rules *= _parentNrStates[i];
+            }
+
+            return rules;
+        }
+
+        unsigned char RuleGenerator::getChildState(double quality) const {
+            // state of maximum strength at the mean weighted state, ties resolve to the higher state
+            double x = quality / static_cast<double>(_parentNrStates.size());
+            size_t max = 0;
+            double maxStrength = _fuzzySet.getStrength(x, static_cast<size_t>(0));
+
+            for (size_t i = 1; i < _childNrStates; ++i) {
+                double strength = _fuzzySet.getStrength(x, i);
+
+                if (strength >= maxStrength) {
+                    max = i;
+                    maxStrength = strength;
+                }
+            }
+
+            return static_cast<unsigned char>(max);
+        }
+
+        unsigned char RuleGenerator::getChildState(const unsigned char *states) const {
+            double quality = 0;
+
+            for (size_t i = 0; i < _parentNrStates.size(); ++i) {
+                quality += states[i] * _weights[i];
+            }
+
+            return getChildState(quality);
+        }
+
+        void RuleGenerator::write(std::ostream &os, const std::string &name, const std::vector<std::string> &parentNames) const {
+            static const char *names[] = {"good", "probably_good", "probably_bad", "bad"};
+            static const char *binaryNames[] = {"false", "true"};
+
+            if (parentNames.size() != _parentNrStates.size()) {
+                BAYESNET_THROWE(INVALID_FUZZY_RULE, "expected one name per parent of " + name);
+            }
+
+            os << name << " begin\n";
+
+            utils::Odometer odometer(_parentNrStates);
+            std::vector<unsigned char> states(_parentNrStates.size());
+            std::string rule;
+
+            for (; odometer.valid(); odometer.next()) {
+                const std::vector<size_t> &count = odometer.getDigits();
+                rule = "   if ";
+
+                for (size_t i = 0; i < count.size(); ++i) {
+                    // binary parents are enumerated starting at true
+                    if (_parentNrStates[i] == 2) {
+                        states[i] = static_cast<unsigned char>(1 - count[i]);
+                        rule += parentNames[i] + "=" + binaryNames[states[i]];
+                    } else {
+                        states[i] = static_cast<unsigned char>(count[i]);
+                        rule += parentNames[i] + "=" + names[states[i]];
+                    }
+
+                    if (i + 1 < count.size()) {
+                        rule += " & ";
+                    }
+                }
+
+                unsigned char childState = getChildState(states.data());
+                rule += " then ";
+                rule += _childNrStates == 2 ? binaryNames[childState] : names[childState];
+                rule += "\n";
+
+                os << rule;
+            }
+
+            os << "end\n\n";
+        }
+
+        RuleTable RuleGenerator::toTable() const {
+            RuleTable table(_parentNrStates, _childNrStates);
+            utils::Odometer odometer(_parentNrStates);
+            std::vector<unsigned char> states(_parentNrStates.size());
+
+            for (; odometer.valid(); odometer.next()) {
+                const std::vector<size_t> &count = odometer.getDigits();
+
+                for (size_t i = 0; i < count.size(); ++i) {
+                    states[i] = static_cast<unsigned char>(count[i]);
+                }
+
+                table.addRule(states.data(), getChildState(states.data()));
+            }
+
+            return table;
+        }
+
         void RuleSet::addRule(Rule *rule) {
-            _rules.push_back(rule);
+            getRules().push_back(rule);
+            _hasTable = false;
+            _generator.reset();
         }
 
-        RuleSet::RuleSet() {}
+        RuleSet::RuleSet() : _hasRules(true), _hasTable(false) {}
 
-        RuleSet::RuleSet(const std::vector<Rule *> &rules) {
+        RuleSet::RuleSet(const std::vector<Rule *> &rules) : _hasRules(true), _hasTable(false) {
             _rules = rules;
         }
 
+        RuleSet::RuleSet(const RuleTable &table) : _table(table), _hasRules(false), _hasTable(true) {}
+
+        RuleSet::RuleSet(const std::shared_ptr<const RuleGenerator> &generator) : _generator(generator), _hasRules(false),
+                                                                                  _hasTable(false) {}
+
         RuleSet::~RuleSet() {}
 
         std::vector<Rule *> &RuleSet::getRules() {
+            if (!_hasRules) {
+                // create rule instances from table
+                getTable();
+                _rules.clear();
+                _tableRules.clear();
+
+                for (size_t i = 0; i < _table.nrRules(); ++i) {
+                    const unsigned char *states = _table.getParentStates(i);
+                    std::vector<RuleState *> parentStates(_table.nrParents());
+
+                    for (size_t j = 0; j < parentStates.size(); ++j) {
+                        if (_table.getParentNrStates()[j] == 2) {
+                            parentStates[j] = states::get(static_cast<state::StateBinary>(states[j]));
+                        } else {
+                            parentStates[j] = states::get(static_cast<state::State>(states[j]));
+                        }
+                    }
+
+                    RuleState *childState;
+
+                    if (_table.getChildNrStates() == 2) {
+                        childState = states::get(static_cast<state::StateBinary>(_table.getChildState(i)));
+                    } else {
+                        childState = states::get(static_cast<state::State>(_table.getChildState(i)));
+                    }
+
+                    _tableRules.push_back(std::make_shared<Rule>(parentStates, childState));
+                    _rules.push_back(_tableRules.back().get());
+                }
+
+                _hasRules = true;
+            }
+
             return _rules;
         }
 
+        const RuleTable &RuleSet::getTable() {
+            if (!_hasTable && _generator) {
+                // enumerate generated rules
+                _table = _generator->toTable();
+                _hasTable = true;
+            }
+
+            if (!_hasTable) {
+                // create table from rule instances
+                std::vector<size_t> parentStates;
+                size_t childStates = 0;
+
+                if (!_rules.empty()) {
+                    std::vector<RuleState *> &states = _rules[0]->getParentStates();
+
+                    for (size_t j = 0; j < states.size(); ++j) {
+                        parentStates.push_back(states[j]->isBinary() ? 2 : 4);
+                    }
+
+                    childStates = _rules[0]->getChildState().isBinary() ? 2 : 4;
+                }
+
+                _table = RuleTable(parentStates, childStates);
+                std::vector<unsigned char> row(parentStates.size());
+
+                for (size_t i = 0; i < _rules.size(); ++i) {
+                    std::vector<RuleState *> &states = _rules[i]->getParentStates();
+
+                    if (states.size() != parentStates.size()) {
+                        BAYESNET_THROWE(INVALID_FUZZY_RULE, "rules differ in number of parents");
+                    }
+
+                    for (size_t j = 0; j < states.size(); ++j) {
+                        row[j] = static_cast<unsigned char>(states[j]->getState());
+                    }
+
+                    _table.addRule(row.data(), static_cast<unsigned char>(_rules[i]->getChildState().getState()));
+                }
+
+                _hasTable = true;
+            }
+
+            return _table;
+        }
+
+        const RuleGenerator *RuleSet::getGenerator() const {
+            return _generator.get();
+        }
+
         size_t RuleSet::nrJointStates() const {
+            if (_generator) {
+                size_t rules = _generator->nrRules();
+                return rules * rules * _generator->getChildNrStates();
+            }
+
+            if (_hasTable) {
+                return _table.nrRules() * _table.nrJointStates();
+            }
+
             return _rules.size() * _rules[0]->nrJointStates();
         }
 
+        const size_t Controller::CONFIGURATIONS_PER_TASK;
+
         Controller::Controller(const std::vector<FuzzySet *> &set, RuleSet *rules, double tolerance) : _rules(rules), _fuzzySet(set),
-                                                                                                       _nullBeliefTolerance(tolerance) {
+                                                                                                       _nullBeliefTolerance(tolerance),
+                                                                                                       _prunable(false), _table(nullptr),
+                                                                                                       _generator(nullptr), _childNrStates(0) {
 
         }
 
         Controller::~Controller() {}
 
-        CPT Controller::inferCPT() {
-            // get rules
-            std::vector<Rule *> &fuzzyRules = _rules->getRules();
-            // create cpt
-            size_t jointStates = fuzzyRules[0]->nrJointStates();
-            CPT cpt(jointStates);
-
-            // get states
-            std::vector<RuleState *> &parentStates = fuzzyRules[0]->getParentStates();
-            std::vector<size_t> maxStates(parentStates.size());
-
-            for (size_t j = 0; j < parentStates.size(); ++j) {
-                if (parentStates[j]->isBinary()) {
-                    maxStates[j] = 2;
-                } else {
-                    maxStates[j] = 4;
+        void Controller::plan() {
+            // get rules, generated rules are evaluated without enumerating them
+            _generator = _rules->getGenerator();
+
+            if (_generator != nullptr) {
+                _table = nullptr;
+                _parentNrStates = _generator->getParentNrStates();
+                _childNrStates = _generator->getChildNrStates();
+            } else {
+                _table = &_rules->getTable();
+
+                if (_table->nrRules() == 0) {
+                    BAYESNET_THROWE(INVALID_FUZZY_RULE, "empty rule set");
                 }
+
+                _parentNrStates = _table->getParentNrStates();
+                _childNrStates = _table->getChildNrStates();
             }
-            
-            // init state counter
-            utils::Counter stateCounter(parentStates.size(), maxStates);
 
-            // iterate over every possible parental state and infer partial cpt
-            do {
-                std::vector<double> inferred = infer(stateCounter.getCount());
-                size_t maxIncrement = stateCounter.getMaximumIncrement();
+            if (_parentNrStates.size() != _fuzzySet.size()) {
+                BAYESNET_THROWE(INVALID_FUZZY_RULE, "expected one fuzzy set per parent");
+            }
 
-                // apply partial cpt
-                for (size_t i = 0; i < inferred.size(); i++) {
-                    cpt.set((i * maxIncrement) + stateCounter.getIncrement(), inferred[i]);
+            _strengths.resize(_fuzzySet.size());
+            _prunable = true;
+
+            for (size_t i = 0; i < _fuzzySet.size(); ++i) {
+                size_t states = _fuzzySet[i]->nrStates();
+                _strengths[i].resize(states * states);
+
+                for (size_t state = 0; state < states; ++state) {
+                    // strength of each rule state at the maximum of the parent state
+                    double max = _fuzzySet[i]->findMaximum(state);
+
+                    for (size_t ruleState = 0; ruleState < states; ++ruleState) {
+                        double strength = _fuzzySet[i]->getStrength(max, ruleState);
+                        _strengths[i][state * states + ruleState] = strength;
+
+                        if (!(strength >= 0 && strength <= 1)) {
+                            _prunable = false;
+                        }
+                    }
                 }
-            } while (stateCounter.countUp());
+            }
+        }
+
+        size_t Controller::nrConfigurations() const {
+            size_t configurations = 1;
+
+            for (size_t i = 0; i < _parentNrStates.size(); ++i) {
+                configurations *= _parentNrStates[i];
+            }
+
+            return configurations;
+        }
+
+        size_t Controller::nrJointStates() const {
+            return nrConfigurations() * _childNrStates;
+        }
+
+        CPT Controller::inferCPT() {
+            // prepare evaluation plan
+            plan();
+
+            // infer all parent configurations at once
+            CPT cpt(nrJointStates());
+            inferCPT(cpt, 0, nrConfigurations());
 
-            // return cpt
             return cpt;
         }
 
-        std::vector<double> Controller::infer(const std::vector<size_t> &states) {
-            std::vector<double> max(states.size());
+        CPT Controller::inferCPT(utils::ThreadPool &pool) {
+            // prepare evaluation plan
+            plan();
 
-            // find maximum for given states from fuzzy sets
-            for (size_t i = 0; i < states.size(); ++i) {
-                max[i] = _fuzzySet[i]->findMaximum(states[i]);
-            }
+            // split parent configurations into tasks writing disjoint entries of the cpt
+            CPT cpt(nrJointStates());
+            size_t configurations = nrConfigurations();
+            size_t tasks = (configurations + CONFIGURATIONS_PER_TASK - 1) / CONFIGURATIONS_PER_TASK;
+
+            pool.parallelFor(tasks, [this, &cpt, configurations](size_t task) {
+                size_t begin = task * CONFIGURATIONS_PER_TASK;
+                inferCPT(cpt, begin, std::min(begin + CONFIGURATIONS_PER_TASK, configurations));
+            });
 
-            // get rules
-            std::vector<Rule *> &rules = _rules->getRules();
-            std::vector<double> conclusions(rules.size());
+            return cpt;
+        }
 
-            // iterate over rules and appyl Mamdani fuzzy inference using Product as tnorm
-            for (size_t i = 0; i < rules.size(); ++i) {
-                double tNorm = 1;
+        void Controller::inferCPT(CPT &cpt, size_t begin, size_t end) const {
+            // visit the given range of parent configurations, the child state is the most significant digit of the cpt
+            utils::Odometer odometer(_parentNrStates);
+            odometer.range(begin, end);
 
-                for (size_t j = 0; j < states.size(); ++j) {
-                    tNorm *= _fuzzySet[j]->getStrength(max[j], rules[i]->getParentStates()[j]->getState());
+            size_t configurations = odometer.size();
+            std::vector<const double *> rows(_parentNrStates.size());
+            std::vector<double> inferred(_childNrStates);
+
+            // iterate over the parental states and infer partial cpt
+            for (; odometer.valid(); odometer.next()) {
+                infer(odometer.getDigits(), rows, inferred);
+
+                // apply partial cpt
+                for (size_t i = 0; i < inferred.size(); i++) {
+                    cpt.set((i * configurations) + odometer.getIndex(), inferred[i]);
                 }
+            }
+        }
 
-                // truncate
-                int trunc = static_cast<int>(tNorm * 100);
-                tNorm = trunc / 100.0;
+        uint64_t Controller::getKey() const {
+            uint64_t key = utils::hash(&_nullBeliefTolerance, sizeof(_nullBeliefTolerance));
+            uint64_t childStates = _childNrStates;
+            key = utils::hash(&childStates, sizeof(childStates), key);
 
-                conclusions[i] = tNorm;
+            // strength matrices of the parents
+            for (size_t i = 0; i < _strengths.size(); ++i) {
+                uint64_t parentStates = _parentNrStates[i];
+                key = utils::hash(&parentStates, sizeof(parentStates), key);
+                key = utils::hash(_strengths[i].data(), _strengths[i].size() * sizeof(double), key);
             }
 
-            // apply inferred values to partial cpt
-            size_t nrStates;
+            if (_generator != nullptr) {
+                // generated rules are defined by the weights and the membership functions of the generator fuzzy set
+                key = utils::hash(std::string("generator"), key);
 
-            if (_rules->getRules()[0]->getChildState().isBinary()) {
-                nrStates = 2;
+                for (size_t i = 0; i < _generator->nrParents(); ++i) {
+                    double weight = _generator->getWeight(i);
+                    key = utils::hash(&weight, sizeof(weight), key);
+                }
+
+                for (size_t state = 0; state < _childNrStates; ++state) {
+                    const MembershipFunction *mf = _generator->getFuzzySet().getMembershipFunction(state);
+
+                    if (mf == nullptr) {
+                        key = utils::hash(std::string("none"), key);
+                        continue;
+                    }
+
+                    // the curve type distinguishes functions sharing a string representation
+                    int32_t type = static_cast<int32_t>(mf->getCurve().type);
+                    key = utils::hash(&type, sizeof(type), key);
+                    key = utils::hash(mf->toString(), key);
+                }
             } else {
-                nrStates = 4;
+                // rule table
+                key = utils::hash(std::string("table"), key);
+                key = utils::hash(_table->getParentStates(0), _table->nrRules() * _table->nrParents(), key);
+
+                std::vector<unsigned char> childStates(_table->nrRules());
+
+                for (size_t i = 0; i < childStates.size(); ++i) {
+                    childStates[i] = _table->getChildState(i);
+                }
+
+                key = utils::hash(childStates.data(), childStates.size(), key);
+            }
+
+            return key;
+        }
+
+        void Controller::infer(const std::vector<size_t> &states, std::vector<const double *> &rows, std::vector<double> &beliefs) const {
+            size_t nrParents = states.size();
+
+            // select the matrix rows of the given parent states
+            for (size_t j = 0; j < nrParents; ++j) {
+                rows[j] = _strengths[j].data() + states[j] * _fuzzySet[j]->nrStates();
             }
 
-            std::vector<double> inferredBeliefs(nrStates);
+            std::fill(beliefs.begin(), beliefs.end(), 0);
+
+            if (_generator != nullptr) {
+                inferGenerated(0, 1, 0, rows, beliefs);
+            } else {
+                const RuleTable &table = *_table;
+
+                // iterate over rules and appyl Mamdani fuzzy inference using Product as tnorm
+                for (size_t i = 0; i < table.nrRules(); ++i) {
+                    const unsigned char *ruleStates = table.getParentStates(i);
+                    double tNorm = 1;
+                    size_t j = 0;
+
+                    for (; j < nrParents; ++j) {
+                        tNorm *= rows[j][ruleStates[j]];
+
+                        // further factors can only decrease the product, so the truncated conclusion stays zero
+                        if (_prunable && tNorm * 100 < 1) {
+                            break;
+                        }
+                    }
+
+                    if (j < nrParents) {
+                        continue;
+                    }
+
+                    // truncate
+                    int trunc = static_cast<int>(tNorm * 100);
+                    tNorm = trunc / 100.0;
 
-            for (size_t i = 0; i < conclusions.size(); ++i) {
-                size_t state = rules[i]->getChildState().getState();
+                    // apply inferred value to partial cpt
+                    size_t state = table.getChildState(i);
 
-                if (conclusions[i] > inferredBeliefs[state]) {
-                    inferredBeliefs[state] = conclusions[i];
+                    if (tNorm > beliefs[state]) {
+                        beliefs[state] = tNorm;
+                    }
                 }
             }
 
-            for (size_t i = 0; i < inferredBeliefs.size(); ++i) {
-                if (inferredBeliefs[i] < _nullBeliefTolerance) {
-                    inferredBeliefs[i] = _nullBeliefTolerance;
+            for (size_t i = 0; i < beliefs.size(); ++i) {
+                if (beliefs[i] < _nullBeliefTolerance) {
+                    beliefs[i] = _nullBeliefTolerance;
                 }
             }
 
             // normalize inferred table
-            utils::vectorNormalize(inferredBeliefs);
+            utils::vectorNormalize(beliefs);
+        }
 
-            // return partial cpt
-            return inferredBeliefs;
+        void Controller::inferGenerated(size_t parent, double tNorm, double quality, const std::vector<const double *> &rows, std::vector<double> &beliefs) const {
+            if (parent == rows.size()) {
+                // truncate
+                int trunc = static_cast<int>(tNorm * 100);
+                tNorm = trunc / 100.0;
+
+                // beliefs start at zero, so only positive conclusions can be applied
+                if (tNorm <= 0) {
+                    return;
+                }
+
+                // apply inferred value to partial cpt
+                size_t state = _generator->getChildState(quality);
+
+                if (tNorm > beliefs[state]) {
+                    beliefs[state] = tNorm;
+                }
+
+                return;
+            }
+
+            // rules sharing the states of the first parents share the partial product and weighted sum
+            for (size_t state = 0; state < _parentNrStates[parent]; ++state) {
+                double product = tNorm * rows[parent][state];
+
+                // further factors can only decrease the product, so all rules of this subtree truncate to zero
+                if (_prunable && product * 100 < 1) {
+                    continue;
+                }
+
+                inferGenerated(parent + 1, product, quality + state * _generator->getWeight(parent), rows, beliefs);
+            }
         }
 
         RuleState::RuleState(size_t state, bool binary) : _state(state), _binary(binary) {}
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <unordered_map>
 
 #include <bayesnet/inference.h>
 #include <bayesnet/exception.h>
@@ -15,6 +16,20 @@ namespace bayesNet {
 
     namespace inference {
 
+        namespace {
+
+            /// Returns @a belief of node @a node as BayesBelief
+            state::BayesBelief toBayesBelief(const dai::Factor &belief, const Node &node) {
+                state::BayesBelief bayesBelief(node.isBinary());
+
+                for (size_t i = 0; i < belief.nrStates(); ++i) {
+                    bayesBelief[i] = belief[i];
+                }
+
+                return bayesBelief;
+            }
+        }
+
         Algorithm::Algorithm() : _algorithm(LOOPY_BELIEF_PROPAGATION),
                                  _inferenceProperties(DEFAULT_LOOPY_BELIEF_PROPAGATION_PROPERTIES),
                                  _inferenceInstance(NULL) {}
@@ -141,7 +156,7 @@ namespace bayesNet {
                 }
 
                 case Algorithm::JUNCTION_TREE: {
-                    _inferenceInstance = new dai::JTree(fg, _inferenceProperties);
+                    _inferenceInstance = initJunctionTree(fg, nodes);
                     break;
                 }
 
@@ -160,6 +175,76 @@ namespace bayesNet {
             }
         }
 
+        dai::InfAlg *Algorithm::initJunctionTree(const dai::FactorGraph &fg, const std::vector<Node *> &nodes) {
+            // lookup variables by label
+            std::unordered_map<size_t, dai::Var> vars;
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                vars[nodes[i]->getDiscrete().label()] = nodes[i]->getDiscrete();
+            }
+
+            // build junction tree from prepared clusters, skipping the elimination
+            if (!_clusters.empty()) {
+                std::vector<dai::VarSet> cliques(_clusters.size());
+                bool valid = true;
+
+                for (size_t i = 0; i < _clusters.size() && valid; ++i) {
+                    for (size_t j = 0; j < _clusters[i].size(); ++j) {
+                        std::unordered_map<size_t, dai::Var>::const_iterator var = vars.find(_clusters[i][j]);
+
+                        if (var == vars.end()) {
+                            valid = false;
+                            break;
+                        }
+
+                        cliques[i] |= var->second;
+                    }
+                }
+
+                // the clusters of a changed network may still exist but miss factors of new connections
+                for (size_t i = 0; i < fg.nrFactors() && valid; ++i) {
+                    valid = false;
+
+                    for (size_t j = 0; j < cliques.size() && !valid; ++j) {
+                        valid = fg.factor(i).vars() << cliques[j];
+                    }
+                }
+
+                if (valid) {
+                    dai::JTree *jtree = new dai::JTree(fg, _inferenceProperties, false);
+                    jtree->GenerateJT(fg, cliques);
+                    return jtree;
+                }
+
+                // clusters do not belong to this network
+                _clusters.clear();
+            }
+
+            dai::JTree *jtree = new dai::JTree(fg, _inferenceProperties);
+
+            // remember clusters to be able to skip the elimination next time
+            _clusters.resize(jtree->nrORs());
+
+            for (size_t i = 0; i < jtree->nrORs(); ++i) {
+                const dai::VarSet &cluster = jtree->OR(i).vars();
+                _clusters[i].clear();
+
+                for (dai::VarSet::const_iterator it = cluster.begin(); it != cluster.end(); ++it) {
+                    _clusters[i].push_back(it->label());
+                }
+            }
+
+            return jtree;
+        }
+
+        void Algorithm::setClusters(const std::vector<std::vector<size_t> > &clusters) {
+            _clusters = clusters;
+        }
+
+        const std::vector<std::vector<size_t> > &Algorithm::getClusters() const {
+            return _clusters;
+        }
+
         void Algorithm::init(Node &node) {
             if (_inferenceInstance == NULL) {
                 BAYESNET_THROW(ALGORITHM_NOT_INITIALIZED);
@@ -169,6 +254,26 @@ namespace bayesNet {
             _inferenceInstance->init(node.getConditionalDiscrete());
         }
 
+        void Algorithm::update(const std::vector<Node *> &nodes) {
+            if (_inferenceInstance == NULL) {
+                BAYESNET_THROW(ALGORITHM_NOT_INITIALIZED);
+            }
+
+            if (nodes.empty()) {
+                return;
+            }
+
+            dai::VarSet vars;
+
+            // overwrite factors of the factor graph
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                _inferenceInstance->fg().setFactor(nodes[i]->getFactorGraphIndex(), nodes[i]->getFactor());
+                vars |= nodes[i]->getConditionalDiscrete();
+            }
+
+            _inferenceInstance->init(vars);
+        }
+
         void Algorithm::save(const std::string &filename) {
             std::ofstream file(filename);
 
@@ -249,14 +354,47 @@ namespace bayesNet {
                 BAYESNET_THROW(ALGORITHM_NOT_INITIALIZED);
             }
 
-            dai::Factor belief = _inferenceInstance->belief(node.getDiscrete());
-            state::BayesBelief bayesBelief(node.isBinary());
+            return toBayesBelief(_inferenceInstance->belief(node.getDiscrete()), node);
+        }
+
+        Context::Context(const Algorithm &algorithm) : _inferenceInstance(NULL) {
+            if (algorithm._inferenceInstance == NULL) {
+                BAYESNET_THROW(ALGORITHM_NOT_INITIALIZED);
+            }
+
+            _inferenceInstance = algorithm._inferenceInstance->clone();
+        }
+
+        Context::~Context() {
+            delete _inferenceInstance;
+        }
+
+        void Context::synchronize(const Algorithm &algorithm) {
+            if (algorithm._inferenceInstance == NULL) {
+                BAYESNET_THROW(ALGORITHM_NOT_INITIALIZED);
+            }
+
+            const dai::FactorGraph &fg = algorithm._inferenceInstance->fg();
 
-            for (size_t i = 0; i < belief.nrStates(); ++i) {
-                bayesBelief[i] = belief[i];
+            for (size_t i = 0; i < fg.nrFactors(); ++i) {
+                _inferenceInstance->fg().setFactor(i, fg.factor(i));
             }
+        }
+
+        void Context::setFactor(const Node &node, const dai::Factor &factor) {
+            _inferenceInstance->fg().setFactor(node.getFactorGraphIndex(), factor);
+        }
+
+        void Context::init() {
+            _inferenceInstance->init();
+        }
+
+        void Context::run() {
+            _inferenceInstance->run();
+        }
 
-            return bayesBelief;
+        state::BayesBelief Context::belief(const Node &node) const {
+            return toBayesBelief(_inferenceInstance->belief(node.getDiscrete()), node);
         }
     }
 }
@@ -1,11 +1,15 @@
-#include <map>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <memory>
+#include <cmath>
+#include <random>
 
 #include <bayesnet/network.h>
 #include <bayesnet/exception.h>
 #include <bayesnet/util.h>
+#include <bayesnet/cache.h>
 
 
 namespace bayesNet {
@@ -16,9 +20,34 @@ namespace bayesNet {
 
     Network::Network(const inference::Algorithm &algorithm) : _inferenceAlgorithm(algorithm), _nodeCounter(0), _init(false) {}
 
-    Network::Network(const std::string &file) : _nodeCounter(0), _init(false) {
+    Network::Network(const std::string &file) : _nodeCounter(0), _init(false), _file(file) {
         file::InitializationVector *iv = file::InitializationVector::parse(file);
         load(iv);
+        _savedFile = file;
+
+        // free memory for iv
+        delete iv;
+    }
+
+    Network::Network(const std::string &file, const std::string &cacheDirectory) : _nodeCounter(0), _init(false), _file(file), _cacheDirectory(cacheDirectory) {
+        cache::NetworkCache networkCache(cacheDirectory);
+        file::InitializationVector cached;
+        std::vector<std::vector<size_t> > clusters;
+
+        if (networkCache.load(file, cached, clusters)) {
+            // load compiled network and reuse prepared inference structure
+            load(&cached);
+            _savedFile = file;
+            _inferenceAlgorithm.setClusters(clusters);
+            return;
+        }
+
+        file::InitializationVector *iv = file::InitializationVector::parse(file);
+        load(iv);
+        _savedFile = file;
+
+        // write cache entry, the clusters are added by init
+        networkCache.store(file, *iv, clusters);
 
         // free memory for iv
         delete iv;
@@ -70,9 +99,29 @@ namespace bayesNet {
         return *_nodes[nodeValue];
     }
 
+    Node &Network::getNode(size_t id) {
+        if (id >= _nodes.size()) {
+            BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+        }
+
+        return *_nodes[id];
+    }
+
+    size_t Network::nrNodes() const {
+        return _nodes.size();
+    }
+
     void Network::init() {
+        bool prepared = !_inferenceAlgorithm.getClusters().empty();
+
         // create inference algorithm instance using nodes
         _inferenceAlgorithm.init(_nodes);
+        _contexts.clear();
+
+        // add freshly prepared inference structure to cache entry
+        if (!_cacheDirectory.empty() && !prepared && !_inferenceAlgorithm.getClusters().empty()) {
+            cache::NetworkCache(_cacheDirectory).update(_file, _inferenceAlgorithm.getClusters());
+        }
 
         // set initialized flag
         _init = true;
@@ -146,16 +195,17 @@ namespace bayesNet {
             BAYESNET_THROW(NET_NOT_INITIALIZED);
         }
 
-        // get node and 
+        // get node and read belief from inference instance
         Node &node = getNode(name);
-        // read belief from inference instance
-        auto belief = _inferenceAlgorithm.belief(node);
-      
+        return getContinousBelief(_inferenceAlgorithm.belief(node));
+    }
+
+    double Network::getContinousBelief(const state::BayesBelief &belief) {
         size_t nrStates = belief.nrStates();
-        double continousBelief;
+        double continousBelief = 0.0;
 
         for (size_t i = 0; i < nrStates; i++) {
-            continousBelief += belief[i] * i;
+            continousBelief += belief.get(i) * i;
         }
 
         // normalize to a range of 2 and move by -1 thus we get a value from -1 to 1, where -1 is worst and 1 best state
@@ -163,7 +213,7 @@ namespace bayesNet {
         continousBelief -= 1;
 
         // if node is not binary inverse value
-        if (!node.isBinary()) {
+        if (!belief.isBinary()) {
             continousBelief *= -1;
         }
         
@@ -171,6 +221,265 @@ namespace bayesNet {
         return continousBelief;
     }
 
+    std::unique_ptr<inference::Context> Network::createContext() const {
+        // check if initialized
+        if (!_init) {
+            BAYESNET_THROW(NET_NOT_INITIALIZED);
+        }
+
+        return std::unique_ptr<inference::Context>(new inference::Context(_inferenceAlgorithm));
+    }
+
+    inference::BeliefMatrix Network::sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets) {
+        // keep the threads for later sweeps instead of starting them per call
+        if (!_pool) {
+            _pool.reset(new utils::ThreadPool());
+        }
+
+        return sweep(name, values, targets, *_pool);
+    }
+
+    inference::BeliefMatrix Network::sweep(const std::string &name, const std::vector<double> &values, const std::vector<std::string> &targets, utils::ThreadPool &pool) {
+        // check if initialized
+        if (!_init) {
+            BAYESNET_THROW(NET_NOT_INITIALIZED);
+        }
+
+        Node &node = getNode(name);
+        inference::BeliefMatrix matrix;
+
+        // lookup targets and assign their columns
+        std::vector<Node *> targetNodes = getTargets(targets, matrix.offsets, matrix.columns);
+        matrix.rows = values.size();
+        matrix.values.resize(matrix.rows * matrix.columns);
+
+        // prepare the factor of each value up front, so the threads only apply inference
+        std::vector<Factor> factors(values.size(), node.getFactor());
+
+        if (isSensor(node)) {
+            SensorNode &sensor = getSensor(node);
+            std::vector<double> probabilities;
+
+            for (size_t i = 0; i < values.size(); ++i) {
+                sensor.mapObservation(values[i], probabilities);
+
+                for (size_t j = 0; j < probabilities.size(); ++j) {
+                    factors[i].set(j, dai::Real(probabilities[j]));
+                }
+            }
+        } else {
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (values[i] < 0 || values[i] != static_cast<double>(static_cast<size_t>(values[i]))) {
+                    BAYESNET_THROWE(UNKNOWN_STATE_VALUE, std::to_string(values[i]));
+                }
+
+                factors[i].setEvidence(static_cast<size_t>(values[i]));
+            }
+        }
+
+        // use one clone of the inference instance per thread
+        size_t nrContexts = std::min(pool.size(), values.size());
+        prepareContexts(nrContexts);
+
+        pool.parallelFor(nrContexts, [&](size_t c) {
+            inference::Context &context = *_contexts[c];
+
+            for (size_t i = c; i < values.size(); i += nrContexts) {
+                context.setFactor(node, factors[i]);
+                context.init();
+                context.run();
+
+                double *row = matrix.values.data() + i * matrix.columns;
+
+                for (size_t t = 0; t < targetNodes.size(); ++t) {
+                    state::BayesBelief belief = context.belief(*targetNodes[t]);
+
+                    for (size_t s = 0; s < belief.nrStates(); ++s) {
+                        row[matrix.offsets[t] + s] = belief[s];
+                    }
+                }
+            }
+        });
+
+        return matrix;
+    }
+
+    void Network::setNoiseModel(const std::string &name, const utils::NoiseModel &model) {
+        getSensor(getNode(name)).setNoiseModel(model);
+    }
+
+    inference::BeliefDistribution Network::observeSamples(const std::pair<size_t, double> *observations, size_t n, size_t samples, const std::vector<std::string> &targets,
+                                                          const std::vector<double> &levels, utils::ThreadPool &pool, uint64_t seed) {
+        // check if initialized
+        if (!_init) {
+            BAYESNET_THROW(NET_NOT_INITIALIZED);
+        }
+
+        inference::BeliefDistribution distribution;
+        std::vector<Node *> targetNodes = getTargets(targets, distribution.offsets, distribution.columns);
+        distribution.samples = samples;
+        distribution.levels = levels;
+
+        // lookup sensors, the quantized strengths of all sensors of one sample form a key of width stride
+        std::vector<SensorNode *> sensors;
+        std::vector<size_t> sensorOffsets;
+        size_t stride = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            if (observations[i].first >= _nodes.size()) {
+                BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+            }
+
+            sensors.push_back(&getSensor(*_nodes[observations[i].first]));
+            sensorOffsets.push_back(stride);
+            stride += sensors[i]->nrStates();
+        }
+
+        // draw and fuzzify samples in batches
+        const size_t batchSize = 1024;
+        size_t nrBatches = (samples + batchSize - 1) / batchSize;
+        std::vector<unsigned char> keys(samples * stride);
+
+        pool.parallelFor(nrBatches, [&](size_t b) {
+            size_t begin = b * batchSize;
+            size_t size = std::min(batchSize, samples - begin);
+            std::mt19937_64 rng(utils::hash(&b, sizeof(b), seed));
+            std::vector<double> xs(size);
+            std::vector<double> strengths;
+
+            for (size_t k = 0; k < sensors.size(); ++k) {
+                const utils::NoiseModel &noiseModel = sensors[k]->getNoiseModel();
+
+                for (size_t i = 0; i < size; ++i) {
+                    xs[i] = noiseModel.sample(observations[k].second, rng);
+                }
+
+                sensors[k]->quantizeObservations(xs.data(), size, strengths, keys.data() + begin * stride + sensorOffsets[k], stride);
+            }
+        });
+
+        // count samples per distinct key
+        std::unordered_map<std::string, size_t> registry;
+        std::vector<size_t> representatives;
+        std::vector<size_t> counts;
+
+        for (size_t i = 0; i < samples; ++i) {
+            std::string key(reinterpret_cast<const char *>(keys.data() + i * stride), stride);
+            std::pair<std::unordered_map<std::string, size_t>::iterator, bool> entry = registry.insert(std::make_pair(key, representatives.size()));
+
+            if (entry.second) {
+                representatives.push_back(i);
+                counts.push_back(0);
+            }
+
+            counts[entry.first->second]++;
+        }
+
+        distribution.evaluations = representatives.size();
+
+        // evaluate each distinct key once, using one clone of the inference instance per thread
+        std::vector<double> beliefs(representatives.size() * distribution.columns);
+        std::vector<Factor> sensorFactors;
+        size_t nrContexts = std::min(pool.size(), representatives.size());
+        prepareContexts(nrContexts);
+
+        for (size_t k = 0; k < sensors.size(); ++k) {
+            sensorFactors.push_back(sensors[k]->getFactor());
+        }
+
+        pool.parallelFor(nrContexts, [&](size_t c) {
+            inference::Context &context = *_contexts[c];
+            std::vector<Factor> factors(sensorFactors);
+            std::vector<double> probabilities;
+
+            for (size_t e = c; e < representatives.size(); e += nrContexts) {
+                const unsigned char *key = keys.data() + representatives[e] * stride;
+
+                for (size_t k = 0; k < sensors.size(); ++k) {
+                    SensorNode::toProbabilities(key + sensorOffsets[k], sensors[k]->nrStates(), probabilities);
+
+                    for (size_t s = 0; s < probabilities.size(); ++s) {
+                        factors[k].set(s, dai::Real(probabilities[s]));
+                    }
+
+                    context.setFactor(*sensors[k], factors[k]);
+                }
+
+                context.init();
+                context.run();
+
+                double *row = beliefs.data() + e * distribution.columns;
+
+                for (size_t t = 0; t < targetNodes.size(); ++t) {
+                    state::BayesBelief belief = context.belief(*targetNodes[t]);
+
+                    for (size_t s = 0; s < belief.nrStates(); ++s) {
+                        row[distribution.offsets[t] + s] = belief[s];
+                    }
+                }
+            }
+        });
+
+        // weight the beliefs of each distinct key by its number of samples
+        distribution.mean.assign(distribution.columns, 0.0);
+        distribution.quantiles.resize(levels.size() * distribution.columns);
+        std::vector<size_t> order(representatives.size());
+
+        for (size_t j = 0; j < distribution.columns; ++j) {
+            for (size_t e = 0; e < representatives.size(); ++e) {
+                distribution.mean[j] += beliefs[e * distribution.columns + j] * counts[e];
+                order[e] = e;
+            }
+
+            distribution.mean[j] /= std::max<size_t>(samples, 1);
+
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return beliefs[a * distribution.columns + j] < beliefs[b * distribution.columns + j];
+            });
+
+            // nearest rank quantiles of the weighted beliefs
+            for (size_t l = 0; l < levels.size(); ++l) {
+                size_t rank = std::max<size_t>(static_cast<size_t>(std::ceil(levels[l] * samples)), 1);
+                size_t cumulated = 0;
+                size_t e = 0;
+
+                while (e + 1 < order.size() && cumulated + counts[order[e]] < rank) {
+                    cumulated += counts[order[e]];
+                    e++;
+                }
+
+                distribution.quantiles[l * distribution.columns + j] = order.empty() ? 0.0 : beliefs[order[e] * distribution.columns + j];
+            }
+        }
+
+        return distribution;
+    }
+
+    void Network::prepareContexts(size_t n) {
+        // existing clones only need the current factors of the network
+        for (size_t i = 0; i < std::min(n, _contexts.size()); ++i) {
+            _contexts[i]->synchronize(_inferenceAlgorithm);
+        }
+
+        while (_contexts.size() < n) {
+            _contexts.push_back(std::unique_ptr<inference::Context>(new inference::Context(_inferenceAlgorithm)));
+        }
+    }
+
+    std::vector<Node *> Network::getTargets(const std::vector<std::string> &targets, std::vector<size_t> &offsets, size_t &columns) {
+        std::vector<Node *> nodes;
+        offsets.clear();
+        columns = 0;
+
+        for (size_t i = 0; i < targets.size(); ++i) {
+            nodes.push_back(&getNode(targets[i]));
+            offsets.push_back(columns);
+            columns += nodes[i]->nrStates();
+        }
+
+        return nodes;
+    }
+
     void Network::setCPT(const std::string &name, const CPT &cpt) {
         getNode(name).setCPT(cpt);
     }
@@ -229,6 +538,77 @@ namespace bayesNet {
         }
 
         iv->save(filename);
+
+        // free memory for iv
+        delete iv;
+
+        // network file contains all changes now, so an existing journal is obsolete
+        file::Journal(filename).clear();
+
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            _nodes[i]->clearDirty();
+        }
+
+        _savedFile = filename;
+    }
+
+    void Network::saveIncremental(const std::string &filename, double compactionRatio) {
+        std::ifstream networkFile(filename, std::ios::binary | std::ios::ate);
+
+        // nothing to append to or changes refer to another file, write whole network
+        if (!networkFile.is_open() || filename != _savedFile) {
+            save(filename);
+            return;
+        }
+
+        size_t networkFileSize = static_cast<size_t>(networkFile.tellg());
+        networkFile.close();
+
+        // collect changed cpts and fuzzy sets
+        file::InitializationVector delta;
+        bool changed = false;
+
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            if (_nodes[i]->isCPTDirty()) {
+                delta.setCPT(_nodes[i]->getName(), _nodes[i]->getCPT().getProbabilities());
+                changed = true;
+            }
+
+            if (_nodes[i]->isFuzzySetDirty()) {
+                fuzzyLogic::FuzzySet &fuzzySet = _nodes[i]->getFuzzySet();
+                std::vector<std::string> curves(fuzzySet.nrStates());
+
+                for (size_t j = 0; j < fuzzySet.nrStates(); j++) {
+                    fuzzyLogic::MembershipFunction *mf = fuzzySet.getMembershipFunction(j);
+
+                    if (mf != NULL) {
+                        curves[j] = mf->toString();
+                    } else {
+                        curves[j] = "NULL";
+                    }
+                }
+
+                delta.setFuzzySet(_nodes[i]->getName(), curves);
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            return;
+        }
+
+        // append changes to journal
+        file::Journal journal(filename);
+        journal.append(delta);
+
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            _nodes[i]->clearDirty();
+        }
+
+        // compact journal by rewriting the network file if it has grown too large
+        if (journal.size() > compactionRatio * networkFileSize) {
+            save(filename);
+        }
     }
 
     void Network::save(const std::string &networkFilename, const std::string &algorithmFilename) {
@@ -265,9 +645,16 @@ namespace bayesNet {
     }
 
     void Network::observe(const std::string &name, double x) {
-        Node &node = getNode(name);
+        observe(getNodeId(name), x);
+    }
+
+    void Network::observe(size_t node, double x) {
+        if (node >= _nodes.size()) {
+            BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+        }
+
         // get SensorNode from Node instance
-        SensorNode &sensor = getSensor(node);
+        SensorNode &sensor = getSensor(*_nodes[node]);
         // set oberved variable
         sensor.observe(x);
 
@@ -275,6 +662,34 @@ namespace bayesNet {
         _inferenceAlgorithm.init(sensor);
     }
 
+    void Network::observe(const std::pair<size_t, double> *observations, size_t n) {
+        _observed.clear();
+
+        // set oberved variables
+        for (size_t i = 0; i < n; ++i) {
+            if (observations[i].first >= _nodes.size()) {
+                BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+            }
+
+            SensorNode &sensor = getSensor(*_nodes[observations[i].first]);
+            sensor.observe(observations[i].second);
+            _observed.push_back(&sensor);
+        }
+
+        // update inference instance once for all sensors
+        _inferenceAlgorithm.update(_observed);
+    }
+
+    size_t Network::getNodeId(const std::string &name) const {
+        std::unordered_map<std::string, size_t>::const_iterator search = _registry.find(name);
+
+        if (search == _registry.end()) {
+            BAYESNET_THROWE(NODE_NOT_FOUND, name);
+        }
+
+        return search->second;
+    }
+
     void Network::setMembershipFunction(const std::string &name, size_t state, const std::string &mf) {
         Node &node = getNode(name);
         fuzzyLogic::MembershipFunction *instance = fuzzyLogic::membershipFunctions::fromString(mf);
@@ -300,14 +715,97 @@ namespace bayesNet {
 
         // create inference controller instance
         fuzzyLogic::Controller inferenceCtrl(fuzzySets, &node.getFuzzyRules(), 0);
+        CPT cpt;
 
-        // infer cpt
-        CPT cpt = inferenceCtrl.inferCPT();
+        if (_cptCacheDirectory.empty()) {
+            // infer cpt
+            cpt = inferenceCtrl.inferCPT();
+        } else {
+            // look up cpt by content, infer and store it on cache miss
+            cache::CPTCache cptCache(_cptCacheDirectory);
+            inferenceCtrl.plan();
+            uint64_t key = inferenceCtrl.getKey();
+
+            if (!cptCache.load(key, inferenceCtrl.nrJointStates(), cpt)) {
+                cpt = CPT(inferenceCtrl.nrJointStates());
+                inferenceCtrl.inferCPT(cpt, 0, inferenceCtrl.nrConfigurations());
+                cptCache.store(key, cpt);
+            }
+        }
 
         // set cpt for node
         setCPT(name, cpt);
     }
 
+    void Network::setCPTCache(const std::string &directory) {
+        _cptCacheDirectory = directory;
+    }
+
+    void Network::inferCPT(utils::ThreadPool &pool) {
+        size_t nodes = _availableFuzzySets.size();
+        std::vector<std::vector<fuzzyLogic::FuzzySet *> > fuzzySets(nodes);
+        std::vector<std::unique_ptr<fuzzyLogic::Controller> > controllers(nodes);
+        std::vector<CPT> cpts(nodes);
+        std::vector<uint64_t> keys(nodes);
+        std::vector<bool> cached(nodes, false);
+        std::unique_ptr<cache::CPTCache> cptCache;
+
+        if (!_cptCacheDirectory.empty()) {
+            cptCache.reset(new cache::CPTCache(_cptCacheDirectory));
+        }
+
+        // tasks are pairs of node index and first parent configuration
+        std::vector<std::pair<size_t, size_t> > tasks;
+
+        for (size_t i = 0; i < nodes; ++i) {
+            Node &node = getNode(_availableFuzzySets[i]);
+            std::vector<Node *> parents = getParents(node);
+
+            // collect fuzzy sets
+            for (size_t j = 0; j < parents.size(); ++j) {
+                fuzzySets[i].push_back(&parents[j]->getFuzzySet());
+            }
+
+            // prepare controller sequentially, so tasks only read shared state
+            controllers[i].reset(new fuzzyLogic::Controller(fuzzySets[i], &node.getFuzzyRules(), 0));
+            controllers[i]->plan();
+
+            // cached cpts need no tasks
+            if (cptCache) {
+                keys[i] = controllers[i]->getKey();
+                cached[i] = cptCache->load(keys[i], controllers[i]->nrJointStates(), cpts[i]);
+
+                if (cached[i]) {
+                    continue;
+                }
+            }
+
+            cpts[i] = CPT(controllers[i]->nrJointStates());
+
+            for (size_t begin = 0; begin < controllers[i]->nrConfigurations(); begin += fuzzyLogic::Controller::CONFIGURATIONS_PER_TASK) {
+                tasks.push_back(std::make_pair(i, begin));
+            }
+        }
+
+        // infer disjoint ranges of parent configurations
+        pool.parallelFor(tasks.size(), [&controllers, &cpts, &tasks](size_t task) {
+            size_t i = tasks[task].first;
+            size_t begin = tasks[task].second;
+            size_t end = std::min(begin + fuzzyLogic::Controller::CONFIGURATIONS_PER_TASK, controllers[i]->nrConfigurations());
+
+            controllers[i]->inferCPT(cpts[i], begin, end);
+        });
+
+        // set cpts for nodes and store inferred cpts
+        for (size_t i = 0; i < nodes; ++i) {
+            if (cptCache && !cached[i]) {
+                cptCache->store(keys[i], cpts[i]);
+            }
+
+            setCPT(_availableFuzzySets[i], cpts[i]);
+        }
+    }
+
     std::vector<Node *> Network::getParents(Node &node) {
         std::vector<Node *> parents;
 
@@ -335,69 +833,60 @@ namespace bayesNet {
     }
 
     void Network::setFuzzyRules(const std::string &file) {
-        // prepare states
-        fuzzyLogic::RuleState *binaryStates[2]= {
-                FUZZY_STATE(FALSE),
-                FUZZY_STATE(TRUE)
-        };
+        std::vector<file::FuzzyRuleTable> tables = file::FuzzyRuleTable::parse(file);
+
+        for (size_t i = 0; i < tables.size(); ++i) {
+            // get node and its parents in label order
+            Node &node = getNode(tables[i].getName());
+            std::vector<Node *> parents = getParents(node);
+            std::vector<size_t> parentStates(parents.size());
 
-        fuzzyLogic::RuleState *states[4]= {
-                FUZZY_STATE(GOOD),
-                FUZZY_STATE(PROBABLY_GOOD),
-                FUZZY_STATE(PROBABLY_BAD),
-                FUZZY_STATE(BAD)
-        };
+            for (size_t j = 0; j < parents.size(); ++j) {
+                parentStates[j] = parents[j]->nrStates();
+            }
 
-        std::vector<bayesNet::file::FuzzyRuleVector *> v = bayesNet::file::FuzzyRuleVector::parse(file);
+            // map columns of parsed rules to parents
+            const std::vector<std::string> &columns = tables[i].getColumns();
+            std::vector<size_t> parentIndex(columns.size());
 
-        for (size_t i = 0; i < v.size(); ++i) {
-            // get node
-            Node &node = getNode(v[i]->getName());
+            for (size_t j = 0; j < columns.size(); ++j) {
+                Node *parent = &getNode(columns[j]);
+                std::vector<Node *>::const_iterator search = std::find(parents.begin(), parents.end(), parent);
 
-            // setup fuzzy rule set
-            std::vector<bayesNet::fuzzyLogic::Rule *> fuzzyRules;
+                if (search == parents.end()) {
+                    BAYESNET_THROWE(INVALID_FUZZY_RULE, columns[j] + " is no parent of " + node.getName());
+                }
 
-            // iterate over rules
-            std::vector<bayesNet::file::FuzzyRule *> rules = v[i]->getRules();
+                parentIndex[j] = static_cast<size_t>(search - parents.begin());
+            }
 
-            for (size_t j = 0; j < rules.size(); ++j) {
-                std::unordered_map<std::string, size_t> ifClauses = rules[j]->getIfClauses();
-                std::vector<fuzzyLogic::RuleState *> ruleStates;
+            // setup fuzzy rule table with parent states in label order
+            fuzzyLogic::RuleTable table(parentStates, node.nrStates());
+            std::vector<unsigned char> states(parents.size());
 
-                // iterate over hash map and save elements using label in map to sort
-                std::map<size_t, fuzzyLogic::RuleState *> sortedClauses;
+            for (size_t r = 0; r < tables[i].nrRules(); ++r) {
+                std::fill(states.begin(), states.end(), file::FuzzyRuleTable::NO_STATE);
 
-                for (std::unordered_map<std::string, size_t>::const_iterator it = ifClauses.begin(); it != ifClauses.end(); it++) {
-                    Node &parent = getNode(it->first);
+                for (size_t j = 0; j < columns.size(); ++j) {
+                    unsigned char state = tables[i].getState(r, j);
 
-                    if (parent.isBinary()) {
-                        sortedClauses[parent.getDiscrete().label()] = binaryStates[it->second];
-                    } else {
-                        sortedClauses[parent.getDiscrete().label()] = states[it->second];
+                    if (state != file::FuzzyRuleTable::NO_STATE) {
+                        states[parentIndex[j]] = state;
                     }
                 }
 
-                // iterate over sorted map and add rule states
-                for (std::map<size_t, fuzzyLogic::RuleState*>::const_iterator it = sortedClauses.begin(); it != sortedClauses.end(); it++) {
-                    ruleStates.push_back(it->second);
-                }
-
-                // create fuzzy rule from states
-                fuzzyLogic::RuleState *thenState;
-
-                if (node.isBinary()) {
-                    thenState = binaryStates[rules[j]->getThenClause()];
-                } else {
-                    thenState = states[rules[j]->getThenClause()];
+                // each rule needs a state for every parent
+                for (size_t j = 0; j < parents.size(); ++j) {
+                    if (states[j] == file::FuzzyRuleTable::NO_STATE) {
+                        BAYESNET_THROWE(INVALID_FUZZY_RULE, "rule of " + node.getName() + " without state for " + parents[j]->getName());
+                    }
                 }
 
-                fuzzyLogic::Rule *rule = new fuzzyLogic::Rule(ruleStates, thenState);
-                fuzzyRules.push_back(rule);
+                table.addRule(states.data(), tables[i].getThenState(r));
             }
 
             // set fuzzy set for node
-            fuzzyLogic::RuleSet set(fuzzyRules);
-            node.setFuzzyRules(set);
+            node.setFuzzyRules(fuzzyLogic::RuleSet(table));
             _availableFuzzySets.push_back(node.getName());
         }
     }
@@ -449,7 +938,14 @@ namespace bayesNet {
         } else {
             // no algorithm file given, use default
             _inferenceAlgorithm = inference::Algorithm();
-        }   
+        }
+
+        // loaded state equals file state, set by the caller if it was loaded from a file
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            _nodes[i]->clearDirty();
+        }
+
+        _savedFile.clear();
     }
 
     SensorNode &Network::getSensor(Node &node) {
@@ -477,6 +973,24 @@ namespace bayesNet {
         return true;
     }
 
+    void Network::setFuzzyRuleGenerator(const std::string &generatorLogicFile) {
+        // read generator logic
+        file::GeneratorLogic generatorLogic(generatorLogicFile);
+        generatorLogic.parse();
+
+        // apply generated rules to all nodes with parents
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            std::vector<Node *> parents = getParents(*_nodes[i]);
+
+            if (parents.empty()) {
+                continue;
+            }
+
+            _nodes[i]->setFuzzyRules(fuzzyLogic::RuleSet(createRuleGenerator(*_nodes[i], parents, generatorLogic)));
+            _availableFuzzySets.push_back(_nodes[i]->getName());
+        }
+    }
+
     void Network::generateDefaultFuzzyRules(const std::string &file, const std::string &generatorLogicFile) {
         // open file
         std::ofstream fuzzyRuleFile(file);
@@ -485,203 +999,57 @@ namespace bayesNet {
             throw std::runtime_error("cannot write fuzzy rule file");
         }
 
-        // define generator logic
-        // TODO: load from file
-        /*
-        bayesNet::fuzzyLogic::MembershipFunction *mfGood = new bayesNet::fuzzyLogic::membershipFunctions::ZShape(0, 1);
-        bayesNet::fuzzyLogic::MembershipFunction *mfProbablyGood = new bayesNet::fuzzyLogic::membershipFunctions::Triangle(0, 1, 2);
-        bayesNet::fuzzyLogic::MembershipFunction *mfProbablyBad = new bayesNet::fuzzyLogic::membershipFunctions::Triangle(1, 2, 3);
-        bayesNet::fuzzyLogic::MembershipFunction *mfBad = new bayesNet::fuzzyLogic::membershipFunctions::SShape(2, 3);
-
-        bayesNet::fuzzyLogic::FuzzySet *generatorLogic = new bayesNet::fuzzyLogic::FuzzySet(4);
-        generatorLogic->setMembershipFunction(bayesNet::state::GOOD, mfGood);
-        generatorLogic->setMembershipFunction(bayesNet::state::PROBABLY_GOOD, mfProbablyGood);
-        generatorLogic->setMembershipFunction(bayesNet::state::PROBABLY_BAD, mfProbablyBad);
-        generatorLogic->setMembershipFunction(bayesNet::state::BAD, mfBad);
-        */
-        // end generator logic, tbd load from file instead of static define
-
         // read generator logic
         file::GeneratorLogic generatorLogic(generatorLogicFile);
         generatorLogic.parse();
 
-        // write fuzzy rules
-        // iterate over all network nodes
-        for (auto node : _nodes)  {
-            // check if node has any parents
+        // write fuzzy rules of all nodes with parents
+        for (auto node : _nodes) {
             auto parents = getParents(*node);
 
             if (parents.size() > 0) {
-                // get logic for node
-                auto nodeLogic = generatorLogic.getNodeLogic(node->getName());
+                std::vector<std::string> nodeNames;
 
-                // create fuzzy set
-                bayesNet::fuzzyLogic::FuzzySet* generatorFuzzySet;
-                
-                if (node->isBinary()) {
-                    generatorFuzzySet = new fuzzyLogic::FuzzySet(2);
+                for (auto parent : parents) {
+                    nodeNames.push_back(parent->getName());
+                }
 
-                    // get membership functions
-                    auto mfTrue = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::TRUE]);
-                    auto mfFalse = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::FALSE]);
+                createRuleGenerator(*node, parents, generatorLogic)->write(fuzzyRuleFile, node->getName(), nodeNames);
+            }
+        }
 
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::TRUE, mfTrue);
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::FALSE, mfFalse);
-                } else {
-                    generatorFuzzySet = new fuzzyLogic::FuzzySet(4);
-
-                    // get membership functions
-                    auto mfGood = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::GOOD]);
-                    auto mfProbablyGood = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::PROBABLY_GOOD]);
-                    auto mfProbablyBad = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::PROBABLY_BAD]);
-                    auto mfBad = fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state::BAD]);
-
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::GOOD, mfGood);
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::PROBABLY_GOOD, mfProbablyGood);
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::PROBABLY_BAD, mfProbablyBad);
-                    generatorFuzzySet->setMembershipFunction(bayesNet::state::BAD, mfBad);
-                }
+        // close file
+        fuzzyRuleFile.close();
+    }
 
-                // write node header
-                fuzzyRuleFile << node->getName() << " begin\n";
-                
-                // calculate joint states
-                std::vector<size_t> maxStates;
-                std::vector<std::string> nodeNames;
-            
-                for (auto parent : parents) {
-                    if (parent->isBinary()) {
-                        maxStates.push_back(2);
-                    } else {
-                        maxStates.push_back(4);
-                    }
+    std::shared_ptr<fuzzyLogic::RuleGenerator> Network::createRuleGenerator(Node &node, const std::vector<Node *> &parents, file::GeneratorLogic &generatorLogic) {
+        // get logic for node
+        file::NodeLogic *nodeLogic = generatorLogic.getNodeLogic(node.getName());
 
-                    nodeNames.push_back(parent->getName());
-                }
+        if (nodeLogic == nullptr) {
+            BAYESNET_THROWE(INVALID_FUZZY_RULE, "no generator logic for " + node.getName());
+        }
 
-                utils::Counter stateCounter(parents.size(), maxStates);
-                
-                do {
-                    auto currentStates = stateCounter.getCount();
-                    std::string rule("   if ");
-
-                    // calculate quality based on generator logic
-                    // assume node weights of 1 for now
-                    double quality = 0;
-                   
-                    for (size_t i = 0; i < currentStates.size(); i++) {
-                        // get weight for node
-                        auto weight = nodeLogic->weights[nodeNames[i]];
-
-                        rule += nodeNames[i] + "=";
-
-                        if (maxStates[i] == 4) {
-                            // node with 4 states
-                            switch (currentStates[i]) {
-                            case 0: 
-                                rule += "good";
-                                quality += bayesNet::state::GOOD * weight;
-                                break;
-
-                            case 1:
-                                rule += "probably_good";
-                                quality += bayesNet::state::PROBABLY_GOOD * weight;
-                                break;
-
-                            case 2:
-                                rule += "probably_bad";
-                                quality += bayesNet::state::PROBABLY_BAD * weight;
-                                break;
-
-                            case 3:
-                                rule += "bad";
-                                quality += bayesNet::state::BAD * weight;
-                                break;
-                            
-                            default:
-                                break;
-                            }
-                        } else {
-                            // binary node
-                            switch (currentStates[i]) {
-                            case 0:
-                                rule += "true";
-                                quality += bayesNet::state::TRUE * weight;
-                                break;
-
-                            case 1:
-                                rule += "false";
-                                quality += bayesNet::state::FALSE * weight;
-                                break;
-                            
-                            default:
-                                break;
-                            }
-                        }
-
-                        if (i < currentStates.size() - 1) {
-                            rule += " & ";
-                        }
-                    }
+        // collect parent states and weights, missing weights are zero
+        std::vector<size_t> parentStates(parents.size());
+        std::vector<double> weights(parents.size(), 0);
 
-                    std::vector<double> strength = generatorFuzzySet->getStrength(quality / (double)currentStates.size());
-                    size_t max = 0;
+        for (size_t i = 0; i < parents.size(); ++i) {
+            parentStates[i] = parents[i]->nrStates();
+            auto weight = nodeLogic->weights.find(parents[i]->getName());
 
-                    for (size_t i = 1; i < strength.size(); i++) {
-                        if (strength[i] >= strength[max]) {
-                            max = i;
-                        }
-                    }
-                    
-                    if (node->isBinary()) {
-                        switch (max) {
-                        case bayesNet::state::TRUE:
-                            rule += " then true\n";
-                            break;
-
-                        case bayesNet::state::FALSE:
-                            rule += " then false\n";
-                            break;
-                        
-                        default:
-                            break;
-                        }
-                    } else {
-                        switch (max) {
-                        case bayesNet::state::GOOD:
-                            rule += " then good\n";
-                            break;
-
-                        case bayesNet::state::PROBABLY_GOOD:
-                            rule += " then probably_good\n";
-                            break;
-
-                        case bayesNet::state::PROBABLY_BAD:
-                            rule += " then probably_bad\n";
-                            break;
-
-                        case bayesNet::state::BAD:
-                            rule += " then bad\n";
-                            break;
-                        
-                        default:
-                            break;
-                        }
-                    }
-                   
-                    fuzzyRuleFile << rule;
-                } while (stateCounter.countUp());
+            if (weight != nodeLogic->weights.end()) {
+                weights[i] = weight->second;
+            }
+        }
 
-                // write node end
-                fuzzyRuleFile << "end\n\n";
+        // create generator fuzzy set
+        std::shared_ptr<fuzzyLogic::RuleGenerator> generator = std::make_shared<fuzzyLogic::RuleGenerator>(parentStates, weights, node.nrStates());
 
-                // delete generator fuzzy logic
-                delete generatorFuzzySet;
-            } 
+        for (size_t state = 0; state < node.nrStates(); ++state) {
+            generator->getFuzzySet().setMembershipFunction(state, fuzzyLogic::membershipFunctions::fromString(nodeLogic->mf[state]));
         }
-        
 
-        // close file
-        fuzzyRuleFile.close();        
+        return generator;
     }
 }
@@ -2,12 +2,14 @@
 #include <bayesnet/state.h>
 #include <bayesnet/util.h>
 #include <bayesnet/exception.h>
+#include <bayesnet/file.h>
 
 
 namespace bayesNet {
 
     Node::Node(const std::string &name, size_t label, size_t states) : _name(name), _factor(Factor(states)),
-                                                                       _factorGraphIndex(0), _fuzzySet(states) {
+                                                                       _factorGraphIndex(0), _fuzzySet(states),
+                                                                       _cptDirty(false), _fuzzySetDirty(false) {
         _discrete = dai::Var(label, states);
         _conditionalDiscrete = dai::VarSet(_discrete);
     }
@@ -36,11 +38,47 @@ namespace bayesNet {
     }
 
     void Node::setCPT(const CPT &cpt) {
+        const std::vector<double> &previous = _cpt.getProbabilities();
+
+        // only mark as changed if probabilities differ as written to file
+        if (previous.size() != cpt.getProbabilities().size()) {
+            _cptDirty = true;
+        }
+
+        for (size_t i = 0; i < previous.size() && !_cptDirty; ++i) {
+            if (!file::isWrittenEqual(previous[i], cpt.getProbabilities()[i])) {
+                _cptDirty = true;
+            }
+        }
+
         _cpt = cpt;
         Factor &factor = getFactor();
+        const std::vector<double> &probabilities = cpt.getProbabilities();
 
-        for (size_t i = 0; i < cpt.size(); ++i) {
-            factor.set(i, dai::Real(cpt.get(i)));
+        for (size_t i = 0; i < probabilities.size(); ++i) {
+            factor.set(i, dai::Real(probabilities[i]));
+        }
+    }
+
+    void Node::updateCPT(const std::vector<double> &probabilities) {
+        std::vector<double> &cpt = _cpt.getProbabilities();
+
+        // only allocates if the CPT has not been set before
+        if (cpt.size() != probabilities.size()) {
+            cpt.resize(probabilities.size());
+            _cptDirty = true;
+        }
+
+        Factor &factor = getFactor();
+
+        for (size_t i = 0; i < probabilities.size(); ++i) {
+            // only mark as changed if probabilities differ as written to file
+            if (!_cptDirty && !file::isWrittenEqual(cpt[i], probabilities[i])) {
+                _cptDirty = true;
+            }
+
+            cpt[i] = probabilities[i];
+            factor.set(i, dai::Real(probabilities[i]));
         }
     }
 
@@ -73,6 +111,13 @@ namespace bayesNet {
     }
 
     void Node::setMembershipFunction(size_t state, fuzzyLogic::MembershipFunction *mf) {
+        fuzzyLogic::MembershipFunction *current = _fuzzySet.getMembershipFunction(state);
+
+        // only mark as changed if membership function differs
+        if (current == nullptr || mf == nullptr || current->toString() != mf->toString()) {
+            _fuzzySetDirty = true;
+        }
+
         _fuzzySet.setMembershipFunction(state, mf);
     }
 
@@ -88,6 +133,10 @@ namespace bayesNet {
         return _fuzzySet;
     }
 
+    const fuzzyLogic::FuzzySet &Node::getFuzzySet() const {
+        return _fuzzySet;
+    }
+
     fuzzyLogic::RuleSet &Node::getFuzzyRules() {
         return _fuzzyRules;
     }
@@ -108,6 +157,19 @@ namespace bayesNet {
         return _discrete.states() == 2;
     }
 
+    bool Node::isCPTDirty() const {
+        return _cptDirty;
+    }
+
+    bool Node::isFuzzySetDirty() const {
+        return _fuzzySetDirty;
+    }
+
+    void Node::clearDirty() {
+        _cptDirty = false;
+        _fuzzySetDirty = false;
+    }
+
     bool Node::isEvidence() const {
         return _factor.isEvidence();
     }
@@ -122,24 +184,60 @@ namespace bayesNet {
         return os;
     }
 
-    SensorNode::SensorNode(const std::string &name, size_t label, size_t states) : Node(name, label, states) {}
+    SensorNode::SensorNode(const std::string &name, size_t label, size_t states) : Node(name, label, states), _strength(states) {}
 
     SensorNode::~SensorNode() {}
 
     void SensorNode::observe(double x) {
+        mapObservation(x, _strength);
+
+        // overwrite cpt and factor of node
+        updateCPT(_strength);
+    }
+
+    void SensorNode::mapObservation(double x, std::vector<double> &probabilities) const {
         // get state strenth from fuzzy set
-        std::vector<double> strength = getFuzzySet().getStrength(x);
+        probabilities.resize(nrStates());
+        getFuzzySet().getStrength(x, probabilities.data());
 
-        for (size_t i = 0; i < strength.size(); i++) {
-            double belief = strength[i];
+        for (size_t i = 0; i < probabilities.size(); i++) {
+            double belief = probabilities[i];
             int trunc = static_cast<int>(belief * 100);
-            strength[i] = trunc / 100.0;
+            probabilities[i] = trunc / 100.0;
         }
 
-        utils::vectorNormalize(strength);        
+        utils::vectorNormalize(probabilities);
+    }
+
+    void SensorNode::quantizeObservations(const double *xs, size_t n, std::vector<double> &strengths, unsigned char *percents, size_t stride) const {
+        size_t states = nrStates();
+
+        // get state strengths of all observations at once, strength of state s for observation i is at s * n + i
+        strengths.resize(states * n);
+        getFuzzySet().getStrength(xs, n, strengths.data());
+
+        for (size_t i = 0; i < n; i++) {
+            for (size_t s = 0; s < states; s++) {
+                percents[i * stride + s] = static_cast<unsigned char>(static_cast<int>(strengths[s * n + i] * 100));
+            }
+        }
+    }
+
+    void SensorNode::toProbabilities(const unsigned char *percents, size_t states, std::vector<double> &probabilities) {
+        probabilities.resize(states);
+
+        for (size_t i = 0; i < states; i++) {
+            probabilities[i] = percents[i] / 100.0;
+        }
+
+        utils::vectorNormalize(probabilities);
+    }
+
+    void SensorNode::setNoiseModel(const utils::NoiseModel &model) {
+        _noiseModel = model;
+    }
 
-        // set cpt for node
-        CPT cpt(strength);
-        setCPT(cpt);
+    const utils::NoiseModel &SensorNode::getNoiseModel() const {
+        return _noiseModel;
     }
 }
@@ -0,0 +1,399 @@
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+
+#include <bayesnet/pipeline.h>
+#include <bayesnet/exception.h>
+
+
+namespace bayesNet {
+
+    namespace pipeline {
+
+        namespace {
+
+            /// Returns the milliseconds between @a begin and @a end
+            double milliseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+                return std::chrono::duration<double, std::milli>(end - begin).count();
+            }
+        }
+
+        /// Represents a queue of frames between two stages, a capacity of zero means unbounded
+        class FrameQueue {
+        public:
+            explicit FrameQueue(size_t capacity) : _capacity(capacity), _maxLength(0), _closed(false) {}
+
+            /// Moves @a frame into the queue, blocks while the queue is full and returns false if the queue is closed
+            bool push(Frame &frame) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _notFull.wait(lock, [this] { return _closed || _capacity == 0 || _frames.size() < _capacity; });
+
+                if (_closed) {
+                    return false;
+                }
+
+                frame.queued = std::chrono::steady_clock::now();
+                _frames.push_back(std::move(frame));
+                _maxLength = std::max(_maxLength, _frames.size());
+                _notEmpty.notify_one();
+
+                return true;
+            }
+
+            /// Moves the next frame into @a frame, blocks while the queue is empty and returns false if the queue is closed and empty
+            bool pop(Frame &frame) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _notEmpty.wait(lock, [this] { return _closed || !_frames.empty(); });
+
+                if (_frames.empty()) {
+                    return false;
+                }
+
+                frame = std::move(_frames.front());
+                _frames.pop_front();
+                _notFull.notify_one();
+
+                return true;
+            }
+
+            /// Closes the queue, queued frames can still be popped
+            void close() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _notEmpty.notify_all();
+                _notFull.notify_all();
+            }
+
+            /// Returns the maximum number of queued frames
+            size_t maxLength() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _maxLength;
+            }
+
+        private:
+            std::deque<Frame> _frames;
+            size_t _capacity;
+            size_t _maxLength;
+            bool _closed;
+            std::mutex _mutex;
+            std::condition_variable _notEmpty;
+            std::condition_variable _notFull;
+        };
+
+        /// Represents a stage of the pipeline
+        struct Stage {
+            explicit Stage(Network &network) : network(&network), frames(0), latency(0.0), maxLatency(0.0), queueTime(0.0), maxQueueTime(0.0) {}
+
+            /// Stores the network of this stage
+            Network *network;
+
+            /// Stores the names of the sensor nodes observed by this stage, in order of the frame values
+            std::vector<std::string> targets;
+
+            /// Stores the names of the nodes whose beliefs are passed to the next stage
+            std::vector<std::string> sources;
+
+            /// Stores the resolved observations, reused for each frame
+            std::vector<std::pair<size_t, double> > observations;
+
+            /// Stores the stage thread
+            std::thread thread;
+
+            /// Guards the statistics
+            std::mutex mutex;
+
+            /// Stores the number of processed frames
+            size_t frames;
+
+            /// Stores the accumulated latency
+            double latency;
+
+            /// Stores the maximum latency
+            double maxLatency;
+
+            /// Stores the accumulated queue time
+            double queueTime;
+
+            /// Stores the maximum queue time
+            double maxQueueTime;
+
+            /// Stores the time the last frame left this stage
+            std::chrono::steady_clock::time_point finished;
+        };
+
+        Pipeline::Pipeline(size_t capacity) : _capacity(std::max<size_t>(capacity, 1)), _sequence(0), _running(false) {}
+
+        Pipeline::~Pipeline() {
+            // discard queued frames instead of waiting for them
+            for (size_t i = 0; i < _queues.size(); ++i) {
+                _queues[i]->close();
+            }
+
+            join();
+
+            for (size_t i = 0; i < _queues.size(); ++i) {
+                delete _queues[i];
+            }
+
+            for (size_t i = 0; i < _stages.size(); ++i) {
+                delete _stages[i];
+            }
+        }
+
+        size_t Pipeline::addStage(Network &network) {
+            if (_running || !_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "unable to add stage to started pipeline");
+            }
+
+            _stages.push_back(new Stage(network));
+            return _stages.size() - 1;
+        }
+
+        size_t Pipeline::nrStages() const {
+            return _stages.size();
+        }
+
+        size_t Pipeline::addInput(const std::string &sensor) {
+            if (_stages.empty()) {
+                BAYESNET_THROWE(INDEX_OUT_OF_BOUNDS, "pipeline has no stages");
+            }
+
+            if (_running || !_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "unable to add input to started pipeline");
+            }
+
+            _stages[0]->targets.push_back(sensor);
+            return _stages[0]->targets.size() - 1;
+        }
+
+        void Pipeline::link(size_t stage, const std::string &source, const std::string &target) {
+            if (stage + 1 >= _stages.size()) {
+                BAYESNET_THROWE(INDEX_OUT_OF_BOUNDS, "stage " + std::to_string(stage) + " has no next stage");
+            }
+
+            if (_running || !_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "unable to link stages of started pipeline");
+            }
+
+            _stages[stage]->sources.push_back(source);
+            _stages[stage + 1]->targets.push_back(target);
+        }
+
+        size_t Pipeline::addOutput(const std::string &name) {
+            if (_running || !_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "unable to add output to started pipeline");
+            }
+
+            _outputs.push_back(name);
+            return _outputs.size() - 1;
+        }
+
+        void Pipeline::start() {
+            if (_stages.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "pipeline has no stages");
+            }
+
+            if (_running || !_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "pipeline can only be started once");
+            }
+
+            // resolve the observed sensors of each stage, so frames are observed without name lookups
+            for (size_t i = 0; i < _stages.size(); ++i) {
+                Stage &stage = *_stages[i];
+                stage.observations.clear();
+
+                for (size_t j = 0; j < stage.targets.size(); ++j) {
+                    stage.observations.push_back(std::make_pair(stage.network->getNodeId(stage.targets[j]), 0.0));
+                }
+            }
+
+            // the last stage passes the outputs to the unbounded result queue, so stop() never waits for pop()
+            _stages.back()->sources = _outputs;
+
+            for (size_t i = 0; i < _stages.size(); ++i) {
+                _queues.push_back(new FrameQueue(_capacity));
+            }
+
+            _queues.push_back(new FrameQueue(0));
+
+            _started = std::chrono::steady_clock::now();
+            _running = true;
+
+            for (size_t i = 0; i < _stages.size(); ++i) {
+                _stages[i]->finished = _started;
+                _stages[i]->thread = std::thread(&Pipeline::work, this, i);
+            }
+        }
+
+        uint64_t Pipeline::push(const std::vector<double> &values) {
+            rethrow();
+
+            if (!_running) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "pipeline is not running");
+            }
+
+            if (values.size() != _stages[0]->targets.size()) {
+                BAYESNET_THROWE(INDEX_OUT_OF_BOUNDS, "expected " + std::to_string(_stages[0]->targets.size()) + " input values");
+            }
+
+            Frame frame;
+            frame.sequence = _sequence++;
+            frame.values = values;
+            frame.created = std::chrono::steady_clock::now();
+
+            if (!_queues[0]->push(frame)) {
+                // queues are only closed early if a stage failed
+                rethrow();
+            }
+
+            return frame.sequence;
+        }
+
+        bool Pipeline::pop(Frame &frame) {
+            if (_queues.empty()) {
+                BAYESNET_THROWE(INVALID_PIPELINE_STATE, "pipeline is not started");
+            }
+
+            bool popped = _queues.back()->pop(frame);
+            rethrow();
+
+            return popped;
+        }
+
+        void Pipeline::stop() {
+            if (!_running) {
+                return;
+            }
+
+            // stages drain their input queue and close the queue of the next stage
+            _queues[0]->close();
+            join();
+            _running = false;
+
+            rethrow();
+        }
+
+        bool Pipeline::isRunning() const {
+            return _running;
+        }
+
+        StageStatistics Pipeline::getStatistics(size_t stage) const {
+            if (stage >= _stages.size()) {
+                BAYESNET_THROW(INDEX_OUT_OF_BOUNDS);
+            }
+
+            StageStatistics statistics;
+            Stage &s = *_stages[stage];
+            std::lock_guard<std::mutex> lock(s.mutex);
+
+            statistics.frames = s.frames;
+            statistics.meanLatency = s.frames > 0 ? s.latency / s.frames : 0.0;
+            statistics.maxLatency = s.maxLatency;
+            statistics.meanQueueTime = s.frames > 0 ? s.queueTime / s.frames : 0.0;
+            statistics.maxQueueTime = s.maxQueueTime;
+            statistics.maxQueueLength = stage < _queues.size() ? _queues[stage]->maxLength() : 0;
+
+            return statistics;
+        }
+
+        double Pipeline::getThroughput() const {
+            if (_stages.empty()) {
+                return 0.0;
+            }
+
+            Stage &last = *_stages.back();
+            std::lock_guard<std::mutex> lock(last.mutex);
+            double elapsed = milliseconds(_started, last.finished);
+
+            return elapsed > 0.0 ? last.frames * 1000.0 / elapsed : 0.0;
+        }
+
+        void Pipeline::work(size_t index) {
+            Stage &stage = *_stages[index];
+            FrameQueue &input = *_queues[index];
+            FrameQueue &output = *_queues[index + 1];
+            Frame frame;
+
+            try {
+                while (input.pop(frame)) {
+                    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+                    // observe all values at once, so the inference instance is updated only once
+                    for (size_t i = 0; i < stage.observations.size(); ++i) {
+                        stage.observations[i].second = frame.values[i];
+                    }
+
+                    stage.network->observe(stage.observations.data(), stage.observations.size());
+                    stage.network->run();
+
+                    // replace the frame values by the beliefs passed on
+                    frame.values.resize(stage.sources.size());
+
+                    for (size_t i = 0; i < stage.sources.size(); ++i) {
+                        frame.values[i] = stage.network->getContinousBelief(stage.sources[i]);
+                    }
+
+                    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+                    // update statistics
+                    {
+                        std::lock_guard<std::mutex> lock(stage.mutex);
+                        double latency = milliseconds(begin, end);
+                        double queueTime = milliseconds(frame.queued, begin);
+
+                        stage.frames++;
+                        stage.latency += latency;
+                        stage.maxLatency = std::max(stage.maxLatency, latency);
+                        stage.queueTime += queueTime;
+                        stage.maxQueueTime = std::max(stage.maxQueueTime, queueTime);
+                        stage.finished = end;
+                    }
+
+                    if (!output.push(frame)) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+
+            output.close();
+        }
+
+        void Pipeline::fail(std::exception_ptr exception) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                if (!_exception) {
+                    _exception = exception;
+                }
+            }
+
+            for (size_t i = 0; i < _queues.size(); ++i) {
+                _queues[i]->close();
+            }
+        }
+
+        void Pipeline::join() {
+            for (size_t i = 0; i < _stages.size(); ++i) {
+                if (_stages[i]->thread.joinable()) {
+                    _stages[i]->thread.join();
+                }
+            }
+        }
+
+        void Pipeline::rethrow() {
+            std::exception_ptr exception;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                exception = _exception;
+            }
+
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+}
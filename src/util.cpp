@@ -1,4 +1,7 @@
 #include <sstream>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
 #include <dirent.h>
 
 #include <bayesnet/util.h>
@@ -57,6 +60,123 @@ namespace bayesNet {
             return c == ' ' || c == '"';
         }
 
+        bool readFile(const std::string &name, std::string &content) {
+            std::ifstream file(name, std::ios::binary | std::ios::ate);
+
+            if (!file.is_open()) {
+                return false;
+            }
+
+            // read whole file at once
+            std::streamoff size = file.tellg();
+            content.resize(static_cast<size_t>(size));
+            file.seekg(0);
+            file.read(&content[0], size);
+
+            return file.good() || size == 0;
+        }
+
+        namespace {
+            const uint64_t HASH_PRIME_1 = 0x9e3779b185ebca87ULL;
+            const uint64_t HASH_PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+
+            inline uint64_t rotateLeft(uint64_t x, int r) {
+                return (x << r) | (x >> (64 - r));
+            }
+
+            inline uint64_t mixLane(uint64_t lane, uint64_t word) {
+                lane += word * HASH_PRIME_2;
+                lane = rotateLeft(lane, 31);
+                return lane * HASH_PRIME_1;
+            }
+        }
+
+        uint64_t hash(const void *data, size_t size, uint64_t seed) {
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+            const unsigned char *end = bytes + size;
+
+            uint64_t lanes[4] = {
+                seed + HASH_PRIME_1 + HASH_PRIME_2,
+                seed + HASH_PRIME_2,
+                seed,
+                seed - HASH_PRIME_1
+            };
+
+            // consume 32 byte blocks in four independent lanes
+            while (end - bytes >= 32) {
+                for (size_t i = 0; i < 4; ++i) {
+                    uint64_t word;
+                    std::memcpy(&word, bytes + 8 * i, 8);
+                    lanes[i] = mixLane(lanes[i], word);
+                }
+
+                bytes += 32;
+            }
+
+            // merge lanes
+            uint64_t h = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+            h += static_cast<uint64_t>(size);
+
+            // consume remaining words and bytes
+            while (end - bytes >= 8) {
+                uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                h = rotateLeft(h ^ mixLane(0, word), 27) * HASH_PRIME_1 + HASH_PRIME_2;
+                bytes += 8;
+            }
+
+            while (bytes < end) {
+                h = rotateLeft(h ^ (*bytes * HASH_PRIME_2), 11) * HASH_PRIME_1;
+                bytes++;
+            }
+
+            // final avalanche
+            h ^= h >> 33;
+            h *= HASH_PRIME_2;
+            h ^= h >> 29;
+            h *= HASH_PRIME_1;
+            h ^= h >> 32;
+
+            return h;
+        }
+
+        uint64_t hash(const std::string &s, uint64_t seed) {
+            return hash(s.data(), s.size(), seed);
+        }
+
+        NoiseModel::NoiseModel(Type type, double scale, double bias) : _type(type), _scale(scale), _bias(bias) {}
+
+        NoiseModel::~NoiseModel() {}
+
+        NoiseModel::Type NoiseModel::getType() const {
+            return _type;
+        }
+
+        double NoiseModel::getScale() const {
+            return _scale;
+        }
+
+        double NoiseModel::getBias() const {
+            return _bias;
+        }
+
+        double NoiseModel::sample(double x, std::mt19937_64 &rng) const {
+            switch (_type) {
+                case GAUSSIAN: {
+                    std::normal_distribution<double> distribution(0.0, 1.0);
+                    return x + _bias + _scale * distribution(rng);
+                }
+
+                case UNIFORM: {
+                    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+                    return x + _bias + _scale * distribution(rng);
+                }
+
+                default:
+                    return x + _bias;
+            }
+        }
+
         Counter::Counter(size_t digits, const std::vector<size_t> &states) : _count(digits), _states(states), _increment(0) {}
 
         Counter::~Counter() {}
@@ -114,5 +234,203 @@ namespace bayesNet {
 
             return maxIncrement;
         }
+
+        Odometer::Odometer(const std::vector<size_t> &radices) : _digits(radices.size()), _radices(radices),
+                                                                 _strides(radices.size()), _size(1), _position(0), _index(0) {
+            // default strides address the configurations in order
+            for (size_t i = 0; i < radices.size(); ++i) {
+                _strides[i] = _size;
+                _size *= radices[i];
+            }
+
+            _end = _size;
+        }
+
+        Odometer::Odometer(const std::vector<size_t> &radices, const std::vector<size_t> &strides)
+                : _digits(radices.size()), _radices(radices), _strides(strides), _size(1), _position(0), _index(0) {
+            if (strides.size() != radices.size()) {
+                BAYESNET_THROWE(INDEX_OUT_OF_BOUNDS, "expected one stride per digit");
+            }
+
+            for (size_t i = 0; i < radices.size(); ++i) {
+                _size *= radices[i];
+            }
+
+            _end = _size;
+        }
+
+        Odometer::~Odometer() {}
+
+        void Odometer::range(size_t begin, size_t end) {
+            _end = std::min(end, _size);
+            seek(std::min(begin, _end));
+        }
+
+        void Odometer::seek(size_t position) {
+            _position = position;
+            _index = 0;
+
+            // split position into digits, least significant digit first
+            for (size_t i = 0; i < _digits.size(); ++i) {
+                _digits[i] = position % _radices[i];
+                position /= _radices[i];
+                _index += _digits[i] * _strides[i];
+            }
+        }
+
+        bool Odometer::next() {
+            if (_position >= _end) {
+                return false;
+            }
+
+            _position++;
+
+            // carry into the next digit only on overflow
+            for (size_t i = 0; i < _digits.size(); ++i) {
+                _index += _strides[i];
+
+                if (++_digits[i] < _radices[i]) {
+                    break;
+                }
+
+                _index -= _strides[i] * _radices[i];
+                _digits[i] = 0;
+            }
+
+            return _position < _end;
+        }
+
+        bool Odometer::valid() const {
+            return _position < _end;
+        }
+
+        size_t Odometer::getPosition() const {
+            return _position;
+        }
+
+        size_t Odometer::getIndex() const {
+            return _index;
+        }
+
+        const std::vector<size_t> &Odometer::getDigits() const {
+            return _digits;
+        }
+
+        size_t Odometer::getStride(size_t digit) const {
+            return _strides[digit];
+        }
+
+        size_t Odometer::size() const {
+            return _size;
+        }
+
+        ThreadPool::ThreadPool(size_t threads) : _body(nullptr), _size(0), _next(0), _active(0), _generation(0), _stop(false) {
+            if (threads == 0) {
+                threads = std::thread::hardware_concurrency();
+            }
+
+            // the calling thread is the first thread of the pool
+            for (size_t i = 1; i < threads; ++i) {
+                _workers.push_back(std::thread(&ThreadPool::work, this));
+            }
+        }
+
+        ThreadPool::~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+
+            _wake.notify_all();
+
+            for (size_t i = 0; i < _workers.size(); ++i) {
+                _workers[i].join();
+            }
+        }
+
+        size_t ThreadPool::size() const {
+            return _workers.size() + 1;
+        }
+
+        void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)> &body) {
+            std::lock_guard<std::mutex> loopLock(_loopMutex);
+
+            // publish loop
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _body = &body;
+                _size = n;
+                _next = 0;
+                _exception = nullptr;
+                _generation++;
+            }
+
+            _wake.notify_all();
+
+            // participate and wait for workers to leave the loop
+            run();
+
+            std::exception_ptr exception;
+
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _done.wait(lock, [this] { return _active == 0; });
+                _body = nullptr;
+                exception = _exception;
+            }
+
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        void ThreadPool::work() {
+            size_t generation = 0;
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            while (true) {
+                _wake.wait(lock, [this, generation] { return _stop || _generation != generation; });
+
+                if (_stop) {
+                    return;
+                }
+
+                generation = _generation;
+
+                // a loop finished before this worker woke up has no indices left
+                if (_body == nullptr) {
+                    continue;
+                }
+
+                _active++;
+                lock.unlock();
+                run();
+                lock.lock();
+
+                if (--_active == 0) {
+                    _done.notify_all();
+                }
+            }
+        }
+
+        void ThreadPool::run() {
+            const std::function<void(size_t)> &body = *_body;
+            size_t n = _size;
+
+            for (size_t i = _next++; i < n; i = _next++) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+
+                    if (!_exception) {
+                        _exception = std::current_exception();
+                    }
+
+                    // skip remaining indices
+                    _next = n;
+                }
+            }
+        }
     }
 }
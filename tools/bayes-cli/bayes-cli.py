@@ -3,6 +3,7 @@
 import sys
 import argparse
 import json
+import struct
 import websockets
 import asyncio
 
@@ -13,6 +14,8 @@ async def main():
     parser.add_argument('PORT', type=int, help='websocket port to connect to')
     parser.add_argument('-s', '--script', action='store', dest='SCRIPT', type=str, help='script file to load')
     parser.add_argument('-c', '--command', action='store', dest='COMMAND', type=str, help='execute single command and disconnect')
+    parser.add_argument('-b', '--batch', action='store_true', dest='BATCH', help='send consecutive evidence and belief lines of the script as one batch')
+    parser.add_argument('-B', '--binary', action='store_true', dest='BINARY', help='use the binary protocol instead of json')
 
     # parse arguments
     args = parser.parse_args()
@@ -21,8 +24,14 @@ async def main():
     host = args.HOST
     script = args.SCRIPT
     command = args.COMMAND
+    batch = args.BATCH
     interactiveShell = False
 
+    # node handles are negotiated by load_network or attach_session
+    if args.BINARY:
+        global binary
+        binary = {"nodes": [], "handles": {}}
+
     # check if interactive shell should be spawned
     if script == None:
         interactiveShell = True
@@ -54,8 +63,11 @@ async def main():
                 lines = file.readlines()
 
                 # process file
-                for index, line in enumerate(lines):
-                    await execute(ws, line, index + 1)
+                if batch:
+                    await execute_grouped(ws, lines)
+                else:
+                    for index, line in enumerate(lines):
+                        await execute(ws, line, index + 1)
 
     except ConnectionRefusedError:
         print(f"Error connecting to websocket (ws://{host}:{port}). Make sure the BayesServer is running.")
@@ -92,6 +104,46 @@ async def execute(ws, cmd, index = None):
         print(' '.join(s[1:]))
         return
 
+    # evidence and belief commands are sent as binary batch of one operation
+    if binary != None and parse_operation(s) != None:
+        await send_batch(ws, [parse_operation(s)])
+        return
+
+    # process subscriptions of several nodes, unsubscribe without nodes removes all
+    if s[0] == "subscribe" and len(s) > 1:
+        await subscribe(ws, s[1:])
+        return
+
+    if s[0] == "unsubscribe":
+        await unsubscribe(ws, s[1:])
+        return
+
+    # set when the session applies inference
+    if s[0] == "set_schedule" and len(s) == 2:
+        await set_schedule(ws, s[1])
+        return
+
+    # print server metrics
+    if s[0] == "stats" and len(s) == 1:
+        await stats(ws)
+        return
+
+    # print pushed beliefs for some seconds
+    if s[0] == "wait" and len(s) == 2:
+        await wait(ws, float(s[1]))
+        return
+
+    # process batch of operations separated by ';'
+    if s[0] == "batch" and len(s) > 1:
+        operations = [parse_operation(op.strip().split(' ')) for op in ' '.join(s[1:]).split(';') if op.strip() != ""]
+
+        if None in operations:
+            print_error(cmd, index)
+        else:
+            await send_batch(ws, operations)
+
+        return
+
     # process commands with single argument
     if len(s) == 2:
         if s[0] == "load_network":
@@ -106,11 +158,23 @@ async def execute(ws, cmd, index = None):
             await get_belief(ws, s[1])
             return
 
+        if s[0] == "attach_session":
+            await attach_session(ws, s[1])
+            return
+
+        if s[0] == "close_session":
+            await close_session(ws, s[1])
+            return
+
         # unknown command
         print_error(cmd, index)
 
     # process commands with 2 arguments
     elif len(s) == 3:
+        if s[0] == "load_network":
+            await load_network(ws, s[1], s[2])
+            return
+
         if s[0] == "set_evidence":
             await set_evidence(ws, s[1], int(s[2]))
             return
@@ -122,27 +186,443 @@ async def execute(ws, cmd, index = None):
         # unknown command
         print_error(cmd, index)
 
+    # process sweep with range and at least one target
+    elif len(s) >= 6 and s[0] == "sweep":
+        await sweep(ws, s[1], float(s[2]), float(s[3]), int(s[4]), s[5:])
+        return
+
     else:
         # unknown command
         print_error(cmd, index)
 
 
-async def load_network(ws, file):
+def parse_operation(s):
+    # returns the batch operation of a split command or None if the command can not be batched
+    if len(s) == 2 and s[0] in ("clear_evidence", "get_belief"):
+        return {"action": s[0], "node": s[1]}
+
+    if len(s) == 3 and s[0] == "set_evidence":
+        return {"action": s[0], "node": s[1], "state": int(s[2])}
+
+    if len(s) == 3 and s[0] == "observe":
+        return {"action": s[0], "node": s[1], "value": float(s[2])}
+
+    return None
+
+
+async def execute_grouped(ws, lines):
+    # group evidence changes followed by belief reads, so each group reads the beliefs after its own changes
+    operations = []
+
+    for index, line in enumerate(lines):
+        cmd = line.strip()
+
+        # ignore empty lines and comments
+        if cmd == "" or cmd[0] == ';':
+            continue
+
+        operation = parse_operation(cmd.split(' '))
+
+        # lines which can not be batched are executed after the pending group
+        if operation == None:
+            if operations:
+                await send_batch(ws, operations)
+                operations = []
+
+            await execute(ws, line, index + 1)
+            continue
+
+        # an evidence change after a belief read starts a new group
+        if operation['action'] != "get_belief" and operations and operations[-1]['action'] == "get_belief":
+            await send_batch(ws, operations)
+            operations = []
+
+        operations.append(operation)
+
+    if operations:
+        await send_batch(ws, operations)
+
+
+async def send_batch(ws, operations):
+    if binary != None:
+        await send_binary_batch(ws, operations)
+        return
+
+    data = {
+        "action": "batch",
+        "payload": {
+            "operations": operations
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+    else:
+        # print beliefs in order of the operations
+        for operation in operations:
+            if operation['action'] == "get_belief":
+                print(data['payload']['beliefs'][operation['node']])
+
+
+# state of the binary protocol, None if json is used
+binary = None
+
+# binary protocol, see the README for the message layout
+BINARY_VERSION = 1
+OPCODES = {"load_network": 1, "attach_session": 2, "close_session": 3, "set_evidence": 4, "clear_evidence": 5, "observe": 6, "get_belief": 7, "batch": 8, "cancel": 9, "subscribe": 10, "unsubscribe": 11, "update": 12}
+OPERATIONS = {"set_evidence": 0, "clear_evidence": 1, "observe": 2, "get_belief": 3}
+
+
+def encode_string(value):
+    data = value.encode('utf-8')
+    return struct.pack('<H', len(data)) + data
+
+
+def encode_message(opcode, request_id, payload = b''):
+    return struct.pack('<BBHI', BINARY_VERSION, opcode, 0, request_id) + payload
+
+
+def decode_message(data):
+    # returns opcode, status, request id and payload of a message
+    version, opcode, status, request_id = struct.unpack_from('<BBHI', data, 0)
+
+    if version != BINARY_VERSION:
+        raise ValueError(f"unsupported protocol version {version}")
+
+    return opcode, status, request_id, data[8:]
+
+
+def decode_string(data, offset):
+    # returns the string at offset and the offset after it
+    (size,) = struct.unpack_from('<H', data, offset)
+    return data[offset + 2:offset + 2 + size].decode('utf-8'), offset + 2 + size
+
+
+def decode_nodes(payload):
+    # returns name, number of states and sensor flag of each node, the list index is the node handle
+    (count,) = struct.unpack_from('<I', payload, 0)
+    offset = 4
+    nodes = []
+
+    for _ in range(count):
+        name, offset = decode_string(payload, offset)
+        states, sensor = struct.unpack_from('<BB', payload, offset)
+        offset += 2
+        nodes.append((name, states, sensor != 0))
+
+    return nodes
+
+
+def decode_update(payload):
+    # returns the beliefs of an update by node name, skipping the evidence versions
+    (count,) = struct.unpack_from('<I', payload, 16)
+    offset = 20
+    beliefs = {}
+
+    for _ in range(count):
+        (handle,) = struct.unpack_from('<I', payload, offset)
+        name, states, sensor = binary['nodes'][handle]
+        beliefs[name] = to_belief(list(struct.unpack_from(f'<{states}d', payload, offset + 4)))
+        offset += 4 + 8 * states
+
+    return beliefs
+
+
+def decode_versions(payload):
+    # returns the evidence version beliefs reflect and the evidence version of the session
+    return struct.unpack_from('<QQ', payload, 0)
+
+
+def decode_beliefs(payload):
+    # returns the packed belief values
+    (count,) = struct.unpack_from('<I', payload, 16)
+    return list(struct.unpack_from(f'<{count}d', payload, 20))
+
+
+def to_belief(values):
+    # same representation as the json protocol
+    if len(values) == 2:
+        belief = {"FALSE": values[0], "TRUE": values[1]}
+    else:
+        belief = {"GOOD": values[0], "PROBABLY_GOOD": values[1], "PROBABLY_BAD": values[2], "BAD": values[3]}
+
+    continous = sum(value * i for i, value in enumerate(values)) * 2.0 / (len(values) - 1) - 1
+
+    # non binary nodes range from the best state to the worst
+    if len(values) != 2:
+        continous *= -1
+
+    belief["continious_belief"] = f"{continous:f}"
+
+    return belief
+
+
+def set_nodes(nodes):
+    binary['nodes'] = nodes
+    binary['handles'] = {name: handle for handle, (name, states, sensor) in enumerate(nodes)}
+
+
+async def send_binary(ws, opcode, payload):
+    # returns the payload of the response or None on error
+    await ws.send(encode_message(opcode, 0, payload))
+    opcode, status, request_id, payload = decode_message(await receive(ws))
+
+    if status != 0:
+        message, _ = decode_string(payload, 0)
+        print(f"error: {message}")
+        return None
+
+    return payload
+
+
+async def send_binary_batch(ws, operations):
+    payload = struct.pack('<I', len(operations))
+
+    for operation in operations:
+        if operation['node'] not in binary['handles']:
+            print(f"error: unknown node {operation['node']}")
+            return
+
+        value = operation.get('state', operation.get('value', 0))
+        payload += struct.pack('<BId', OPERATIONS[operation['action']], binary['handles'][operation['node']], value)
+
+    payload = await send_binary(ws, OPCODES['batch'], payload)
+
+    if payload == None:
+        return
+
+    # split the packed values by the number of states of each node
+    values = decode_beliefs(payload)
+    offset = 0
+
+    for operation in operations:
+        if operation['action'] == "get_belief":
+            states = binary['nodes'][binary['handles'][operation['node']]][1]
+            print(to_belief(values[offset:offset + states]))
+            offset += states
+
+
+def print_update(message):
+    # prints the beliefs pushed to subscribers
+    if isinstance(message, bytes):
+        beliefs = decode_update(decode_message(message)[3])
+    else:
+        beliefs = json.loads(message)['payload']['beliefs']
+
+    for node, belief in beliefs.items():
+        print(f"update {node}: {belief}")
+
+
+def is_update(message):
+    if isinstance(message, bytes):
+        return decode_message(message)[0] == OPCODES['update']
+
+    return json.loads(message)['action'] == "update"
+
+
+async def receive(ws):
+    # returns the next response, printing the pushed beliefs received before
+    while True:
+        message = await ws.recv()
+
+        if not is_update(message):
+            return message
+
+        print_update(message)
+
+
+async def wait(ws, seconds):
+    # prints the beliefs pushed within the given time
+    loop = asyncio.get_running_loop()
+    end = loop.time() + seconds
+
+    while loop.time() < end:
+        try:
+            message = await asyncio.wait_for(ws.recv(), end - loop.time())
+        except asyncio.TimeoutError:
+            break
+
+        print_update(message)
+
+
+async def subscribe(ws, nodes):
+    if binary != None:
+        if any(node not in binary['handles'] for node in nodes):
+            print("error: unknown node")
+            return
+
+        payload = struct.pack(f'<ddI{len(nodes)}I', 0.001, 20.0, len(nodes), *[binary['handles'][node] for node in nodes])
+        payload = await send_binary(ws, OPCODES['subscribe'], payload)
+
+        if payload != None:
+            for node, belief in decode_update(payload).items():
+                print(f"{node}: {belief}")
+
+        return
+
+    data = {
+        "action": "subscribe",
+        "payload": {
+            "nodes": nodes
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+    else:
+        for node, belief in data['payload']['beliefs'].items():
+            print(f"{node}: {belief}")
+
+
+async def unsubscribe(ws, nodes):
+    if binary != None:
+        if any(node not in binary['handles'] for node in nodes):
+            print("error: unknown node")
+            return
+
+        await send_binary(ws, OPCODES['unsubscribe'], struct.pack(f'<I{len(nodes)}I', len(nodes), *[binary['handles'][node] for node in nodes]))
+        return
+
+    data = {
+        "action": "unsubscribe",
+        "payload": {
+            "nodes": nodes
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+
+
+async def set_schedule(ws, schedule):
+    data = {
+        "action": "set_schedule",
+        "payload": {
+            "schedule": schedule
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+
+
+async def stats(ws):
+    data = {
+        "action": "stats",
+        "payload": {}
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+        return
+
+    print("action,count,errors,p50_us,p99_us,p999_us,max_us")
+
+    for name, action in sorted(data['payload']['actions'].items()):
+        print(f"{name},{action['count']:.0f},{action['errors']:.0f},{action['p50_us']},{action['p99_us']},{action['p999_us']},{action['max_us']}")
+
+    for name, value in sorted(data['payload']['gauges'].items()):
+        print(f"{name}: {value:g}")
+
+
+async def load_network(ws, file, session = None):
+    if binary != None:
+        payload = await send_binary(ws, OPCODES['load_network'], encode_string(file) + encode_string(session or ""))
+
+        if payload != None:
+            set_nodes(decode_nodes(payload))
+
+        return
+
     data = {
         "action": "load_network",
         "payload": {
             "file": file
         }
     }
+
+    # named sessions can be attached by other clients
+    if session != None:
+        data['payload']['session'] = session
     
     await ws.send(json.dumps(data))
-    result = await ws.recv()
+    result = await receive(ws)
     
     data = json.loads(result)
     
     if data['payload']['status'] != 'success':
         print(f"error: {data['payload']['error']}")
 
+async def attach_session(ws, session):
+    if binary != None:
+        payload = await send_binary(ws, OPCODES['attach_session'], encode_string(session))
+
+        if payload != None:
+            set_nodes(decode_nodes(payload))
+
+        return
+
+    data = {
+        "action": "attach_session",
+        "payload": {
+            "session": session
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+
+
+async def close_session(ws, session):
+    if binary != None:
+        await send_binary(ws, OPCODES['close_session'], encode_string(session))
+        return
+
+    data = {
+        "action": "close_session",
+        "payload": {
+            "session": session
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+
 async def set_evidence(ws, node, state):
     data = {
         "action": "set_evidence",
@@ -153,7 +633,7 @@ async def set_evidence(ws, node, state):
     }
 
     await ws.send(json.dumps(data))
-    result = await ws.recv()
+    result = await receive(ws)
     
     data = json.loads(result)
     
@@ -170,7 +650,7 @@ async def clear_evidence(ws, node):
     }
 
     await ws.send(json.dumps(data))
-    result = await ws.recv()
+    result = await receive(ws)
 
     data = json.loads(result)
     
@@ -188,7 +668,7 @@ async def observe(ws, node, value):
     }
 
     await ws.send(json.dumps(data))
-    result = await ws.recv()
+    result = await receive(ws)
     
     data = json.loads(result)
     
@@ -205,7 +685,7 @@ async def get_belief(ws, node):
     }
 
     await ws.send(json.dumps(data))
-    result = await ws.recv()
+    result = await receive(ws)
 
     data = json.loads(result)
     
@@ -215,5 +695,36 @@ async def get_belief(ws, node):
         print(data['payload'][node])
 
 
+
+async def sweep(ws, node, start, end, steps, targets):
+    # sample the range including both ends
+    values = [start + (end - start) * i / (steps - 1) if steps > 1 else start for i in range(steps)]
+
+    data = {
+        "action": "sweep",
+        "payload": {
+            "node": node,
+            "values": values,
+            "targets": targets
+        }
+    }
+
+    await ws.send(json.dumps(data))
+    result = await receive(ws)
+
+    data = json.loads(result)
+
+    if data['payload']['status'] != 'success':
+        print(f"error: {data['payload']['error']}")
+    else:
+        # print beliefs as csv, one row per value
+        beliefs = data['payload']['beliefs']
+        header = [node] + [f"{target}:{state}" for target in targets for state in range(len(beliefs[target][0]) if beliefs[target] else 0)]
+        print(','.join(header))
+
+        for i, value in enumerate(values):
+            print(','.join([str(value)] + [str(belief) for target in targets for belief in beliefs[target][i]]))
+
+
 if __name__ == '__main__':
     asyncio.run(main())
\ No newline at end of file
@@ -0,0 +1,122 @@
+/// @file
+/// @brief BayesNet CLI, used to sweep a sensor value or evidence state of a node and write the resulting beliefs as CSV or binary matrix
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+#include <bayesnet/network.h>
+#include <bayesnet/util.h>
+
+int main(int argc, char **argv) {
+    // split arguments into options and positional arguments
+    std::vector<std::string> args;
+    std::string outputFile;
+    std::string cacheDirectory;
+    bool binary = false;
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+
+        if (arg == "-b" || arg == "--binary") {
+            binary = true;
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.size() >= 6 && (!binary || !outputFile.empty())) {
+        std::string networkFile(args[0]);
+        std::string node(args[1]);
+        double from = std::stod(args[2]);
+        double to = std::stod(args[3]);
+        size_t steps = static_cast<size_t>(std::stoul(args[4]));
+        std::vector<std::string> targets(args.begin() + 5, args.end());
+
+        // sample the range including both ends
+        std::vector<double> values;
+
+        for (size_t i = 0; i < steps; i++) {
+            values.push_back(steps > 1 ? from + (to - from) * i / (steps - 1) : from);
+        }
+
+        // create network instance, a warm cache skips parsing and the junction tree construction
+        std::unique_ptr<bayesNet::Network> network(cacheDirectory.empty() ? new bayesNet::Network(networkFile) : new bayesNet::Network(networkFile, cacheDirectory));
+        network->init();
+
+        // evaluate all values
+        bayesNet::utils::ThreadPool pool(threads);
+        bayesNet::inference::BeliefMatrix matrix = network->sweep(node, values, targets, pool);
+
+        if (binary) {
+            // header of row and column count, followed by rows of the swept value and its beliefs as doubles
+            std::ofstream file(outputFile, std::ios::binary | std::ios::trunc);
+            uint64_t rows = matrix.rows;
+            uint64_t columns = matrix.columns + 1;
+
+            file.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+            file.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+
+            for (size_t i = 0; i < matrix.rows; i++) {
+                file.write(reinterpret_cast<const char *>(&values[i]), sizeof(double));
+                file.write(reinterpret_cast<const char *>(matrix.values.data() + i * matrix.columns), static_cast<std::streamsize>(matrix.columns * sizeof(double)));
+            }
+
+            if (!file) {
+                std::cerr << "Unable to write file " << outputFile << std::endl;
+                return 1;
+            }
+        } else {
+            std::ofstream file;
+
+            if (!outputFile.empty()) {
+                file.open(outputFile, std::ios::trunc);
+            }
+
+            std::ostream &os = outputFile.empty() ? std::cout : file;
+            os.precision(17);
+
+            // header of swept node and target states
+            os << node;
+
+            for (size_t t = 0; t < targets.size(); t++) {
+                size_t end = t + 1 < targets.size() ? matrix.offsets[t + 1] : matrix.columns;
+
+                for (size_t s = 0; s < end - matrix.offsets[t]; s++) {
+                    os << "," << targets[t] << ":" << s;
+                }
+            }
+
+            os << std::endl;
+
+            for (size_t i = 0; i < matrix.rows; i++) {
+                os << values[i];
+
+                for (size_t j = 0; j < matrix.columns; j++) {
+                    os << "," << matrix.values[i * matrix.columns + j];
+                }
+
+                os << std::endl;
+            }
+        }
+    } else {
+        std::cout << "BeliefSweep is a tool to evaluate beliefs for a range of sensor values or evidence states of a node" << std::endl << std::endl;
+        std::cout << "Usage:   " << "belief_sweep [options] <network_file> <node> <from> <to> <steps> <target> [<target> ...]" << std::endl << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  -o, --output <file>  write the beliefs to file instead of stdout" << std::endl;
+        std::cout << "  -b, --binary         write a binary matrix instead of CSV, requires --output" << std::endl;
+        std::cout << "  -j, --threads <n>    evaluate using n threads, 0 uses all available cores (default 0)" << std::endl;
+        std::cout << "  -c, --cache <dir>    load the compiled network from and store it to the cache directory dir" << std::endl;
+    }
+
+    return 0;
+}
@@ -2,47 +2,108 @@
 /// @brief BayesNet CLI, used to infer the network´s CPTs from a given network file and rules file
 
 #include <iostream>
+#include <vector>
+#include <memory>
 
 #include <bayesnet/network.h>
+#include <bayesnet/util.h>
 
 int main(int argc, char **argv) {
-    if (argc > 3 && argc <= 4) {
-        std::string networkFile(argv[1]);
-        std::string ruleFile(argv[2]);
+    // split arguments into options and positional arguments
+    std::vector<std::string> args;
+    std::string generatorFile;
+    std::string cacheDirectory;
+    std::string networkCacheDirectory;
+    bool incremental = false;
+    size_t threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+
+        if (arg == "-i" || arg == "--incremental") {
+            incremental = true;
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if ((arg == "-g" || arg == "--generator") && i + 1 < argc) {
+            generatorFile = argv[++i];
+        } else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else if ((arg == "-n" || arg == "--network-cache") && i + 1 < argc) {
+            networkCacheDirectory = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    // rules are either read from a rule file or generated from the generator logic
+    size_t ruleArgs = generatorFile.empty() ? 1 : 0;
+
+    if (args.size() >= 1 + ruleArgs && args.size() <= 2 + ruleArgs) {
+        std::string networkFile(args[0]);
+        std::string ruleFile(ruleArgs > 0 ? args[1] : generatorFile);
         std::string destFile;
 
-        if (argc == 4) {
-            destFile = std::string(argv[3]);
+        if (args.size() == 2 + ruleArgs) {
+            destFile = args[1 + ruleArgs];
         }
 
         std::cout << "Inferring CPTs using following arguments" << std::endl;
         std::cout << "Network >> " << networkFile << std::endl;
-        std::cout << "Fuzzy rules >> " << ruleFile << std::endl << std::endl;
+        std::cout << (ruleArgs > 0 ? "Fuzzy rules >> " : "Generator logic >> ") << ruleFile << std::endl << std::endl;
 
-        // create network instance
+        // create network instance, a warm cache skips parsing the network file
         std::cout << ">> Load network" << std::endl;
-        bayesNet::Network network(networkFile);
+        std::unique_ptr<bayesNet::Network> network(networkCacheDirectory.empty() ? new bayesNet::Network(networkFile) : new bayesNet::Network(networkFile, networkCacheDirectory));
 
-        // load fuzzy rules
-        std::cout << ">> Load fuzzy rules" << std::endl;
-        network.setFuzzyRules(ruleFile);
+        if (ruleArgs > 0) {
+            // load fuzzy rules
+            std::cout << ">> Load fuzzy rules" << std::endl;
+            network->setFuzzyRules(ruleFile);
+        } else {
+            // apply generated fuzzy rules without enumerating them
+            std::cout << ">> Load generator logic" << std::endl;
+            network->setFuzzyRuleGenerator(ruleFile);
+        }
+
+        // reuse CPTs inferred by previous runs
+        if (!cacheDirectory.empty()) {
+            std::cout << ">> Use CPT cache " << cacheDirectory << std::endl;
+            network->setCPTCache(cacheDirectory);
+        }
 
         // infer CPTs
         std::cout << ">> Apply inference" << std::endl;
-        network.inferCPT();
+
+        if (threads == 1) {
+            network->inferCPT();
+        } else {
+            bayesNet::utils::ThreadPool pool(threads);
+            network->inferCPT(pool);
+        }
 
         // save network to destination
-        std::cout << ">> Save new network file" << std::endl;
+        if (destFile == "") {
+            destFile = networkFile;
+        }
 
-        if (destFile != "") {
-            network.save(destFile);
+        if (incremental) {
+            std::cout << ">> Append changes to network journal" << std::endl;
+            network->saveIncremental(destFile);
         } else {
-            network.save(networkFile);
+            std::cout << ">> Save new network file" << std::endl;
+            network->save(destFile);
         }
     } else {
         std::cout << "InferCPT is a tool to calculate CPTs based on a set of fuzzy rules" << std::endl << std::endl;
-        std::cout << "Usage:   " << "infer_cpt <network_file> <fuzzy_rules_file> [<dest_file>]" << std::endl;
+        std::cout << "Usage:   " << "infer_cpt [options] <network_file> <fuzzy_rules_file> [<dest_file>]" << std::endl;
+        std::cout << "         " << "infer_cpt [options] --generator <generator_logic_file> <network_file> [<dest_file>]" << std::endl << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  -i, --incremental         only append changed CPTs to the journal of the network file, other destinations are written in full" << std::endl;
+        std::cout << "  -j, --threads <n>         infer CPTs using n threads, 0 uses all available cores (default 1)" << std::endl;
+        std::cout << "  -g, --generator <f>       infer CPTs from the rules implicitly defined by generator logic file f" << std::endl;
+        std::cout << "  -c, --cache <dir>         load unchanged CPTs from and store inferred CPTs to the cache directory dir" << std::endl;
+        std::cout << "  -n, --network-cache <dir> load the parsed network from and store it to the cache directory dir" << std::endl;
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -16,9 +16,30 @@ int main(int argc, char **argv) {
     QCommandLineParser parser;
     // command line option for port
     QCommandLineOption portOption({"port", "p"}, "port to listen on", "websocket_port", "8000");
+    // command line option for compiled network cache
+    QCommandLineOption cacheOption({"cache", "c"}, "directory used to cache compiled networks", "cache_directory");
+    // command line option for worker threads
+    QCommandLineOption threadsOption({"threads", "t"}, "number of worker threads, 0 uses all available cores", "threads", "0");
+    // command line option for queue capacity
+    QCommandLineOption queueOption({"queue", "q"}, "maximum number of queued requests, further requests are rejected", "queue_capacity", "1024");
+    // command line option for inference schedule
+    QCommandLineOption scheduleOption({"schedule", "s"}, "when sessions apply inference: on_demand, interval:<ms> or updates:<n>", "schedule", "on_demand");
+    // command line option for metrics endpoint
+    QCommandLineOption metricsOption({"metrics-port", "m"}, "port of the Prometheus metrics endpoint on localhost, 0 disables it", "metrics_port", "0");
+    // command line option for unix domain socket
+    QCommandLineOption socketOption({"socket", "l"}, "unix domain socket path for clients on the same host", "socket_path");
+    // command line option for preloaded sessions
+    QCommandLineOption preloadOption({"preload", "P"}, "file listing named sessions to create at startup, one <session> <network_file> [<schedule>] per line", "preload_config");
     // set options for parser
     parser.addHelpOption();
     parser.addOption(portOption);
+    parser.addOption(cacheOption);
+    parser.addOption(threadsOption);
+    parser.addOption(queueOption);
+    parser.addOption(scheduleOption);
+    parser.addOption(metricsOption);
+    parser.addOption(socketOption);
+    parser.addOption(preloadOption);
     // parse arguments
     parser.process(app);
 
@@ -26,11 +47,63 @@ int main(int argc, char **argv) {
     uint port = parser.value(portOption).toUInt();
 
     // create server instance
-    bayesServer::Server srv(port, &app);
+    bayesServer::Server srv(port, parser.value(cacheOption), parser.value(threadsOption).toUInt(), parser.value(queueOption).toUInt(), &app);
+
+    // set schedule of new sessions
+    try {
+        srv.setSchedule(bayesServer::Schedule(parser.value(scheduleOption).toStdString()));
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // serve metrics
+    uint metricsPort = parser.value(metricsOption).toUInt();
+
+    if (metricsPort != 0 && !srv.listenMetrics(metricsPort)) {
+        std::cerr << "metrics port " << metricsPort << " not available" << std::endl;
+        return 1;
+    }
+
+    // accept local clients
+    if (parser.isSet(socketOption) && !srv.listenLocal(parser.value(socketOption))) {
+        std::cerr << "can not listen on socket " << parser.value(socketOption).toStdString() << std::endl;
+        return 1;
+    }
+
+    // create and warm up preloaded sessions before accepting requests
+    if (parser.isSet(preloadOption)) {
+        try {
+            srv.preload(parser.value(preloadOption));
+        } catch(const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        QObject::connect(&srv, &bayesServer::Server::networkReloaded, [](const QString& file, const QString& error) {
+            if (error.isEmpty()) {
+                std::cout << ">> Reloaded " << file.toStdString() << std::endl;
+            } else {
+                std::cerr << ">> Reloading " << file.toStdString() << " failed: " << error.toStdString() << std::endl;
+            }
+        });
+    }
 
     // print program info
     std::cout << ">> Standalone BayesServer\n>> Listening on port " << parser.value(portOption).toStdString() << std::endl;
 
+    if (parser.isSet(socketOption)) {
+        std::cout << ">> Listening on socket " << parser.value(socketOption).toStdString() << std::endl;
+    }
+
+    if (parser.isSet(preloadOption)) {
+        std::cout << ">> Preloaded sessions of " << parser.value(preloadOption).toStdString() << std::endl;
+    }
+
+    if (metricsPort != 0) {
+        std::cout << ">> Metrics on http://localhost:" << metricsPort << "/metrics" << std::endl;
+    }
+
     // run main event loop
     return app.exec();
 }
\ No newline at end of file